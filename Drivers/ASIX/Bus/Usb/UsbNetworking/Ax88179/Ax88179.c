@@ -934,6 +934,123 @@ Ax88179GetLinkStatus (
 
 }
 
+/**
+  Issue the frames queued in the transmit aggregation buffer.
+
+  All of the queued frames, each preceded by its TX header, are sent to
+  the adapter with a single bulk-out transfer.  The aggregation buffer
+  is empty upon return, even when the transfer fails.
+
+  @param [in] NicDevice       Pointer to the NIC_DEVICE structure
+
+  @retval EFI_SUCCESS         The queued frames were sent or no frame was queued
+  @retval EFI_NOT_READY       The bulk-out transfer timed out
+  @retval EFI_DEVICE_ERROR    The bulk-out transfer failed
+
+**/
+EFI_STATUS
+Ax88179TxFlush (
+  IN NIC_DEVICE *NicDevice
+  )
+{
+  EFI_USB_IO_PROTOCOL *UsbIo;
+  TX_PACKET           *LastPacket;
+  EFI_STATUS          Status;
+  UINTN               TransferLength;
+  UINT32              TransferStatus;
+
+  gBS->SetTimer (NicDevice->TxAggTimer, TimerCancel, 0);
+
+  if (NicDevice->TxAggPktCnt == 0) {
+    return EFI_SUCCESS;
+  }
+
+  //
+  //  Tell the adapter not to wait for a zero length packet when the
+  //  transfer ends on a max packet boundary
+  //
+  TransferLength = NicDevice->TxAggLength;
+  if ((TransferLength % NicDevice->UsbMaxPktSize) == 0) {
+    LastPacket = (TX_PACKET *) &NicDevice->TxAggBuf[NicDevice->TxAggLastPkt];
+    LastPacket->TxHdr2 |= TX_HDR2_ZLP;
+  }
+
+  //
+  //  Work around USB bus driver bug where a timeout set by receive
+  //  succeeds but the timeout expires immediately after, causing the
+  //  transmit operation to timeout.
+  //
+  UsbIo = NicDevice->UsbIo;
+  Status = UsbIo->UsbBulkTransfer (UsbIo,
+                                   BULK_OUT_ENDPOINT,
+                                   NicDevice->TxAggBuf,
+                                   &TransferLength,
+                                   0xfffffffe,
+                                   &TransferStatus);
+
+  NicDevice->TxAggLength = 0;
+  NicDevice->TxAggPktCnt = 0;
+
+  if (!EFI_ERROR (Status)) {
+    Status = EFI_SUCCESS;
+  } else if (EFI_TIMEOUT == Status && EFI_USB_ERR_TIMEOUT == TransferStatus) {
+    Status = EFI_NOT_READY;
+  } else {
+    Status = EFI_DEVICE_ERROR;
+  }
+
+  return Status;
+}
+
+/**
+  Drop the frames queued in the transmit aggregation buffer.
+
+  @param [in] NicDevice       Pointer to the NIC_DEVICE structure
+
+**/
+VOID
+Ax88179TxDiscard (
+  IN NIC_DEVICE *NicDevice
+  )
+{
+  gBS->SetTimer (NicDevice->TxAggTimer, TimerCancel, 0);
+  NicDevice->TxAggLength = 0;
+  NicDevice->TxAggPktCnt = 0;
+}
+
+/**
+  Issue the queued frames once the aggregation latency bound expires.
+
+  @param [in] Event           The timer event
+  @param [in] Context         Pointer to the NIC_DEVICE structure
+
+**/
+VOID
+EFIAPI
+Ax88179TxAggTimer (
+  IN EFI_EVENT Event,
+  IN VOID      *Context
+  )
+{
+  NIC_DEVICE *NicDevice;
+  EFI_STATUS Status;
+
+  NicDevice = (NIC_DEVICE *) Context;
+
+  //
+  //  Never issue a bulk-out on an interface that is no longer initialized
+  //
+  if (NicDevice->SimpleNetworkData.State != EfiSimpleNetworkInitialized) {
+    Ax88179TxDiscard (NicDevice);
+    return;
+  }
+
+  Status = Ax88179TxFlush (NicDevice);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_TX, "Ax88179: Deferred transmit failed, %r\n", Status));
+  }
+}
+
 EFI_STATUS
 Ax88179BulkIn(
   IN NIC_DEVICE *NicDevice
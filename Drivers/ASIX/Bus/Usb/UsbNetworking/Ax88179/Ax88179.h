@@ -79,6 +79,21 @@
 #define TX_RETRY        0
 #define AUTONEG_DELAY   1000000
 
+//
+//  Transmit aggregation: several frames, each with its own TX header, are
+//  packed into one bulk-out transfer.  The transfer is issued when the buffer
+//  cannot take the next frame, when TX_AGG_MAX_PKTS frames are queued, when
+//  the caller polls with GetStatus or Receive, or when TX_AGG_FLUSH_MSEC has
+//  elapsed since the first frame was queued.
+//  Setting TX_AGG_MAX_PKTS to 1 restores one transfer per frame.
+//
+#define TX_AGG_MAX_PKTS     8                 ///<  Maximum frames per bulk-out transfer
+#define TX_AGG_BUF_SIZE     (1024 * 16)       ///<  Size of the bulk-out aggregation buffer
+#define TX_AGG_FLUSH_MSEC   1                 ///<  Latency bound for a queued frame
+#define TX_AGG_PKT_ALIGN    4                 ///<  Alignment of each TX header in the buffer
+#define TX_RECYCLE_CNT      (TX_AGG_MAX_PKTS * 2) ///<  Depth of the recycled transmit buffer array
+#define TX_HDR2_ZLP         0x80008000        ///<  TX header 2 flags: transfer ends on a max packet boundary
+
 /**
   Verify new TPL value
 
@@ -279,14 +294,19 @@ typedef struct {
   UINT8                     *CurPktHdrOff;
   UINT8                     *CurPktOff;
 
-  TX_PACKET                 *TxTest;
+  UINT8                     *TxAggBuf;          ///<  Bulk-out aggregation buffer
+  UINTN                     TxAggLength;        ///<  Bytes queued in TxAggBuf
+  UINTN                     TxAggPktCnt;        ///<  Frames queued in TxAggBuf
+  UINTN                     TxAggLastPkt;       ///<  Offset of the last queued frame
+  EFI_EVENT                 TxAggTimer;         ///<  Flushes TxAggBuf after TX_AGG_FLUSH_MSEC
 
   INT8                      MulticastHash[8];
   EFI_MAC_ADDRESS           MAC;
 
   UINT16                    CurMediumStatus;
   UINT16                    CurRxControl;
-  VOID *                    TxBuffer;
+  VOID *                    TxBuffer[TX_RECYCLE_CNT]; ///<  Recycled transmit buffers
+  UINTN                     TxBufferCnt;
 
   EFI_DEVICE_PATH_PROTOCOL  *MyDevPath;
   BOOLEAN                   Grub_f;
@@ -1044,6 +1064,23 @@ Ax88179GetLinkStatus (
   IN NIC_DEVICE *NicDevice
 );
 
+EFI_STATUS
+Ax88179TxFlush (
+  IN NIC_DEVICE *NicDevice
+  );
+
+VOID
+Ax88179TxDiscard (
+  IN NIC_DEVICE *NicDevice
+  );
+
+VOID
+EFIAPI
+Ax88179TxAggTimer (
+  IN EFI_EVENT Event,
+  IN VOID      *Context
+  );
+
 EFI_STATUS
 Ax88179BulkIn(
   IN NIC_DEVICE *NicDevice
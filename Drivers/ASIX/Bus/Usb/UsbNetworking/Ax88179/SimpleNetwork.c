@@ -133,9 +133,9 @@ SN_GetStatus (
     //
     NicDevice = DEV_FROM_SIMPLE_NETWORK (SimpleNetwork);
 
-    if ((TxBuf != NULL) && (NicDevice->TxBuffer != NULL)) {
-      *TxBuf = NicDevice->TxBuffer;
-      NicDevice->TxBuffer = NULL;
+    if ((TxBuf != NULL) && (NicDevice->TxBufferCnt != 0)) {
+      NicDevice->TxBufferCnt--;
+      *TxBuf = NicDevice->TxBuffer[NicDevice->TxBufferCnt];
     }
 
     Mode = SimpleNetwork->Mode;
@@ -145,6 +145,11 @@ SN_GetStatus (
         goto EXIT;
       }
 
+      //
+      //  Issue the queued frames, the caller polls here for their completion
+      //
+      Ax88179TxAggTimer (NULL, NicDevice);
+
 #if REPORTLINK
 #else
       if (!NicDevice->LinkUp || !NicDevice->Complete) {
@@ -552,6 +557,11 @@ SN_Receive (
       //
       NicDevice = DEV_FROM_SIMPLE_NETWORK (SimpleNetwork);
 
+      //
+      //  Issue the queued frames before waiting for the reply to them
+      //
+      Ax88179TxAggTimer (NULL, NicDevice);
+
       if (NicDevice->LinkUp && NicDevice->Complete) {
         if ((HeaderSize != NULL) && (*HeaderSize == 7720)) {
           NicDevice->Grub_f = TRUE;
@@ -864,6 +874,12 @@ SN_Reset (
       //
       NicDevice = DEV_FROM_SIMPLE_NETWORK (SimpleNetwork);
 
+      //
+      //  Clear the transmit queue
+      //
+      Ax88179TxDiscard (NicDevice);
+      NicDevice->TxBufferCnt = 0;
+
       //
       //  Reset the device
       //
@@ -953,7 +969,7 @@ SN_Setup (
            0xff);
   Mode->IfType = NET_IFTYPE_ETHERNET;
   Mode->MacAddressChangeable = TRUE;
-  Mode->MultipleTxSupported = FALSE;
+  Mode->MultipleTxSupported = TRUE;
   Mode->MediaPresentSupported = TRUE;
   Mode->MediaPresent = FALSE;
   //
@@ -971,6 +987,9 @@ SN_Setup (
   NicDevice->SkipRXCnt = 0;
   NicDevice->UsbMaxPktSize = 512;
   NicDevice->SetZeroLen = TRUE;
+  NicDevice->TxAggLength = 0;
+  NicDevice->TxAggPktCnt = 0;
+  NicDevice->TxBufferCnt = 0;
 
   Status = Ax88179MacAddressGet (NicDevice,
                                   &Mode->PermanentAddress.Addr[0]);
@@ -998,10 +1017,24 @@ SN_Setup (
   }
 
   Status = gBS->AllocatePool (EfiBootServicesData,
-                               sizeof (TX_PACKET),
-                               (VOID **) &NicDevice->TxTest);
+                               TX_AGG_BUF_SIZE,
+                               (VOID **) &NicDevice->TxAggBuf);
+  if (EFI_ERROR (Status)) {
+    gBS->FreePool (NicDevice->BulkInbuf);
+    NicDevice->BulkInbuf = NULL;
+    return Status;
+  }
+
+  Status = gBS->CreateEvent (EVT_TIMER | EVT_NOTIFY_SIGNAL,
+                             TPL_CALLBACK,
+                             Ax88179TxAggTimer,
+                             NicDevice,
+                             &NicDevice->TxAggTimer);
   if (EFI_ERROR (Status)) {
+    gBS->FreePool (NicDevice->TxAggBuf);
     gBS->FreePool (NicDevice->BulkInbuf);
+    NicDevice->TxAggBuf = NULL;
+    NicDevice->BulkInbuf = NULL;
   }
 
   //
@@ -1071,7 +1104,7 @@ SN_Start (
       SetMem(&Mode->BroadcastAddress, PXE_HWADDR_LEN_ETHER, 0xff);
       Mode->IfType = NET_IFTYPE_ETHERNET;
       Mode->MacAddressChangeable = TRUE;
-      Mode->MultipleTxSupported = FALSE;
+      Mode->MultipleTxSupported = TRUE;
       Mode->MediaPresentSupported = TRUE;
       Mode->MediaPresent = FALSE;
 
@@ -1269,6 +1302,7 @@ SN_Stop (
 {
   EFI_SIMPLE_NETWORK_MODE *Mode;
   EFI_STATUS              Status;
+  NIC_DEVICE              *NicDevice;
   EFI_TPL                 TplPrevious;
 
   TplPrevious = gBS->RaiseTPL(TPL_CALLBACK);
@@ -1282,6 +1316,13 @@ SN_Stop (
     Mode = SimpleNetwork->Mode;
 
     if (EfiSimpleNetworkStarted == Mode->State) {
+        //
+        // Drop anything left in the transmit queue and cancel the flush
+        // timer, so that no bulk-out is issued on the stopped interface
+        //
+        NicDevice = DEV_FROM_SIMPLE_NETWORK (SimpleNetwork);
+        Ax88179TxDiscard (NicDevice);
+        NicDevice->TxBufferCnt = 0;
         Mode->State = EfiSimpleNetworkStopped;
         Status = EFI_SUCCESS;
     } else {
@@ -1339,6 +1380,7 @@ SN_Shutdown (
       // Stop the adapter
       //
       NicDevice = DEV_FROM_SIMPLE_NETWORK (SimpleNetwork);
+      Ax88179TxDiscard (NicDevice);
 
       Status = Ax88179MacAddressGet (NicDevice, &Mode->PermanentAddress.Addr[0]);
       if (!EFI_ERROR (Status)) {
@@ -1423,10 +1465,9 @@ SN_Transmit (
   ETHERNET_HEADER         *Header;
   EFI_SIMPLE_NETWORK_MODE *Mode;
   NIC_DEVICE              *NicDevice;
-  EFI_USB_IO_PROTOCOL     *UsbIo;
   EFI_STATUS              Status;
-  UINTN                   TransferLength;
-  UINT32                  TransferStatus;
+  TX_PACKET               *TxPacket;
+  UINTN                   Offset;
   UINT16                  Type = 0;
   EFI_TPL                 TplPrevious;
 
@@ -1466,17 +1507,42 @@ SN_Transmit (
           Status = EFI_INVALID_PARAMETER;
           goto EXIT;
         }
+        if (BufferSize > AX88179_MAX_PKT_SIZE) {
+          Status = EFI_INVALID_PARAMETER;
+          goto EXIT;
+        }
+        if (NicDevice->TxBufferCnt >= TX_RECYCLE_CNT) {
+          Status = EFI_NOT_READY;
+          goto EXIT;
+        }
+
+        //
+        //  Issue the queued frames when the aggregation buffer
+        //  is too full to take this one
+        //
+        Offset = ALIGN_VALUE (NicDevice->TxAggLength, TX_AGG_PKT_ALIGN);
+        if ((NicDevice->TxAggPktCnt != 0) &&
+            ((Offset + OFFSET_OF (TX_PACKET, Data)
+              + MAX (BufferSize, MIN_ETHERNET_PKT_SIZE)) > TX_AGG_BUF_SIZE)) {
+          Status = Ax88179TxFlush (NicDevice);
+          if (EFI_ERROR (Status)) {
+            goto EXIT;
+          }
+          Offset = 0;
+        }
+
         //
         //  Copy the packet into the USB buffer
         //
         // Buffer starting with 14 bytes 0
-        CopyMem (&NicDevice->TxTest->Data[0], Buffer, BufferSize);
-        NicDevice->TxTest->TxHdr1 = (UINT32) BufferSize;
-        NicDevice->TxTest->TxHdr2 = 0;
+        TxPacket = (TX_PACKET *) &NicDevice->TxAggBuf[Offset];
+        CopyMem (&TxPacket->Data[0], Buffer, BufferSize);
+        TxPacket->TxHdr1 = (UINT32) BufferSize;
+        TxPacket->TxHdr2 = 0;
         //
         //  Transmit the packet
         //
-        Header = (ETHERNET_HEADER *) &NicDevice->TxTest->Data[0];
+        Header = (ETHERNET_HEADER *) &TxPacket->Data[0];
         if (HeaderSize != 0) {
           if (DestAddr != NULL) {
             CopyMem (&Header->DestAddr, DestAddr, PXE_HWADDR_LEN_ETHER);
@@ -1495,35 +1561,39 @@ SN_Transmit (
           Header->Type = Type;
         }
 
-        if (NicDevice->TxTest->TxHdr1 < MIN_ETHERNET_PKT_SIZE) {
-          NicDevice->TxTest->TxHdr1 = MIN_ETHERNET_PKT_SIZE;
-          ZeroMem (&NicDevice->TxTest->Data[BufferSize],
+        if (TxPacket->TxHdr1 < MIN_ETHERNET_PKT_SIZE) {
+          TxPacket->TxHdr1 = MIN_ETHERNET_PKT_SIZE;
+          ZeroMem (&TxPacket->Data[BufferSize],
                     MIN_ETHERNET_PKT_SIZE - BufferSize);
         }
 
-        TransferLength = sizeof (NicDevice->TxTest->TxHdr1)
-                       + sizeof (NicDevice->TxTest->TxHdr2)
-                       + NicDevice->TxTest->TxHdr1;
+        NicDevice->TxAggLastPkt = Offset;
+        NicDevice->TxAggLength = Offset
+                               + sizeof (TxPacket->TxHdr1)
+                               + sizeof (TxPacket->TxHdr2)
+                               + TxPacket->TxHdr1;
+        NicDevice->TxAggPktCnt++;
+
         //
-        //  Work around USB bus driver bug where a timeout set by receive
-        //  succeeds but the timeout expires immediately after, causing the
-        //  transmit operation to timeout.
+        //  Send the batch once it is complete, otherwise bound the
+        //  latency of the first queued frame with the flush timer
         //
-        UsbIo = NicDevice->UsbIo;
-        Status = UsbIo->UsbBulkTransfer (UsbIo,
-                                           BULK_OUT_ENDPOINT,
-                                           &NicDevice->TxTest->TxHdr1,
-                                           &TransferLength,
-                                           0xfffffffe,
-                                           &TransferStatus);
-
-        if (!EFI_ERROR(Status) && !EFI_ERROR(Status)) {
-          NicDevice->TxBuffer = Buffer;
-          Status = EFI_SUCCESS;
-        } else if (EFI_TIMEOUT == Status && EFI_USB_ERR_TIMEOUT == TransferStatus) {
-          Status = EFI_NOT_READY;
+        if (NicDevice->TxAggPktCnt >= TX_AGG_MAX_PKTS) {
+          Status = Ax88179TxFlush (NicDevice);
         } else {
-          Status = EFI_DEVICE_ERROR;
+          if (NicDevice->TxAggPktCnt == 1) {
+            gBS->SetTimer (NicDevice->TxAggTimer,
+                           TimerRelative,
+                           TX_AGG_FLUSH_MSEC * 10000);
+          }
+          Status = EFI_SUCCESS;
+        }
+
+        //
+        //  The frame has been copied, the caller's buffer may be recycled
+        //
+        if (!EFI_ERROR (Status)) {
+          NicDevice->TxBuffer[NicDevice->TxBufferCnt++] = Buffer;
         }
       } else {
         //
@@ -1064,6 +1064,168 @@ Ax88772GetLinkStatus (
 
 }
 
+/**
+  Issue the frames queued in the transmit aggregation buffer.
+
+  All of the queued frames, each preceded by its length header, are sent
+  to the adapter with a single bulk-out transfer.  The aggregation buffer
+  is empty upon return, even when the transfer fails.
+
+  @param [in] NicDevice       Pointer to the NIC_DEVICE structure
+
+  @retval EFI_SUCCESS         The queued frames were sent or no frame was queued
+  @retval other               The bulk-out transfer failed
+
+**/
+EFI_STATUS
+Ax88772TxFlush (
+  IN NIC_DEVICE *NicDevice
+  )
+{
+  EFI_USB_IO_PROTOCOL *UsbIo;
+  TX_PACKET           *PadHeader;
+  EFI_STATUS          Status;
+  UINTN               TransferLength;
+  UINT32              TransferStatus;
+
+  gBS->SetTimer (NicDevice->TxAggTimer, TimerCancel, 0);
+
+  if (NicDevice->TxAggPktCnt == 0) {
+    return EFI_SUCCESS;
+  }
+
+  //
+  //  Terminate a transfer ending on a max packet boundary with an
+  //  empty length header rather than a zero length packet
+  //
+  TransferLength = NicDevice->TxAggLength;
+  if ((TransferLength % NicDevice->UsbMaxPktSize) == 0) {
+    PadHeader = (TX_PACKET *) &NicDevice->TxAggBuf[TransferLength];
+    PadHeader->Length = 0;
+    PadHeader->LengthBar = 0xFFFF;
+    TransferLength += OFFSET_OF (TX_PACKET, Data);
+  }
+
+#if RXTHOU
+  if (NicDevice->RxBurst == 1)
+    NicDevice->RxBurst--;
+#endif
+  //
+  //  Work around USB bus driver bug where a timeout set by receive
+  //  succeeds but the timeout expires immediately after, causing the
+  //  transmit operation to timeout.
+  //
+  UsbIo = NicDevice->UsbIo;
+  Status = UsbIo->UsbBulkTransfer (UsbIo,
+                                   BULK_OUT_ENDPOINT,
+                                   NicDevice->TxAggBuf,
+                                   &TransferLength,
+                                   0xfffffffe,
+                                   &TransferStatus);
+
+  NicDevice->TxAggLength = 0;
+  NicDevice->TxAggPktCnt = 0;
+
+  if (EFI_SUCCESS == Status) {
+    Status = TransferStatus;
+  }
+
+  return Status;
+}
+
+/**
+  Drop the frames queued in the transmit aggregation buffer.
+
+  @param [in] NicDevice       Pointer to the NIC_DEVICE structure
+
+**/
+VOID
+Ax88772TxDiscard (
+  IN NIC_DEVICE *NicDevice
+  )
+{
+  gBS->SetTimer (NicDevice->TxAggTimer, TimerCancel, 0);
+  NicDevice->TxAggLength = 0;
+  NicDevice->TxAggPktCnt = 0;
+}
+
+/**
+  Get the max packet size of the bulk-out endpoint.
+
+  The size depends upon the speed of the link, 512 bytes at high speed
+  and 64 bytes at full speed.
+
+  @param [in] NicDevice       Pointer to the NIC_DEVICE structure
+
+  @return The max packet size, TX_AGG_MAX_PKT_SIZE if the endpoint
+          descriptor cannot be read
+
+**/
+UINTN
+Ax88772BulkOutMaxPktSize (
+  IN NIC_DEVICE *NicDevice
+  )
+{
+  EFI_USB_IO_PROTOCOL          *UsbIo;
+  EFI_USB_INTERFACE_DESCRIPTOR InterfaceDescriptor;
+  EFI_USB_ENDPOINT_DESCRIPTOR  EndpointDescriptor;
+  EFI_STATUS                   Status;
+  UINT8                        Index;
+
+  UsbIo = NicDevice->UsbIo;
+  Status = UsbIo->UsbGetInterfaceDescriptor (UsbIo, &InterfaceDescriptor);
+  if (!EFI_ERROR (Status)) {
+    for (Index = 0; Index < InterfaceDescriptor.NumEndpoints; Index++) {
+      Status = UsbIo->UsbGetEndpointDescriptor (UsbIo, Index, &EndpointDescriptor);
+      if (EFI_ERROR (Status)) {
+        break;
+      }
+      if ((EndpointDescriptor.EndpointAddress == BULK_OUT_ENDPOINT) &&
+          (EndpointDescriptor.MaxPacketSize != 0)) {
+        return EndpointDescriptor.MaxPacketSize;
+      }
+    }
+  }
+
+  return TX_AGG_MAX_PKT_SIZE;
+}
+
+/**
+  Issue the queued frames once the aggregation latency bound expires.
+
+  @param [in] Event           The timer event
+  @param [in] Context         Pointer to the NIC_DEVICE structure
+
+**/
+VOID
+EFIAPI
+Ax88772TxAggTimer (
+  IN EFI_EVENT Event,
+  IN VOID      *Context
+  )
+{
+  NIC_DEVICE *NicDevice;
+  EFI_STATUS Status;
+
+  NicDevice = (NIC_DEVICE *) Context;
+
+  //
+  //  Never issue a bulk-out on an interface that is no longer initialized
+  //
+  if (NicDevice->SimpleNetworkData.State != EfiSimpleNetworkInitialized) {
+    Ax88772TxDiscard (NicDevice);
+    return;
+  }
+
+  Status = Ax88772TxFlush (NicDevice);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_TX, "Ax88772: Deferred transmit failed, %r\n", Status));
+    if (EFI_DEVICE_ERROR == Status) {
+      SN_Reset (&NicDevice->SimpleNetwork, FALSE);
+    }
+  }
+}
+
 #if RXTHOU
 EFI_STATUS
 Ax88772BulkIn(
@@ -90,6 +90,21 @@
 #define AUTONEG_DELAY   2000000
 #define AUTONEG_POLL_CNT    5
 
+//
+//  Transmit aggregation: several frames, each with its own length header, are
+//  packed into one bulk-out transfer.  The transfer is issued when the buffer
+//  cannot take the next frame, when TX_AGG_MAX_PKTS frames are queued, when
+//  the caller polls with GetStatus or Receive, or when TX_AGG_FLUSH_MSEC has
+//  elapsed since the first frame was queued.
+//  Setting TX_AGG_MAX_PKTS to 1 restores one transfer per frame.
+//
+#define TX_AGG_MAX_PKTS     8                 ///<  Maximum frames per bulk-out transfer
+#define TX_AGG_BUF_SIZE     (1024 * 16)       ///<  Size of the bulk-out aggregation buffer
+#define TX_AGG_FLUSH_MSEC   1                 ///<  Latency bound for a queued frame
+#define TX_AGG_PKT_ALIGN    2                 ///<  Alignment of each length header in the buffer
+#define TX_AGG_MAX_PKT_SIZE 512               ///<  Bulk-out max packet size if the endpoint descriptor cannot be read
+#define TX_RECYCLE_CNT      (TX_AGG_MAX_PKTS * 2) ///<  Depth of the recycled transmit buffer array
+
 /**
   Verify new TPL value
 
@@ -319,6 +334,17 @@ typedef struct _RX_TX_PACKET {
 } RX_TX_PACKET;
 #pragma pack()
 
+/**
+  Transmit packet layout within the bulk-out aggregation buffer
+**/
+#pragma pack(1)
+typedef struct _TX_PACKET {
+  UINT16 Length;                      ///<  Packet length
+  UINT16 LengthBar;                   ///<  Complement of the length
+  UINT8  Data[AX88772_MAX_PKT_SIZE];  ///<  Transmit packet data
+} TX_PACKET;
+#pragma pack()
+
 /**
   AX88772 control structure
 
@@ -355,7 +381,8 @@ typedef struct {
   BOOLEAN                   LinkUp;             ///<  Current link state
   UINTN                     PollCount;          ///<  Number of times the autonegotiation status was polled
   UINT16                    CurRxControl;
-  VOID                      *TxBuffer;
+  VOID                      *TxBuffer[TX_RECYCLE_CNT]; ///<  Recycled transmit buffers
+  UINTN                     TxBufferCnt;
   //
   //  Receive buffer list
   //
@@ -364,7 +391,11 @@ typedef struct {
   UINT8                     *CurPktOff;
   UINT16                    PktCnt;
 
-  RX_TX_PACKET              *TxTest;
+  UINT8                     *TxAggBuf;          ///<  Bulk-out aggregation buffer
+  UINTN                     TxAggLength;        ///<  Bytes queued in TxAggBuf
+  UINTN                     TxAggPktCnt;        ///<  Frames queued in TxAggBuf
+  EFI_EVENT                 TxAggTimer;         ///<  Flushes TxAggBuf after TX_AGG_FLUSH_MSEC
+  UINTN                     UsbMaxPktSize;      ///<  Max packet size of the bulk-out endpoint
 
   UINT8                     MulticastHash[8];
   EFI_MAC_ADDRESS           MAC;
@@ -1036,6 +1067,28 @@ Ax88772BulkIn(
   IN NIC_DEVICE *NicDevice
 );
 
+EFI_STATUS
+Ax88772TxFlush (
+  IN NIC_DEVICE *NicDevice
+  );
+
+VOID
+Ax88772TxDiscard (
+  IN NIC_DEVICE *NicDevice
+  );
+
+UINTN
+Ax88772BulkOutMaxPktSize (
+  IN NIC_DEVICE *NicDevice
+  );
+
+VOID
+EFIAPI
+Ax88772TxAggTimer (
+  IN EFI_EVENT Event,
+  IN VOID      *Context
+  );
+
 //------------------------------------------------------------------------------
 
 #endif  //  AX88772_H_
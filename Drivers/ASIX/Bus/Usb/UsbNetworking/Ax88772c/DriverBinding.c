@@ -289,8 +289,12 @@ ERR:
     gBS->FreePool (NicDevice->BulkInbuf);
   }
 
-  if (NicDevice->TxTest != NULL) {
-    gBS->FreePool (NicDevice->TxTest);
+  if (NicDevice->TxAggTimer != NULL) {
+    gBS->CloseEvent (NicDevice->TxAggTimer);
+  }
+
+  if (NicDevice->TxAggBuf != NULL) {
+    gBS->FreePool (NicDevice->TxAggBuf);
   }
 
   if (NicDevice->MyDevPath != NULL) {
@@ -454,8 +458,12 @@ DriverStop (
         gBS->FreePool (NicDevice->BulkInbuf);
       }
 
-      if (NicDevice->TxTest != NULL) {
-        gBS->FreePool (NicDevice->TxTest);
+      if (NicDevice->TxAggTimer != NULL) {
+        gBS->CloseEvent (NicDevice->TxAggTimer);
+      }
+
+      if (NicDevice->TxAggBuf != NULL) {
+        gBS->FreePool (NicDevice->TxAggBuf);
       }
 
       if (NicDevice->MyDevPath != NULL) {
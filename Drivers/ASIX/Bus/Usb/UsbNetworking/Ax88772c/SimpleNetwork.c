@@ -133,9 +133,9 @@ SN_GetStatus (
     //
     NicDevice = DEV_FROM_SIMPLE_NETWORK (SimpleNetwork);
 
-    if ((TxBuf != NULL) && (NicDevice->TxBuffer != NULL)) {
-      *TxBuf = NicDevice->TxBuffer;
-      NicDevice->TxBuffer = NULL;
+    if ((TxBuf != NULL) && (NicDevice->TxBufferCnt != 0)) {
+      NicDevice->TxBufferCnt--;
+      *TxBuf = NicDevice->TxBuffer[NicDevice->TxBufferCnt];
     }
 
     Mode = SimpleNetwork->Mode;
@@ -145,6 +145,11 @@ SN_GetStatus (
         goto EXIT;
       }
 
+      //
+      //  Issue the queued frames, the caller polls here for their completion
+      //
+      Ax88772TxAggTimer (NULL, NicDevice);
+
 #if REPORTLINK
 #else
       if (!NicDevice->LinkUp || !NicDevice->Complete) {
@@ -551,6 +556,11 @@ SN_Receive (
       //
       NicDevice = DEV_FROM_SIMPLE_NETWORK (SimpleNetwork);
 
+      //
+      //  Issue the queued frames before waiting for the reply to them
+      //
+      Ax88772TxAggTimer (NULL, NicDevice);
+
       if (NicDevice->LinkUp && NicDevice->Complete) {
         if ((HeaderSize != NULL) && (*HeaderSize == 7720)) {
           NicDevice->Grub_f = TRUE;
@@ -868,6 +878,12 @@ SN_Reset (
       //
       NicDevice = DEV_FROM_SIMPLE_NETWORK (SimpleNetwork);
 
+      //
+      //  Clear the transmit queue
+      //
+      Ax88772TxDiscard (NicDevice);
+      NicDevice->TxBufferCnt = 0;
+
       //
       //  Reset the device
       //
@@ -962,7 +978,7 @@ SN_Setup (
 
   Mode->IfType = NET_IFTYPE_ETHERNET;
   Mode->MacAddressChangeable = TRUE;
-  Mode->MultipleTxSupported = FALSE;
+  Mode->MultipleTxSupported = TRUE;
   Mode->MediaPresentSupported = TRUE;
   Mode->MediaPresent = FALSE;
 
@@ -977,6 +993,10 @@ SN_Setup (
   NicDevice->Grub_f = FALSE;
   NicDevice->FirstRst = TRUE;
   NicDevice->PktCnt = 0;
+  NicDevice->TxAggLength = 0;
+  NicDevice->TxAggPktCnt = 0;
+  NicDevice->TxBufferCnt = 0;
+  NicDevice->UsbMaxPktSize = Ax88772BulkOutMaxPktSize (NicDevice);
 
   Status = Ax88772MacAddressGet (
                 NicDevice,
@@ -1006,11 +1026,26 @@ SN_Setup (
   }
 
   Status = gBS->AllocatePool (EfiBootServicesData,
-                                   sizeof (RX_TX_PACKET),
-                                   (VOID **) &NicDevice->TxTest);
+                                   TX_AGG_BUF_SIZE,
+                                   (VOID **) &NicDevice->TxAggBuf);
+
+  if (EFI_ERROR (Status)) {
+    gBS->FreePool (NicDevice->BulkInbuf);
+    NicDevice->BulkInbuf = NULL;
+    return Status;
+  }
+
+  Status = gBS->CreateEvent (EVT_TIMER | EVT_NOTIFY_SIGNAL,
+                             TPL_CALLBACK,
+                             Ax88772TxAggTimer,
+                             NicDevice,
+                             &NicDevice->TxAggTimer);
 
   if (EFI_ERROR (Status)) {
+    gBS->FreePool (NicDevice->TxAggBuf);
     gBS->FreePool (NicDevice->BulkInbuf);
+    NicDevice->TxAggBuf = NULL;
+    NicDevice->BulkInbuf = NULL;
     return Status;
   }
 
@@ -1086,7 +1121,7 @@ SN_Start (
       SetMem(&Mode->BroadcastAddress, PXE_HWADDR_LEN_ETHER, 0xff);
       Mode->IfType = NET_IFTYPE_ETHERNET;
       Mode->MacAddressChangeable = TRUE;
-      Mode->MultipleTxSupported = FALSE;
+      Mode->MultipleTxSupported = TRUE;
       Mode->MediaPresentSupported = TRUE;
       Mode->MediaPresent = FALSE;
 
@@ -1286,6 +1321,7 @@ SN_Stop (
 {
   EFI_SIMPLE_NETWORK_MODE *Mode;
   EFI_STATUS              Status;
+  NIC_DEVICE              *NicDevice;
   EFI_TPL                 TplPrevious;
 
   TplPrevious = gBS->RaiseTPL(TPL_CALLBACK);
@@ -1299,6 +1335,13 @@ SN_Stop (
     Mode = SimpleNetwork->Mode;
 
     if (EfiSimpleNetworkStarted == Mode->State) {
+        //
+        // Drop anything left in the transmit queue and cancel the flush
+        // timer, so that no bulk-out is issued on the stopped interface
+        //
+        NicDevice = DEV_FROM_SIMPLE_NETWORK (SimpleNetwork);
+        Ax88772TxDiscard (NicDevice);
+        NicDevice->TxBufferCnt = 0;
         Mode->State = EfiSimpleNetworkStopped;
         Status = EFI_SUCCESS;
     } else {
@@ -1441,10 +1484,9 @@ SN_Transmit (
   ETHERNET_HEADER         *Header;
   EFI_SIMPLE_NETWORK_MODE *Mode;
   NIC_DEVICE              *NicDevice;
-  EFI_USB_IO_PROTOCOL     *UsbIo;
   EFI_STATUS              Status;
-  UINTN                   TransferLength;
-  UINT32                  TransferStatus;
+  TX_PACKET               *TxPacket;
+  UINTN                   Offset;
   UINT16                  Type;
   EFI_TPL                 TplPrevious;
 
@@ -1492,13 +1534,43 @@ SN_Transmit (
           goto EXIT;
         }
 
-        CopyMem (&NicDevice->TxTest->Data[0], Buffer, BufferSize);
-        NicDevice->TxTest->Length = (UINT16) BufferSize;
+        if (BufferSize > AX88772_MAX_PKT_SIZE) {
+          Status = EFI_INVALID_PARAMETER;
+          goto EXIT;
+        }
+        if (NicDevice->TxBufferCnt >= TX_RECYCLE_CNT) {
+          Status = EFI_NOT_READY;
+          goto EXIT;
+        }
+
+        //
+        //  Issue the queued frames when the aggregation buffer is too full
+        //  to take this one, keeping room for the trailing pad header
+        //
+        Offset = ALIGN_VALUE (NicDevice->TxAggLength, TX_AGG_PKT_ALIGN);
+        if ((NicDevice->TxAggPktCnt != 0) &&
+            ((Offset + OFFSET_OF (TX_PACKET, Data)
+              + MAX (BufferSize, MIN_ETHERNET_PKT_SIZE)
+              + OFFSET_OF (TX_PACKET, Data)) > TX_AGG_BUF_SIZE)) {
+          Status = Ax88772TxFlush (NicDevice);
+          if (EFI_ERROR (Status)) {
+            if (EFI_DEVICE_ERROR == Status) {
+              SN_Reset (SimpleNetwork, FALSE);
+            }
+            Status = EFI_NOT_READY;
+            goto EXIT;
+          }
+          Offset = 0;
+        }
+
+        TxPacket = (TX_PACKET *) &NicDevice->TxAggBuf[Offset];
+        CopyMem (&TxPacket->Data[0], Buffer, BufferSize);
+        TxPacket->Length = (UINT16) BufferSize;
 
         //
         //  Transmit the packet
         //
-        Header = (ETHERNET_HEADER *) &NicDevice->TxTest->Data[0];
+        Header = (ETHERNET_HEADER *) &TxPacket->Data[0];
         if (HeaderSize != 0) {
           if (DestAddr != NULL) {
             CopyMem (&Header->DestAddr, DestAddr, PXE_HWADDR_LEN_ETHER);
@@ -1511,47 +1583,46 @@ SN_Transmit (
           if (Protocol != NULL) {
             Type = *Protocol;
           } else {
-            Type = NicDevice->TxTest->Length;
+            Type = TxPacket->Length;
           }
           Type = (UINT16)((Type >> 8) | (Type << 8));
           Header->Type = Type;
         }
 
 
-        if (NicDevice->TxTest->Length < MIN_ETHERNET_PKT_SIZE) {
-          NicDevice->TxTest->Length = MIN_ETHERNET_PKT_SIZE;
-          ZeroMem (&NicDevice->TxTest->Data[BufferSize],
-                    NicDevice->TxTest->Length - BufferSize);
+        if (TxPacket->Length < MIN_ETHERNET_PKT_SIZE) {
+          TxPacket->Length = MIN_ETHERNET_PKT_SIZE;
+          ZeroMem (&TxPacket->Data[BufferSize],
+                    TxPacket->Length - BufferSize);
         }
 
-        NicDevice->TxTest->LengthBar = ~(NicDevice->TxTest->Length);
-        TransferLength = sizeof (NicDevice->TxTest->Length)
-                       + sizeof (NicDevice->TxTest->LengthBar)
-                       + NicDevice->TxTest->Length;
+        TxPacket->LengthBar = ~(TxPacket->Length);
+        NicDevice->TxAggLength = Offset
+                               + sizeof (TxPacket->Length)
+                               + sizeof (TxPacket->LengthBar)
+                               + TxPacket->Length;
+        NicDevice->TxAggPktCnt++;
 
-        if (TransferLength % 512 == 0 || TransferLength % 1024 == 0)
-          TransferLength +=4;
-#if RXTHOU
-        if (NicDevice->RxBurst == 1)
-          NicDevice->RxBurst--;
-#endif
         //
-        //  Work around USB bus driver bug where a timeout set by receive
-        //  succeeds but the timeout expires immediately after, causing the
-        //  transmit operation to timeout.
+        //  Send the batch once it is complete, otherwise bound the
+        //  latency of the first queued frame with the flush timer
         //
-        UsbIo = NicDevice->UsbIo;
-        Status = UsbIo->UsbBulkTransfer (UsbIo,
-                                           BULK_OUT_ENDPOINT,
-                                           &NicDevice->TxTest->Length,
-                                           &TransferLength,
-                                           0xfffffffe,
-                                           &TransferStatus);
-        if (EFI_SUCCESS == Status) {
-          Status = TransferStatus;
+        if (NicDevice->TxAggPktCnt >= TX_AGG_MAX_PKTS) {
+          Status = Ax88772TxFlush (NicDevice);
+        } else {
+          if (NicDevice->TxAggPktCnt == 1) {
+            gBS->SetTimer (NicDevice->TxAggTimer,
+                           TimerRelative,
+                           TX_AGG_FLUSH_MSEC * 10000);
+          }
+          Status = EFI_SUCCESS;
         }
-        if (EFI_SUCCESS == Status && EFI_SUCCESS == TransferStatus) {
-          NicDevice->TxBuffer = Buffer;
+
+        //
+        //  The frame has been copied, the caller's buffer may be recycled
+        //
+        if (EFI_SUCCESS == Status) {
+          NicDevice->TxBuffer[NicDevice->TxBufferCnt++] = Buffer;
         } else {
           if (EFI_DEVICE_ERROR == Status) {
             SN_Reset (SimpleNetwork, FALSE);
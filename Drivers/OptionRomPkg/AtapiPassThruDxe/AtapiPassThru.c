@@ -239,6 +239,7 @@ Returns:
                     );
   if (!EFI_ERROR (Status)) {
     Supports &= (EFI_PCI_DEVICE_ENABLE               |
+                 EFI_PCI_IO_ATTRIBUTE_BUS_MASTER     |
                  EFI_PCI_IO_ATTRIBUTE_IDE_PRIMARY_IO |
                  EFI_PCI_IO_ATTRIBUTE_IDE_SECONDARY_IO);
     Status = PciIo->Attributes (
@@ -369,6 +370,8 @@ Returns:
     return Status;
   }
 
+  AtapiDmaFree (AtapiScsiPrivate);
+
   //
   // Restore original PCI attributes
   //
@@ -442,6 +445,11 @@ Returns:
 
   InitAtapiIoPortRegisters(AtapiScsiPrivate, IdeRegsBaseAddr);
 
+  //
+  // Bus master DMA is optional, PIO is used if the PRD table can not be set up.
+  //
+  AtapiDmaInit (AtapiScsiPrivate);
+
   //
   // Initialize the LatestTargetId to MAX_TARGET_ID.
   //
@@ -449,6 +457,9 @@ Returns:
   AtapiScsiPrivate->LatestLun       = 0;
 
   Status = InstallScsiPassThruProtocols (&Controller, AtapiScsiPrivate);
+  if (EFI_ERROR (Status)) {
+    AtapiDmaFree (AtapiScsiPrivate);
+  }
 
   return Status;
 }
@@ -1617,6 +1628,21 @@ Returns:
     (UINT16) ((PciData.Device.Bar[3] & 0x0000fffc) + 2);
   }
 
+  //
+  // The bus master registers of both channels are in the IO BAR 4
+  //
+  if ((PciData.Hdr.ClassCode[0] & IDE_BUS_MASTER_CAPABLE) != 0 &&
+      (PciData.Device.Bar[4] & BIT0) != 0 &&
+      (PciData.Device.Bar[4] & 0x0000fff0) != 0) {
+    IdeRegsBaseAddr[IdePrimary].BusMasterBaseAddr   =
+    (UINT16) (PciData.Device.Bar[4] & 0x0000fff0);
+    IdeRegsBaseAddr[IdeSecondary].BusMasterBaseAddr =
+    (UINT16) ((PciData.Device.Bar[4] & 0x0000fff0) + BUS_MASTER_CHANNEL_SIZE);
+  } else {
+    IdeRegsBaseAddr[IdePrimary].BusMasterBaseAddr   = 0;
+    IdeRegsBaseAddr[IdeSecondary].BusMasterBaseAddr = 0;
+  }
+
   return EFI_SUCCESS;
 }
 
@@ -1629,7 +1655,8 @@ InitAtapiIoPortRegisters (
 
 Routine Description:
 
-  Initialize each Channel's Base Address of CommandBlock and ControlBlock.
+  Initialize each Channel's Base Address of CommandBlock, ControlBlock and
+  bus master registers.
 
 Arguments:
 
@@ -1671,6 +1698,8 @@ Returns:
 
     (*(UINT16 *) &RegisterPointer->Alt) = ControlBlockBaseAddr;
     RegisterPointer->DriveAddress = (UINT16) (ControlBlockBaseAddr + 0x01);
+
+    RegisterPointer->BusMasterBaseAddr = IdeRegsBaseAddr[IdeChannel].BusMasterBaseAddr;
   }
 
 }
@@ -2140,6 +2169,10 @@ AtapiPacketCommand (
 Routine Description:
 
   Submits ATAPI command packet to the specified ATAPI device.
+  Bus master DMA is used for the read and write commands if the device and
+  the controller support it, PIO is used otherwise. If the bus master
+  transfer fails, DMA is disabled for the device and the command is
+  submitted again with PIO.
 
 Arguments:
 
@@ -2168,6 +2201,112 @@ Returns:
 
   EFI_STATUS
 
+--*/
+{
+  EFI_STATUS  Status;
+  UINT32      RequestedByteCount;
+  VOID        *DmaMapping;
+  UINT32      Channel;
+
+  RequestedByteCount = *ByteCount;
+  DmaMapping         = NULL;
+
+  if (AtapiDmaSupported (AtapiScsiPrivate, Target, PacketCommand, Buffer, *ByteCount, Direction)) {
+    Status = AtapiPassThruDmaPrepare (
+               AtapiScsiPrivate,
+               Buffer,
+               *ByteCount,
+               Direction,
+               &DmaMapping
+               );
+    if (!EFI_ERROR (Status)) {
+      Status = AtapiPacketCommandIssue (
+                 AtapiScsiPrivate,
+                 Target,
+                 PacketCommand,
+                 Buffer,
+                 ByteCount,
+                 Direction,
+                 TimeoutInMicroSeconds,
+                 TRUE
+                 );
+      AtapiScsiPrivate->PciIo->Unmap (AtapiScsiPrivate->PciIo, DmaMapping);
+      if (Status != EFI_UNSUPPORTED) {
+        return Status;
+      }
+
+      //
+      // The bus master failed without an error reported by the device,
+      // use PIO for this device from now on.
+      //
+      Channel = (UINT32) (AtapiScsiPrivate->IoPort - AtapiScsiPrivate->AtapiIoPortRegisters);
+      DEBUG ((EFI_D_ERROR, "ATAPI: bus master DMA failed on channel %d device %d, using PIO\n", Channel, Target));
+      AtapiScsiPrivate->DmaState[Channel][Target] = AtapiDmaUnsupported;
+      *ByteCount = RequestedByteCount;
+    }
+  }
+
+  return AtapiPacketCommandIssue (
+           AtapiScsiPrivate,
+           Target,
+           PacketCommand,
+           Buffer,
+           ByteCount,
+           Direction,
+           TimeoutInMicroSeconds,
+           FALSE
+           );
+}
+
+EFI_STATUS
+AtapiPacketCommandIssue (
+  ATAPI_SCSI_PASS_THRU_DEV    *AtapiScsiPrivate,
+  UINT32                      Target,
+  UINT8                       *PacketCommand,
+  VOID                        *Buffer,
+  UINT32                      *ByteCount,
+  DATA_DIRECTION              Direction,
+  UINT64                      TimeoutInMicroSeconds,
+  BOOLEAN                     UseDma
+  )
+/*++
+
+Routine Description:
+
+  Issues ATAPI command packet to the specified ATAPI device and performs
+  the data transfer with PIO or with bus master DMA. For DMA, the bus master
+  registers must have been set up by AtapiPassThruDmaPrepare().
+
+Arguments:
+
+  AtapiScsiPrivate:   Private data structure for the specified channel.
+  Target:             The Target ID of the ATAPI device to send the SCSI
+                      Request Packet. To ATAPI devices attached on an IDE
+                      Channel, Target ID 0 indicates Master device;Target
+                      ID 1 indicates Slave device.
+  PacketCommand:      Points to the ATAPI command packet.
+  Buffer:             Points to the transferred data.
+  ByteCount:          When input,indicates the buffer size; when output,
+                      indicates the actually transferred data size.
+  Direction:          Indicates the data transfer direction.
+  TimeoutInMicroSeconds:
+                      The timeout, in micro second units, to use for the
+                      execution of this ATAPI command.
+                      A TimeoutInMicroSeconds value of 0 means that
+                      this function will wait indefinitely for the ATAPI
+                      command to execute.
+                      If TimeoutInMicroSeconds is greater than zero, then
+                      this function will return EFI_TIMEOUT if the time
+                      required to execute the ATAPI command is greater
+                      than TimeoutInMicroSeconds.
+  UseDma:             TRUE to transfer the data with bus master DMA.
+
+Returns:
+
+  EFI_UNSUPPORTED     - The bus master transfer failed, the command may be
+                        submitted again with PIO.
+  Others              - EFI_STATUS of the command.
+
 --*/
 {
 
@@ -2210,12 +2349,12 @@ Returns:
   }
 
   //
-  // No OVL; No DMA (by setting feature register)
+  // No OVL; DMA only if requested (by setting feature register)
   //
   WritePortB (
     AtapiScsiPrivate->PciIo,
     AtapiScsiPrivate->IoPort->Reg1.Feature,
-    0x00
+    (UINT8) (UseDma ? DMA : 0x00)
     );
 
   //
@@ -2276,6 +2415,14 @@ Returns:
     WritePortW (AtapiScsiPrivate->PciIo, AtapiScsiPrivate->IoPort->Data, *CommandIndex);
   }
 
+  if (UseDma) {
+    return AtapiPassThruDmaReadWriteData (
+             AtapiScsiPrivate,
+             ByteCount,
+             TimeoutInMicroSeconds
+             );
+  }
+
   //
   // call AtapiPassThruPioReadWriteData() function to get
   // requested transfer data form device.
@@ -2416,6 +2563,505 @@ Arguments:
 }
 
 
+VOID
+AtapiDmaInit (
+  ATAPI_SCSI_PASS_THRU_DEV  *AtapiScsiPrivate
+  )
+/*++
+
+Routine Description:
+
+  Allocates the PRD table used by the bus master of both channels.
+  If the controller is not bus master capable or the PRD table can not
+  be allocated, all the transfers are done with PIO.
+
+Arguments:
+
+  AtapiScsiPrivate            - The pointer of ATAPI_SCSI_PASS_THRU_DEV
+
+Returns:
+
+  None
+
+--*/
+{
+  EFI_STATUS            Status;
+  EFI_PCI_IO_PROTOCOL   *PciIo;
+  VOID                  *PrdTable;
+  UINTN                 Bytes;
+  EFI_PHYSICAL_ADDRESS  DeviceAddress;
+  VOID                  *Mapping;
+
+  AtapiScsiPrivate->PrdTable = NULL;
+
+  if (AtapiScsiPrivate->AtapiIoPortRegisters[IdePrimary].BusMasterBaseAddr == 0) {
+    return;
+  }
+
+  PciIo  = AtapiScsiPrivate->PciIo;
+  Status = PciIo->AllocateBuffer (
+                    PciIo,
+                    AllocateAnyPages,
+                    EfiBootServicesData,
+                    ATAPI_PRD_TABLE_PAGES,
+                    &PrdTable,
+                    0
+                    );
+  if (EFI_ERROR (Status)) {
+    return;
+  }
+
+  Bytes  = EFI_PAGES_TO_SIZE (ATAPI_PRD_TABLE_PAGES);
+  Status = PciIo->Map (
+                    PciIo,
+                    EfiPciIoOperationBusMasterCommonBuffer,
+                    PrdTable,
+                    &Bytes,
+                    &DeviceAddress,
+                    &Mapping
+                    );
+  if (EFI_ERROR (Status) || (Bytes != EFI_PAGES_TO_SIZE (ATAPI_PRD_TABLE_PAGES)) ||
+      (DeviceAddress + Bytes > BASE_4GB)) {
+    if (!EFI_ERROR (Status)) {
+      PciIo->Unmap (PciIo, Mapping);
+    }
+    PciIo->FreeBuffer (PciIo, ATAPI_PRD_TABLE_PAGES, PrdTable);
+    return;
+  }
+
+  AtapiScsiPrivate->PrdTable              = PrdTable;
+  AtapiScsiPrivate->PrdTableDeviceAddress = DeviceAddress;
+  AtapiScsiPrivate->PrdTableMapping       = Mapping;
+}
+
+VOID
+AtapiDmaFree (
+  ATAPI_SCSI_PASS_THRU_DEV  *AtapiScsiPrivate
+  )
+/*++
+
+Routine Description:
+
+  Frees the PRD table allocated by AtapiDmaInit().
+
+Arguments:
+
+  AtapiScsiPrivate            - The pointer of ATAPI_SCSI_PASS_THRU_DEV
+
+Returns:
+
+  None
+
+--*/
+{
+  EFI_PCI_IO_PROTOCOL   *PciIo;
+
+  if (AtapiScsiPrivate->PrdTable == NULL) {
+    return;
+  }
+
+  PciIo = AtapiScsiPrivate->PciIo;
+  PciIo->Unmap (PciIo, AtapiScsiPrivate->PrdTableMapping);
+  PciIo->FreeBuffer (PciIo, ATAPI_PRD_TABLE_PAGES, AtapiScsiPrivate->PrdTable);
+  AtapiScsiPrivate->PrdTable = NULL;
+}
+
+EFI_STATUS
+AtapiIdentifyPacketDevice (
+  ATAPI_SCSI_PASS_THRU_DEV  *AtapiScsiPrivate,
+  UINT32                    Target,
+  UINT16                    *IdentifyData
+  )
+/*++
+
+Routine Description:
+
+  Sends IDENTIFY PACKET DEVICE command to the specified ATAPI device
+  and reads the 256 words of identify data with PIO.
+
+Arguments:
+
+  AtapiScsiPrivate:   Private data structure for the specified channel.
+  Target:             Target ID 0 indicates Master device; Target ID 1
+                      indicates Slave device.
+  IdentifyData:       Points to the buffer of 256 words to receive the
+                      identify data.
+
+Returns:
+
+  EFI_STATUS
+
+--*/
+{
+  EFI_STATUS  Status;
+  UINTN       Index;
+
+  Status = StatusWaitForBSYClear (AtapiScsiPrivate, ATAPI_IDENTIFY_TIMEOUT);
+  if (EFI_ERROR (Status)) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  WritePortB (
+    AtapiScsiPrivate->PciIo,
+    AtapiScsiPrivate->IoPort->Head,
+    (UINT8) ((Target << 4) | DEFAULT_CMD)
+    );
+
+  Status = StatusDRQClear (AtapiScsiPrivate, ATAPI_IDENTIFY_TIMEOUT);
+  if (EFI_ERROR (Status)) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  WritePortB (
+    AtapiScsiPrivate->PciIo,
+    AtapiScsiPrivate->IoPort->Alt.DeviceControl,
+    DEFAULT_CTL
+    );
+
+  WritePortB (
+    AtapiScsiPrivate->PciIo,
+    AtapiScsiPrivate->IoPort->Reg.Command,
+    ATAPI_IDENTIFY_CMD
+    );
+
+  Status = StatusDRQReady (AtapiScsiPrivate, ATAPI_IDENTIFY_TIMEOUT);
+  if (EFI_ERROR (Status)) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  for (Index = 0; Index < 256; Index++) {
+    IdentifyData[Index] = ReadPortW (AtapiScsiPrivate->PciIo, AtapiScsiPrivate->IoPort->Data);
+  }
+
+  StatusDRQClear (AtapiScsiPrivate, ATAPI_IDENTIFY_TIMEOUT);
+
+  return AtapiPassThruCheckErrorStatus (AtapiScsiPrivate);
+}
+
+BOOLEAN
+AtapiDmaSupported (
+  ATAPI_SCSI_PASS_THRU_DEV    *AtapiScsiPrivate,
+  UINT32                      Target,
+  UINT8                       *PacketCommand,
+  VOID                        *Buffer,
+  UINT32                      ByteCount,
+  DATA_DIRECTION              Direction
+  )
+/*++
+
+Routine Description:
+
+  Checks whether an ATAPI command packet can be submitted with bus master DMA.
+  Only the read and write commands are transferred with DMA, and only when
+  the byte count is a multiple of 4. Whether the device supports DMA is read
+  from its identify data on the first use.
+
+Arguments:
+
+  AtapiScsiPrivate:   Private data structure for the specified channel.
+  Target:             Target ID 0 indicates Master device; Target ID 1
+                      indicates Slave device.
+  PacketCommand:      Points to the ATAPI command packet.
+  Buffer:             Points to the transferred data.
+  ByteCount:          The buffer size.
+  Direction:          Indicates the data transfer direction.
+
+Returns:
+
+  TRUE if the command can be submitted with bus master DMA.
+
+--*/
+{
+  UINT32      Channel;
+  UINT16      IdentifyData[256];
+
+  if ((AtapiScsiPrivate->PrdTable == NULL) ||
+      (AtapiScsiPrivate->IoPort->BusMasterBaseAddr == 0) ||
+      (Buffer == NULL) || (ByteCount == 0) || ((ByteCount & 3) != 0) ||
+      ((Direction != DataIn) && (Direction != DataOut))) {
+    return FALSE;
+  }
+
+  switch (PacketCommand[0]) {
+  case OP_READ_10:
+  case OP_READ_12:
+  case OP_READ_CD:
+  case OP_WRITE_10:
+  case OP_WRITE_12:
+    break;
+
+  default:
+    return FALSE;
+  }
+
+  Channel = (UINT32) (AtapiScsiPrivate->IoPort - AtapiScsiPrivate->AtapiIoPortRegisters);
+  if (AtapiScsiPrivate->DmaState[Channel][Target] == AtapiDmaUnknown) {
+    AtapiScsiPrivate->DmaState[Channel][Target] = AtapiDmaUnsupported;
+    if (!EFI_ERROR (AtapiIdentifyPacketDevice (AtapiScsiPrivate, Target, IdentifyData)) &&
+        ((IdentifyData[ATAPI_IDENTIFY_CAPABILITIES] & ATAPI_IDENTIFY_DMA_SUPPORTED) != 0)) {
+      AtapiScsiPrivate->DmaState[Channel][Target] = AtapiDmaSupported;
+    }
+  }
+
+  return (BOOLEAN) (AtapiScsiPrivate->DmaState[Channel][Target] == AtapiDmaSupported);
+}
+
+EFI_STATUS
+AtapiPassThruDmaPrepare (
+  ATAPI_SCSI_PASS_THRU_DEV  *AtapiScsiPrivate,
+  VOID                      *Buffer,
+  UINT32                    ByteCount,
+  DATA_DIRECTION            Direction,
+  VOID                      **Mapping
+  )
+/*++
+
+Routine Description:
+
+  Maps the data buffer for the bus master, builds the PRD table describing
+  it and programs the bus master registers of the channel. The bus master
+  is not started.
+
+Arguments:
+
+  AtapiScsiPrivate:   Private data structure for the specified channel.
+  Buffer:             Points to the transferred data.
+  ByteCount:          The buffer size.
+  Direction:          Indicates the data transfer direction.
+  Mapping:            Returns the mapping of the data buffer, to be
+                      unmapped by the caller once the transfer is done.
+
+Returns:
+
+  EFI_SUCCESS         - The bus master is ready to start.
+  EFI_UNSUPPORTED     - The buffer can not be transferred with DMA.
+  Others              - The buffer can not be mapped.
+
+--*/
+{
+  EFI_STATUS            Status;
+  EFI_PCI_IO_PROTOCOL   *PciIo;
+  UINTN                 Bytes;
+  EFI_PHYSICAL_ADDRESS  DeviceAddress;
+  ATAPI_PRD             *Prd;
+  UINT32                Address;
+  UINT32                Remaining;
+  UINT32                Length;
+  UINTN                 Index;
+  UINT16                BusMasterBaseAddr;
+  UINT8                 RegisterValue;
+
+  PciIo  = AtapiScsiPrivate->PciIo;
+  Bytes  = ByteCount;
+  Status = PciIo->Map (
+                    PciIo,
+                    (Direction == DataIn) ? EfiPciIoOperationBusMasterWrite : EfiPciIoOperationBusMasterRead,
+                    Buffer,
+                    &Bytes,
+                    &DeviceAddress,
+                    Mapping
+                    );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  //
+  // The PRD entries hold dword aligned addresses below 4GB
+  //
+  if ((Bytes != ByteCount) || ((DeviceAddress & 3) != 0) ||
+      (DeviceAddress + Bytes > BASE_4GB)) {
+    PciIo->Unmap (PciIo, *Mapping);
+    return EFI_UNSUPPORTED;
+  }
+
+  //
+  // A region described by a PRD entry must not cross a 64KB boundary
+  //
+  Prd       = AtapiScsiPrivate->PrdTable;
+  Address   = (UINT32) DeviceAddress;
+  Remaining = ByteCount;
+  for (Index = 0; Remaining > 0; Index++) {
+    if (Index == ATAPI_MAX_PRD_ENTRIES) {
+      PciIo->Unmap (PciIo, *Mapping);
+      return EFI_UNSUPPORTED;
+    }
+
+    Length = PRD_MAX_BYTE_COUNT - (Address & (PRD_MAX_BYTE_COUNT - 1));
+    if (Length > Remaining) {
+      Length = Remaining;
+    }
+
+    Prd[Index].RegionBaseAddr = Address;
+    Prd[Index].ByteCount      = (UINT16) Length;
+    Prd[Index].EndOfTable     = 0;
+
+    Address   += Length;
+    Remaining -= Length;
+  }
+  Prd[Index - 1].EndOfTable = PRD_EOT;
+
+  //
+  // Set the PRD table address, clear the interrupt and error bits and set
+  // the transfer direction
+  //
+  BusMasterBaseAddr = AtapiScsiPrivate->IoPort->BusMasterBaseAddr;
+  WritePortDW (
+    PciIo,
+    (UINT16) (BusMasterBaseAddr + BMID_OFFSET),
+    (UINT32) AtapiScsiPrivate->PrdTableDeviceAddress
+    );
+
+  RegisterValue = ReadPortB (PciIo, (UINT16) (BusMasterBaseAddr + BMIS_OFFSET));
+  WritePortB (
+    PciIo,
+    (UINT16) (BusMasterBaseAddr + BMIS_OFFSET),
+    (UINT8) (RegisterValue | BMIS_INTERRUPT | BMIS_ERROR)
+    );
+
+  WritePortB (
+    PciIo,
+    (UINT16) (BusMasterBaseAddr + BMIC_OFFSET),
+    (UINT8) ((Direction == DataIn) ? BMIC_NREAD : 0)
+    );
+
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+AtapiPassThruDmaReadWriteData (
+  ATAPI_SCSI_PASS_THRU_DEV  *AtapiScsiPrivate,
+  UINT32                    *ByteCount,
+  UINT64                    TimeoutInMicroSeconds
+  )
+/*++
+
+Routine Description:
+
+  Performs the bus master data transfer set up by AtapiPassThruDmaPrepare()
+  after the ATAPI command packet is sent. The device keeps BSY set until
+  the command completes, so the completion is polled on the alternate
+  status register instead of DRQ for every block.
+
+Arguments:
+
+  AtapiScsiPrivate:   Private data structure for the specified channel.
+  ByteCount:          When input,indicates the buffer size; when output,
+                      indicates the actually transferred data size.
+  TimeoutInMicroSeconds:
+                      The timeout, in micro second units, to use for the
+                      execution of this ATAPI command.
+                      A TimeoutInMicroSeconds value of 0 means that
+                      this function will wait indefinitely for the ATAPI
+                      command to execute.
+
+Returns:
+
+  EFI_UNSUPPORTED     - The bus master failed, the command may be
+                        submitted again with PIO.
+  Others              - EFI_STATUS of the command.
+
+--*/
+{
+  EFI_STATUS            Status;
+  EFI_PCI_IO_PROTOCOL   *PciIo;
+  UINT16                BusMasterBaseAddr;
+  UINT8                 BusMasterStatus;
+  UINT8                 AltRegister;
+  UINT64                Delay;
+
+  PciIo             = AtapiScsiPrivate->PciIo;
+  BusMasterBaseAddr = AtapiScsiPrivate->IoPort->BusMasterBaseAddr;
+
+  //
+  // Start the bus master
+  //
+  WritePortB (
+    PciIo,
+    (UINT16) (BusMasterBaseAddr + BMIC_OFFSET),
+    (UINT8) (ReadPortB (PciIo, (UINT16) (BusMasterBaseAddr + BMIC_OFFSET)) | BMIC_START)
+    );
+
+  if (TimeoutInMicroSeconds == 0) {
+    Delay = 2;
+  } else {
+    Delay = DivU64x32 (TimeoutInMicroSeconds, (UINT32) 30) + 1;
+  }
+
+  do {
+    BusMasterStatus = ReadPortB (PciIo, (UINT16) (BusMasterBaseAddr + BMIS_OFFSET));
+    if ((BusMasterStatus & BMIS_ERROR) != 0) {
+      break;
+    }
+
+    AltRegister = ReadPortB (PciIo, AtapiScsiPrivate->IoPort->Alt.AltStatus);
+    if ((AltRegister & BSY) == 0x00) {
+      break;
+    }
+
+    //
+    // Stall for 30 us
+    //
+    gBS->Stall (30);
+
+    //
+    // Loop infinitely if not meeting expected condition
+    //
+    if (TimeoutInMicroSeconds == 0) {
+      Delay = 2;
+    }
+
+    Delay--;
+  } while (Delay);
+
+  //
+  // Sample the status before stopping the bus master, clearing the start
+  // bit also clears the active bit. Then clear the interrupt and error bits.
+  //
+  BusMasterStatus = ReadPortB (PciIo, (UINT16) (BusMasterBaseAddr + BMIS_OFFSET));
+  WritePortB (
+    PciIo,
+    (UINT16) (BusMasterBaseAddr + BMIC_OFFSET),
+    (UINT8) (ReadPortB (PciIo, (UINT16) (BusMasterBaseAddr + BMIC_OFFSET)) & ~BMIC_START)
+    );
+  WritePortB (
+    PciIo,
+    (UINT16) (BusMasterBaseAddr + BMIS_OFFSET),
+    (UINT8) (BusMasterStatus | BMIS_INTERRUPT | BMIS_ERROR)
+    );
+
+  if ((BusMasterStatus & BMIS_ERROR) != 0) {
+    *ByteCount = 0;
+    return EFI_UNSUPPORTED;
+  }
+
+  if (Delay == 0) {
+    *ByteCount = 0;
+    return EFI_TIMEOUT;
+  }
+
+  //
+  // The device reports the errors of the command itself, the sense data
+  // is requested by the caller as for PIO.
+  //
+  Status = AtapiPassThruCheckErrorStatus (AtapiScsiPrivate);
+  if (EFI_ERROR (Status)) {
+    *ByteCount = 0;
+    return Status;
+  }
+
+  //
+  // The device completed the command without asking for any data while
+  // the bus master is still waiting for it, DMA does not work on this device.
+  //
+  if ((BusMasterStatus & (BMIS_ACTIVE | BMIS_INTERRUPT)) == BMIS_ACTIVE) {
+    *ByteCount = 0;
+    return EFI_UNSUPPORTED;
+  }
+
+  return EFI_SUCCESS;
+}
+
+
 UINT8
 ReadPortB (
   IN  EFI_PCI_IO_PROTOCOL   *PciIo,
@@ -2558,6 +3204,41 @@ Returns:
               );
 }
 
+
+VOID
+WritePortDW (
+  IN  EFI_PCI_IO_PROTOCOL   *PciIo,
+  IN  UINT16                Port,
+  IN  UINT32                Data
+  )
+/*++
+
+Routine Description:
+
+  Write one dword to a specified I/O port.
+
+Arguments:
+
+  PciIo      - The pointer of EFI_PCI_IO_PROTOCOL
+  Port       - IO port
+  Data       - The data to write
+
+Returns:
+
+   NONE
+
+--*/
+{
+  PciIo->Io.Write (
+              PciIo,
+              EfiPciIoWidthUint32,
+              EFI_PCI_IO_PASS_THROUGH_BAR,
+              (UINT64) Port,
+              1,
+              &Data
+              );
+}
+
 EFI_STATUS
 StatusDRQClear (
   ATAPI_SCSI_PASS_THRU_DEV        *AtapiScsiPrivate,
@@ -68,6 +68,43 @@ typedef enum {
 #define IDE_PRIMARY_PROGRAMMABLE_INDICATOR    BIT1
 #define IDE_SECONDARY_OPERATING_MODE          BIT2
 #define IDE_SECONDARY_PROGRAMMABLE_INDICATOR  BIT3
+#define IDE_BUS_MASTER_CAPABLE                BIT7
+
+//
+// Bus master IDE registers, offsets from the bus master base address of a channel.
+// The registers of the secondary channel follow those of the primary channel.
+//
+#define BMIC_OFFSET                           0x00
+#define BMIS_OFFSET                           0x02
+#define BMID_OFFSET                           0x04
+#define BUS_MASTER_CHANNEL_SIZE               0x08
+
+#define BMIC_START                            BIT0
+#define BMIC_NREAD                            BIT3 ///< Bus master writes the data read from the device to memory
+
+#define BMIS_ACTIVE                           BIT0
+#define BMIS_ERROR                            BIT1
+#define BMIS_INTERRUPT                        BIT2
+
+///
+/// Physical Region Descriptor of the bus master PRD table
+///
+typedef struct {
+  UINT32  RegionBaseAddr;
+  UINT16  ByteCount;      ///< 0 means 64KB
+  UINT16  EndOfTable;
+} ATAPI_PRD;
+
+#define PRD_EOT                               BIT15
+#define PRD_MAX_BYTE_COUNT                    SIZE_64KB
+#define ATAPI_PRD_TABLE_PAGES                 1
+#define ATAPI_MAX_PRD_ENTRIES                 (EFI_PAGES_TO_SIZE (ATAPI_PRD_TABLE_PAGES) / sizeof (ATAPI_PRD))
+
+typedef enum {
+  AtapiDmaUnknown     = 0,
+  AtapiDmaSupported   = 1,
+  AtapiDmaUnsupported = 2
+} ATAPI_DMA_STATE;
 
 
 #define ATAPI_MAX_CHANNEL 2
@@ -86,6 +123,7 @@ typedef struct {
   IDE_CMD_OR_STATUS               Reg;
   IDE_AltStatus_OR_DeviceControl  Alt;
   UINT16                          DriveAddress;
+  UINT16                          BusMasterBaseAddr;  ///< 0 if the channel is not bus master capable
 } IDE_BASE_REGISTERS;
 
 #define ATAPI_SCSI_PASS_THRU_DEV_SIGNATURE  SIGNATURE_32 ('a', 's', 'p', 't')
@@ -104,6 +142,13 @@ typedef struct {
   IDE_BASE_REGISTERS               AtapiIoPortRegisters[2];
   UINT32                           LatestTargetId;
   UINT64                           LatestLun;
+  //
+  // Bus master DMA, the PRD table is NULL if only PIO is used
+  //
+  ATAPI_PRD                        *PrdTable;
+  EFI_PHYSICAL_ADDRESS             PrdTableDeviceAddress;
+  VOID                             *PrdTableMapping;
+  UINT8                            DmaState[ATAPI_MAX_CHANNEL][2];
 } ATAPI_SCSI_PASS_THRU_DEV;
 
 //
@@ -112,6 +157,7 @@ typedef struct {
 typedef struct {
   UINT16  CommandBlockBaseAddr;
   UINT16  ControlBlockBaseAddr;
+  UINT16  BusMasterBaseAddr;
 } IDE_REGISTERS_BASE_ADDR;
 
 #define ATAPI_SCSI_PASS_THRU_DEV_FROM_THIS(a) \
@@ -177,6 +223,15 @@ extern EFI_DRIVER_SUPPORTED_EFI_VERSION_PROTOCOL  gAtapiScsiPassThruDriverSuppor
 // ATA Command
 //
 #define ATAPI_SOFT_RESET_CMD  0x08
+#define ATAPI_IDENTIFY_CMD    0xA1
+
+//
+// IDENTIFY PACKET DEVICE data
+//
+#define ATAPI_IDENTIFY_CAPABILITIES   49    ///< Word index of the capabilities
+#define ATAPI_IDENTIFY_DMA_SUPPORTED  BIT8
+
+#define ATAPI_IDENTIFY_TIMEOUT        1000000 ///< 1 second, in microseconds
 
 typedef enum {
   DataIn  = 0,
@@ -1176,6 +1231,58 @@ Returns:
 --*/
 ;
 
+EFI_STATUS
+AtapiPacketCommandIssue (
+  ATAPI_SCSI_PASS_THRU_DEV    *AtapiScsiPrivate,
+  UINT32                      Target,
+  UINT8                       *PacketCommand,
+  VOID                        *Buffer,
+  UINT32                      *ByteCount,
+  DATA_DIRECTION              Direction,
+  UINT64                      TimeoutInMicroSeconds,
+  BOOLEAN                     UseDma
+  )
+/*++
+
+Routine Description:
+
+  Issues ATAPI command packet to the specified ATAPI device and performs
+  the data transfer with PIO or with bus master DMA. For DMA, the bus master
+  registers must have been set up by AtapiPassThruDmaPrepare().
+
+Arguments:
+
+  AtapiScsiPrivate:   Private data structure for the specified channel.
+  Target:             The Target ID of the ATAPI device to send the SCSI
+                      Request Packet. To ATAPI devices attached on an IDE
+                      Channel, Target ID 0 indicates Master device;Target
+                      ID 1 indicates Slave device.
+  PacketCommand:      Points to the ATAPI command packet.
+  Buffer:             Points to the transferred data.
+  ByteCount:          When input,indicates the buffer size; when output,
+                      indicates the actually transferred data size.
+  Direction:          Indicates the data transfer direction.
+  TimeoutInMicroSeconds:
+                      The timeout, in micro second units, to use for the
+                      execution of this ATAPI command.
+                      A TimeoutInMicroSeconds value of 0 means that
+                      this function will wait indefinitely for the ATAPI
+                      command to execute.
+                      If TimeoutInMicroSeconds is greater than zero, then
+                      this function will return EFI_TIMEOUT if the time
+                      required to execute the ATAPI command is greater
+                      than TimeoutInMicroSeconds.
+  UseDma:             TRUE to transfer the data with bus master DMA.
+
+Returns:
+
+  EFI_UNSUPPORTED     - The bus master transfer failed, the command may be
+                        submitted again with PIO.
+  Others              - EFI_STATUS of the command.
+
+--*/
+;
+
 
 UINT8
 ReadPortB (
@@ -1276,6 +1383,31 @@ Returns:
 --*/
 ;
 
+VOID
+WritePortDW (
+  IN  EFI_PCI_IO_PROTOCOL   *PciIo,
+  IN  UINT16                Port,
+  IN  UINT32                Data
+  )
+/*++
+
+Routine Description:
+
+  Write one dword to a specified I/O port.
+
+Arguments:
+
+  PciIo      - The pointer of EFI_PCI_IO_PROTOCOL
+  Port       - IO port
+  Data       - The data to write
+  
+Returns:
+
+  NONE
+  
+--*/
+;
+
 EFI_STATUS
 StatusDRQClear (
   ATAPI_SCSI_PASS_THRU_DEV        *AtapiScsiPrivate,
@@ -1526,6 +1658,182 @@ Arguments:
 --*/
 ;
 
+VOID
+AtapiDmaInit (
+  ATAPI_SCSI_PASS_THRU_DEV  *AtapiScsiPrivate
+  )
+/*++
+
+Routine Description:
+
+  Allocates the PRD table used by the bus master of both channels.
+  If the controller is not bus master capable or the PRD table can not
+  be allocated, all the transfers are done with PIO.
+
+Arguments:
+
+  AtapiScsiPrivate            - The pointer of ATAPI_SCSI_PASS_THRU_DEV
+
+Returns:
+
+  None
+
+--*/
+;
+
+VOID
+AtapiDmaFree (
+  ATAPI_SCSI_PASS_THRU_DEV  *AtapiScsiPrivate
+  )
+/*++
+
+Routine Description:
+
+  Frees the PRD table allocated by AtapiDmaInit().
+
+Arguments:
+
+  AtapiScsiPrivate            - The pointer of ATAPI_SCSI_PASS_THRU_DEV
+
+Returns:
+
+  None
+
+--*/
+;
+
+EFI_STATUS
+AtapiIdentifyPacketDevice (
+  ATAPI_SCSI_PASS_THRU_DEV  *AtapiScsiPrivate,
+  UINT32                    Target,
+  UINT16                    *IdentifyData
+  )
+/*++
+
+Routine Description:
+
+  Sends IDENTIFY PACKET DEVICE command to the specified ATAPI device
+  and reads the 256 words of identify data with PIO.
+
+Arguments:
+
+  AtapiScsiPrivate:   Private data structure for the specified channel.
+  Target:             Target ID 0 indicates Master device; Target ID 1
+                      indicates Slave device.
+  IdentifyData:       Points to the buffer of 256 words to receive the
+                      identify data.
+
+Returns:
+
+  EFI_STATUS
+
+--*/
+;
+
+BOOLEAN
+AtapiDmaSupported (
+  ATAPI_SCSI_PASS_THRU_DEV    *AtapiScsiPrivate,
+  UINT32                      Target,
+  UINT8                       *PacketCommand,
+  VOID                        *Buffer,
+  UINT32                      ByteCount,
+  DATA_DIRECTION              Direction
+  )
+/*++
+
+Routine Description:
+
+  Checks whether an ATAPI command packet can be submitted with bus master DMA.
+  Only the read and write commands are transferred with DMA. Whether the
+  device supports DMA is read from its identify data on the first use.
+
+Arguments:
+
+  AtapiScsiPrivate:   Private data structure for the specified channel.
+  Target:             Target ID 0 indicates Master device; Target ID 1
+                      indicates Slave device.
+  PacketCommand:      Points to the ATAPI command packet.
+  Buffer:             Points to the transferred data.
+  ByteCount:          The buffer size.
+  Direction:          Indicates the data transfer direction.
+
+Returns:
+
+  TRUE if the command can be submitted with bus master DMA.
+
+--*/
+;
+
+EFI_STATUS
+AtapiPassThruDmaPrepare (
+  ATAPI_SCSI_PASS_THRU_DEV  *AtapiScsiPrivate,
+  VOID                      *Buffer,
+  UINT32                    ByteCount,
+  DATA_DIRECTION            Direction,
+  VOID                      **Mapping
+  )
+/*++
+
+Routine Description:
+
+  Maps the data buffer for the bus master, builds the PRD table describing
+  it and programs the bus master registers of the channel. The bus master
+  is not started.
+
+Arguments:
+
+  AtapiScsiPrivate:   Private data structure for the specified channel.
+  Buffer:             Points to the transferred data.
+  ByteCount:          The buffer size.
+  Direction:          Indicates the data transfer direction.
+  Mapping:            Returns the mapping of the data buffer, to be
+                      unmapped by the caller once the transfer is done.
+
+Returns:
+
+  EFI_SUCCESS         - The bus master is ready to start.
+  EFI_UNSUPPORTED     - The buffer can not be transferred with DMA.
+  Others              - The buffer can not be mapped.
+
+--*/
+;
+
+EFI_STATUS
+AtapiPassThruDmaReadWriteData (
+  ATAPI_SCSI_PASS_THRU_DEV  *AtapiScsiPrivate,
+  UINT32                    *ByteCount,
+  UINT64                    TimeoutInMicroSeconds
+  )
+/*++
+
+Routine Description:
+
+  Performs the bus master data transfer set up by AtapiPassThruDmaPrepare()
+  after the ATAPI command packet is sent. The device keeps BSY set until
+  the command completes, so the completion is polled on the alternate
+  status register instead of DRQ for every block.
+
+Arguments:
+
+  AtapiScsiPrivate:   Private data structure for the specified channel.
+  ByteCount:          When input,indicates the buffer size; when output,
+                      indicates the actually transferred data size.
+  TimeoutInMicroSeconds:
+                      The timeout, in micro second units, to use for the
+                      execution of this ATAPI command.
+                      A TimeoutInMicroSeconds value of 0 means that
+                      this function will wait indefinitely for the ATAPI
+                      command to execute.
+
+Returns:
+
+  EFI_UNSUPPORTED     - The bus master failed, the command may be
+                        submitted again with PIO.
+  Others              - EFI_STATUS of the command.
+
+--*/
+;
+
 EFI_STATUS
 AtapiPassThruCheckErrorStatus (
   ATAPI_SCSI_PASS_THRU_DEV        *AtapiScsiPrivate
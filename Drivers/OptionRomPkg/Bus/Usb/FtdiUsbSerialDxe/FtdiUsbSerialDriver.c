@@ -204,38 +204,82 @@ SetStatusInternal (
 }
 
 /**
-  Initiates a read operation on the Usb Serial Device.
+  Reads data out of the receive FIFO of the Usb Serial Device.
+
+  This is the only function that moves DataBufferHead and ReadDataFromUsb() is
+  the only one that moves DataBufferTail, so the FIFO can be read without
+  raising the TPL while the polling loop refills it.
 
   @param  UsbSerialDevice[in]        Handle to the USB device to read
   @param  BufferSize[in, out]        On input, the size of the Buffer. On output,
                                      the amount of data returned in Buffer.
-                                     Setting this to zero will initiate a read
-                                     and store all data returned in the internal
-                                     buffer.
   @param  Buffer [out]               The buffer to return the data into.
 
+**/
+VOID
+EFIAPI
+ReadDataFromFifo (
+  IN USB_SER_DEV  *UsbSerialDevice,
+  IN OUT UINTN    *BufferSize,
+  OUT VOID        *Buffer
+  )
+{
+  UINTN   Index;
+  UINT32  Head;
+  UINT32  Tail;
+
+  Head = UsbSerialDevice->DataBufferHead;
+  Tail = UsbSerialDevice->DataBufferTail;
+
+  for (Index = 0; (Index < *BufferSize) && (Head != Tail); Index++) {
+    ((UINT8 *)Buffer)[Index] = UsbSerialDevice->DataBuffer[Head];
+    Head = (Head + 1) & SW_FIFO_MASK;
+  }
+
+  //
+  // Only hand the space back to ReadDataFromUsb() once the data has been copied
+  //
+  MemoryFence ();
+  UsbSerialDevice->DataBufferHead = Head;
+
+  *BufferSize = Index;
+}
+
+/**
+  Refills the receive FIFO of the Usb Serial Device from the device.
+
+  The device is read again as long as it fills the whole read buffer and the
+  FIFO has room for another one. Nothing is read while the FIFO is too full,
+  the data is then held back by the device instead of being dropped here.
+
+  @param  UsbSerialDevice[in]        Handle to the USB device to read
+
   @retval EFI_SUCCESS                The data was read.
   @retval EFI_DEVICE_ERROR           The device reported an error.
-  @retval EFI_TIMEOUT                The data write was stopped due to a timeout.
+  @retval EFI_TIMEOUT                The data read was stopped due to a timeout.
 
 **/
 EFI_STATUS
 EFIAPI
 ReadDataFromUsb (
-  IN USB_SER_DEV  *UsbSerialDevice,
-  IN OUT UINTN    *BufferSize,
-  OUT VOID        *Buffer
+  IN USB_SER_DEV  *UsbSerialDevice
   )
 {
   EFI_STATUS  Status;
   UINTN       ReadBufferSize;
   UINT8       *ReadBuffer;
+  UINTN       PacketSize;
+  UINTN       PacketEnd;
+  UINTN       Offset;
   UINTN       Index;
+  UINT32      Tail;
   EFI_TPL     Tpl;
-  UINT8       StatusBuffer[2]; // buffer to store the status bytes
 
-  ReadBufferSize = 512;
-  ReadBuffer     = &(UsbSerialDevice->ReadBuffer[0]);
+  ReadBuffer = &(UsbSerialDevice->ReadBuffer[0]);
+  PacketSize = UsbSerialDevice->InEndpointDescriptor.MaxPacketSize;
+  if (PacketSize <= FTDI_STATUS_BYTES) {
+    PacketSize = sizeof (UsbSerialDevice->ReadBuffer);
+  }
 
   if (UsbSerialDevice->Shutdown) {
     return EFI_DEVICE_ERROR;
@@ -243,69 +287,57 @@ ReadDataFromUsb (
 
   Tpl = gBS->RaiseTPL (TPL_NOTIFY);
 
-  Status = UsbSerialDataTransfer (
-             UsbSerialDevice,
-             EfiUsbDataIn,
-             ReadBuffer,
-             &ReadBufferSize,
-             FTDI_TIMEOUT*2  //Padded because timers won't be exactly aligned
-             );
-  if (EFI_ERROR (Status)) {
-    gBS->RestoreTPL (Tpl);
-    if (Status == EFI_TIMEOUT) {
-      return EFI_TIMEOUT;
-    } else {
-      return EFI_DEVICE_ERROR;
-    }
-  }
-
-  //
-  // Store the status bytes in the status buffer
-  //
-  for (Index = 0; Index < 2; Index++) {//only the first 2 bytes are status bytes
-    StatusBuffer[Index] = ReadBuffer[Index];
-  }
-  //
-  // update the statusvalue field of the usbserialdevice
-  //
-  Status = SetStatusInternal (UsbSerialDevice, StatusBuffer);
-  if (Status != EFI_SUCCESS) {
-  }
-
-  //
-  // Store the read data in the read buffer, start at 2 to ignore status bytes
-  //
-  for (Index = 2; Index < ReadBufferSize; Index++) {
-    if (((UsbSerialDevice->DataBufferTail + 1) % SW_FIFO_DEPTH) == UsbSerialDevice->DataBufferHead) {
+  do {
+    ReadBufferSize = sizeof (UsbSerialDevice->ReadBuffer);
+    Tail           = UsbSerialDevice->DataBufferTail;
+    if (((UsbSerialDevice->DataBufferHead - Tail - 1) & SW_FIFO_MASK) < ReadBufferSize) {
       break;
     }
-    if (ReadBuffer[Index] == 0x00) {
-      //
-      // This is null, do not add
-      //
-    } else {
-      UsbSerialDevice->DataBuffer[UsbSerialDevice->DataBufferTail] = ReadBuffer[Index];
-      UsbSerialDevice->DataBufferTail = (UsbSerialDevice->DataBufferTail + 1) % SW_FIFO_DEPTH;
+
+    Status = UsbSerialDataTransfer (
+               UsbSerialDevice,
+               EfiUsbDataIn,
+               ReadBuffer,
+               &ReadBufferSize,
+               FTDI_TIMEOUT*2  //Padded because timers won't be exactly aligned
+               );
+    if (EFI_ERROR (Status)) {
+      gBS->RestoreTPL (Tpl);
+      if (Status == EFI_TIMEOUT) {
+        return EFI_TIMEOUT;
+      } else {
+        return EFI_DEVICE_ERROR;
+      }
     }
-  }
 
-  //
-  // Read characters out of the buffer to satisfy caller's request.
-  //
-  for (Index = 0; Index < *BufferSize; Index++) {
-    if (UsbSerialDevice->DataBufferHead == UsbSerialDevice->DataBufferTail) {
-      break;
+    //
+    // Every packet starts with the status bytes, use them to update the
+    // statusvalue field of the usbserialdevice and store the data bytes that
+    // follow them in the receive FIFO
+    //
+    for (Offset = 0; Offset + FTDI_STATUS_BYTES <= ReadBufferSize; Offset += PacketSize) {
+      SetStatusInternal (UsbSerialDevice, &ReadBuffer[Offset]);
+
+      PacketEnd = MIN (Offset + PacketSize, ReadBufferSize);
+      for (Index = Offset + FTDI_STATUS_BYTES; Index < PacketEnd; Index++) {
+        if (ReadBuffer[Index] == 0x00) {
+          //
+          // This is null, do not add
+          //
+        } else {
+          UsbSerialDevice->DataBuffer[Tail] = ReadBuffer[Index];
+          Tail = (Tail + 1) & SW_FIFO_MASK;
+        }
+      }
     }
+
     //
-    // Still have characters in the buffer to return
+    // Only hand the data to ReadDataFromFifo() once it is in the FIFO
     //
-    ((UINT8 *)Buffer)[Index]        = UsbSerialDevice->DataBuffer[UsbSerialDevice->DataBufferHead];
-    UsbSerialDevice->DataBufferHead = (UsbSerialDevice->DataBufferHead + 1) % SW_FIFO_DEPTH;
-  }
-  //
-  // Return actual number of bytes returned.
-  //
-  *BufferSize = Index;
+    MemoryFence ();
+    UsbSerialDevice->DataBufferTail = Tail;
+  } while (ReadBufferSize == sizeof (UsbSerialDevice->ReadBuffer));
+
   gBS->RestoreTPL (Tpl);
   return EFI_SUCCESS;
 }
@@ -363,7 +395,7 @@ SetInitialStatus (
 /**
   UsbSerialDriverCheckInput.
   attempts to read data in from the device periodically, stores any read data
-  and updates the control attributes.
+  in the receive FIFO and updates the control attributes.
 
   @param  Event[in]
   @param  Context[in]....The current instance of the USB serial device
@@ -376,33 +408,24 @@ UsbSerialDriverCheckInput (
   IN  VOID       *Context
   )
 {
-  UINTN        BufferSize;
   USB_SER_DEV  *UsbSerialDevice;
 
   UsbSerialDevice = (USB_SER_DEV*)Context;
 
+  //
+  // Keep draining the device into the data buffer whether or not the caller
+  // has read what is already there, so that bytes arriving between reads are
+  // not lost when the device FIFO overflows
+  //
+  ReadDataFromUsb (UsbSerialDevice);
   if (UsbSerialDevice->DataBufferHead == UsbSerialDevice->DataBufferTail) {
     //
-    // Data buffer is empty, try to read from device
+    // Data buffer has no data, set the EFI_SERIAL_INPUT_BUFFER_EMPTY flag
     //
-    BufferSize = 0;
-    ReadDataFromUsb (UsbSerialDevice, &BufferSize, NULL);
-    if (UsbSerialDevice->DataBufferHead == UsbSerialDevice->DataBufferTail) {
-      //
-      // Data buffer still has no data, set the EFI_SERIAL_INPUT_BUFFER_EMPTY
-      // flag
-      //
-      UsbSerialDevice->ControlBits |= EFI_SERIAL_INPUT_BUFFER_EMPTY;
-    } else {
-      //
-      // Read has returned some data, clear the EFI_SERIAL_INPUT_BUFFER_EMPTY
-      // flag
-      //
-      UsbSerialDevice->ControlBits &= ~(EFI_SERIAL_INPUT_BUFFER_EMPTY);
-    }
+    UsbSerialDevice->ControlBits |= EFI_SERIAL_INPUT_BUFFER_EMPTY;
   } else {
     //
-    // Data buffer has data, no read attempt required
+    // Data buffer has data, clear the EFI_SERIAL_INPUT_BUFFER_EMPTY flag
     //
     UsbSerialDevice->ControlBits &= ~(EFI_SERIAL_INPUT_BUFFER_EMPTY);
   }
@@ -1039,6 +1062,51 @@ StatusError:
   }
 }
 
+/**
+  Internal function that performs a Usb Control Transfer to set the latency
+  timer of the Usb Serial Device. The device sends the data it has received, or
+  only its status bytes, whenever the latency timer expires.
+
+  @param  UsbIo[in]                  Usb Io Protocol instance pointer
+  @param  Latency[in]                The latency timer value in ms
+
+  @retval EFI_SUCCESS                The latency timer was set on the Usb Serial
+                                     Device
+  @retval EFI_DEVICE_ERROR           The device is not functioning correctly
+
+**/
+EFI_STATUS
+EFIAPI
+SetLatencyTimerInternal (
+  IN EFI_USB_IO_PROTOCOL  *UsbIo,
+  IN UINT8                Latency
+  )
+{
+  EFI_STATUS              Status;
+  EFI_USB_DEVICE_REQUEST  DevReq;
+  UINT32                  ReturnValue;
+  UINT8                   ConfigurationValue;
+
+  DevReq.Request      = FTDI_COMMAND_SET_LATENCY_TIMER;
+  DevReq.RequestType  = USB_REQ_TYPE_VENDOR;
+  DevReq.Value        = Latency;
+  DevReq.Index        = FTDI_PORT_IDENTIFIER;
+  DevReq.Length       = 0; // indicates that this transfer has no data phase
+  Status              = UsbIo->UsbControlTransfer (
+                                 UsbIo,
+                                 &DevReq,
+                                 EfiUsbDataOut,
+                                 WDR_SHORT_TIMEOUT,
+                                 &ConfigurationValue,
+                                 1,
+                                 &ReturnValue
+                                 );
+  if (EFI_ERROR (Status)) {
+    return EFI_DEVICE_ERROR;
+  }
+  return Status;
+}
+
 /**
   Internal function that performs a Usb Control Transfer to set the Dtr value on
   the Usb Serial Device.
@@ -1991,6 +2059,13 @@ UsbSerialDriverBindingStart (
     FALSE
     );
 
+  //
+  // Shorten the latency timer so that the polling loop does not have to wait
+  // for the device when there is no data to read. The polling loop still works
+  // with the default latency timer if this fails, it only waits longer.
+  //
+  SetLatencyTimerInternal (UsbIo, FTDI_LATENCY_TIMER);
+
   Status = SetInitialStatus (UsbSerialDevice);
   ASSERT_EFI_ERROR (Status);
 
@@ -2006,13 +2081,12 @@ UsbSerialDriverBindingStart (
          &(UsbSerialDevice->PollingLoop)
          );
   //
-  // add code to set trigger time based on baud rate
-  // setting to 0.5s for now
+  // Poll often enough that the device FIFO does not overflow at 115200 baud
   //
   gBS->SetTimer (
          UsbSerialDevice->PollingLoop,
          TimerPeriodic,
-         EFI_TIMER_PERIOD_MILLISECONDS (500)
+         EFI_TIMER_PERIOD_MILLISECONDS (FTDI_POLLING_INTERVAL)
          );
 
   //
@@ -2479,19 +2553,11 @@ ReadSerialIo (
   UsbSerialDevice = USB_SER_DEV_FROM_THIS (This);
 
   //
-  // Clear out any data that we already have in our internal buffer
+  // Serve the request from the data that the polling loop already stored in
+  // our internal buffer
   //
-  for (Index = 0; Index < *BufferSize; Index++) {
-    if (UsbSerialDevice->DataBufferHead == UsbSerialDevice->DataBufferTail) {
-      break;
-    }
-
-    //
-    // Still have characters in the buffer to return
-    //
-    ((UINT8 *)Buffer)[Index] = UsbSerialDevice->DataBuffer[UsbSerialDevice->DataBufferHead];
-    UsbSerialDevice->DataBufferHead = (UsbSerialDevice->DataBufferHead + 1) % SW_FIFO_DEPTH;
-  }
+  Index = *BufferSize;
+  ReadDataFromFifo (UsbSerialDevice, &Index, Buffer);
 
   //
   // If we haven't filled the caller's buffer using data that we already had on
@@ -2499,17 +2565,14 @@ ReadSerialIo (
   // caller's buffer
   //
   if (Index != *BufferSize) {
+    Status = ReadDataFromUsb (UsbSerialDevice);
     RemainingCallerBufferSize = *BufferSize - Index;
-    Status = ReadDataFromUsb (
-               UsbSerialDevice,
-               &RemainingCallerBufferSize,
-               (VOID *)(((CHAR8 *)Buffer) + Index)
-               );
-    if (!EFI_ERROR (Status)) {
-      *BufferSize = RemainingCallerBufferSize + Index;
-    } else {
-      *BufferSize = Index;
-    }
+    ReadDataFromFifo (
+      UsbSerialDevice,
+      &RemainingCallerBufferSize,
+      (VOID *)(((CHAR8 *)Buffer) + Index)
+      );
+    *BufferSize = RemainingCallerBufferSize + Index;
   }
 
   if (UsbSerialDevice->DataBufferHead == UsbSerialDevice->DataBufferTail) {
@@ -2550,6 +2613,7 @@ WriteSerialIo (
   EFI_STATUS   Status;
   USB_SER_DEV  *UsbSerialDevice;
   EFI_TPL      Tpl;
+  UINT32       Timeout;
 
   UsbSerialDevice = USB_SER_DEV_FROM_THIS (This);
 
@@ -2557,6 +2621,22 @@ WriteSerialIo (
     return EFI_DEVICE_ERROR;
   }
 
+  //
+  // The whole buffer is sent in a single bulk transfer, which the host
+  // controller splits into max packet size transactions. The device NAKs them
+  // while its transmit FIFO is full, so allow for the time it takes to shift
+  // the data out at the current baud rate (10 bits per character) rather than
+  // timing out, and shutting the device down, on long writes.
+  //
+  Timeout = FTDI_TIMEOUT;
+  if (UsbSerialDevice->SerialIo.Mode->BaudRate != 0) {
+    Timeout += (UINT32) DivU64x64Remainder (
+                          MultU64x32 (*BufferSize, 10 * 1000),
+                          UsbSerialDevice->SerialIo.Mode->BaudRate,
+                          NULL
+                          );
+  }
+
   Tpl = gBS->RaiseTPL (TPL_NOTIFY);
 
   Status = UsbSerialDataTransfer (
@@ -2564,7 +2644,7 @@ WriteSerialIo (
              EfiUsbDataOut,
              Buffer,
              BufferSize,
-             FTDI_TIMEOUT
+             Timeout
              );
 
   gBS->RestoreTPL (Tpl);
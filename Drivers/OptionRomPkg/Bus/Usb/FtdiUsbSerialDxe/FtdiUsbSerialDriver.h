@@ -10,6 +10,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #ifndef _FTDI_USB_SERIAL_DRIVER_H_
 #define _FTDI_USB_SERIAL_DRIVER_H_
 
+#include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
 #include <Library/MemoryAllocationLib.h>
@@ -156,6 +157,22 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 //
 #define FTDI_TIMEOUT       16
 
+//
+// FTDI latency timer in ms. The device sends the data it has received, or only
+// its status bytes, at least this often.
+//
+#define FTDI_LATENCY_TIMER  2
+
+//
+// Period in ms at which the receive FIFO is refilled from the device
+//
+#define FTDI_POLLING_INTERVAL  8
+
+//
+// Number of modem status bytes at the start of every packet sent by the device
+//
+#define FTDI_STATUS_BYTES  2
+
 //
 // FTDI FIFO depth
 //
@@ -168,9 +185,10 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define FTDI_ENDPOINT_ADDRESS_OUT  0x02 //the endpoint address for the out endpoint generated by the device
 
 //
-// Max buffer size for USB transfers
+// Size of the receive FIFO, must be a power of 2
 //
-#define SW_FIFO_DEPTH 1024
+#define SW_FIFO_DEPTH 8192
+#define SW_FIFO_MASK  (SW_FIFO_DEPTH - 1)
 
 //
 // struct to define a usb device as a vendor and product id pair
@@ -234,8 +252,8 @@ typedef struct {
   EFI_USB_ENDPOINT_DESCRIPTOR   InEndpointDescriptor;
   EFI_USB_ENDPOINT_DESCRIPTOR   OutEndpointDescriptor;
   EFI_UNICODE_STRING_TABLE      *ControllerNameTable;
-  UINT32                        DataBufferHead;
-  UINT32                        DataBufferTail;
+  volatile UINT32               DataBufferHead; // only moved by ReadDataFromFifo
+  volatile UINT32               DataBufferTail; // only moved by ReadDataFromUsb
   UINT8                         *DataBuffer;
   EFI_SERIAL_IO_PROTOCOL        SerialIo;
   BOOLEAN                       Shutdown;
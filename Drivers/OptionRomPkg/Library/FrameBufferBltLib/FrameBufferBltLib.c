@@ -20,6 +20,23 @@
 
 #define MAX_LINE_BUFFER_SIZE (SIZE_4KB * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL))
 
+/**
+  Converts one line of pixels between the EFI_GRAPHICS_OUTPUT_BLT_PIXEL
+  format and the frame buffer format.
+
+  @param[out] Destination   Converted pixels
+  @param[in]  Source        Pixels to convert
+  @param[in]  Width         Number of pixels
+
+**/
+typedef
+VOID
+(*BLT_LIB_CONVERT_LINE) (
+  OUT VOID                                  *Destination,
+  IN  CONST VOID                            *Source,
+  IN  UINTN                                 Width
+  );
+
 UINTN                           mBltLibColorDepth;
 UINTN                           mBltLibWidthInBytes;
 UINTN                           mBltLibBytesPerPixel;
@@ -31,6 +48,314 @@ EFI_GRAPHICS_PIXEL_FORMAT       mPixelFormat;
 EFI_PIXEL_BITMASK               mPixelBitMasks;
 INTN                            mPixelShl[4]; // R-G-B-Rsvd
 INTN                            mPixelShr[4]; // R-G-B-Rsvd
+BLT_LIB_CONVERT_LINE            mBltLibBltToVideoLine; // NULL if no conversion is needed
+BLT_LIB_CONVERT_LINE            mBltLibVideoToBltLine; // NULL if no conversion is needed
+
+
+/**
+  Swaps the red and blue channels of a 32-bit pixel and clears the
+  reserved byte.
+
+  @param[in]  Pixel         Pixel to convert
+
+  @return The converted pixel
+
+**/
+STATIC
+UINT32
+SwapRedBlue (
+  IN  UINT32                                Pixel
+  )
+{
+  return ((Pixel & 0x000000ff) << 16) | (Pixel & 0x0000ff00) | ((Pixel >> 16) & 0x000000ff);
+}
+
+
+/**
+  Converts a line of pixels from the EFI_GRAPHICS_OUTPUT_BLT_PIXEL format to
+  any frame buffer format, using the shifts and masks of the pixel bit masks.
+
+  @param[out] Destination   Converted pixels
+  @param[in]  Source        Pixels to convert
+  @param[in]  Width         Number of pixels
+
+**/
+STATIC
+VOID
+BltToVideoLineBitMask (
+  OUT VOID                                  *Destination,
+  IN  CONST VOID                            *Source,
+  IN  UINTN                                 Width
+  )
+{
+  UINTN                           X;
+  UINT32                          Uint32;
+
+  for (X = 0; X < Width; X++) {
+    Uint32 = ((CONST UINT32 *) Source)[X];
+    *(UINT32*) ((UINT8 *) Destination + (X * mBltLibBytesPerPixel)) =
+      (UINT32) (
+          (((Uint32 << mPixelShl[0]) >> mPixelShr[0]) & mPixelBitMasks.RedMask) |
+          (((Uint32 << mPixelShl[1]) >> mPixelShr[1]) & mPixelBitMasks.GreenMask) |
+          (((Uint32 << mPixelShl[2]) >> mPixelShr[2]) & mPixelBitMasks.BlueMask)
+        );
+  }
+}
+
+
+/**
+  Converts a line of pixels from any frame buffer format to the
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL format, using the shifts and masks of
+  the pixel bit masks.
+
+  @param[out] Destination   Converted pixels
+  @param[in]  Source        Pixels to convert
+  @param[in]  Width         Number of pixels
+
+**/
+STATIC
+VOID
+VideoToBltLineBitMask (
+  OUT VOID                                  *Destination,
+  IN  CONST VOID                            *Source,
+  IN  UINTN                                 Width
+  )
+{
+  UINTN                           X;
+  UINT32                          Uint32;
+
+  for (X = 0; X < Width; X++) {
+    Uint32 = *(CONST UINT32*) ((CONST UINT8 *) Source + (X * mBltLibBytesPerPixel));
+    ((UINT32 *) Destination)[X] =
+      (UINT32) (
+          (((Uint32 & mPixelBitMasks.RedMask)   >> mPixelShl[0]) << mPixelShr[0]) |
+          (((Uint32 & mPixelBitMasks.GreenMask) >> mPixelShl[1]) << mPixelShr[1]) |
+          (((Uint32 & mPixelBitMasks.BlueMask)  >> mPixelShl[2]) << mPixelShr[2])
+        );
+  }
+}
+
+
+/**
+  Converts a line of pixels between the EFI_GRAPHICS_OUTPUT_BLT_PIXEL format
+  and the 32-bit RGB format. The conversion is the same in both directions.
+  The masks are constant, unlike the generic path that shifts by the
+  masks configured at run time.
+
+  @param[out] Destination   Converted pixels
+  @param[in]  Source        Pixels to convert
+  @param[in]  Width         Number of pixels
+
+**/
+STATIC
+VOID
+ConvertLineRgb32 (
+  OUT VOID                                  *Destination,
+  IN  CONST VOID                            *Source,
+  IN  UINTN                                 Width
+  )
+{
+  UINTN                           X;
+
+  for (X = 0; X < Width; X++) {
+    ((UINT32 *) Destination)[X] = SwapRedBlue (((CONST UINT32 *) Source)[X]);
+  }
+}
+
+
+/**
+  Converts a line of pixels from the EFI_GRAPHICS_OUTPUT_BLT_PIXEL format to
+  a 24-bit RGB or BGR format. Four pixels are packed into three 32-bit words
+  at a time.
+
+  @param[out] Destination   Converted pixels
+  @param[in]  Source        Pixels to convert
+  @param[in]  Width         Number of pixels
+  @param[in]  Swap          TRUE to swap the red and blue channels
+
+**/
+STATIC
+VOID
+BltToVideoLine24 (
+  OUT VOID                                  *Destination,
+  IN  CONST VOID                            *Source,
+  IN  UINTN                                 Width,
+  IN  BOOLEAN                               Swap
+  )
+{
+  CONST UINT32                    *Src;
+  UINT32                          *Dst;
+  UINT8                           *Dst8;
+  UINT32                          P0;
+  UINT32                          P1;
+  UINT32                          P2;
+  UINT32                          P3;
+
+  Src = (CONST UINT32 *) Source;
+  Dst = (UINT32 *) Destination;
+  for (; Width >= 4; Width -= 4, Src += 4, Dst += 3) {
+    P0 = Src[0];
+    P1 = Src[1];
+    P2 = Src[2];
+    P3 = Src[3];
+    if (Swap) {
+      P0 = SwapRedBlue (P0);
+      P1 = SwapRedBlue (P1);
+      P2 = SwapRedBlue (P2);
+      P3 = SwapRedBlue (P3);
+    }
+    Dst[0] = (P0 & 0x00ffffff)         | (P1 << 24);
+    Dst[1] = ((P1 >> 8) & 0x0000ffff)  | (P2 << 16);
+    Dst[2] = ((P2 >> 16) & 0x000000ff) | (P3 << 8);
+  }
+
+  Dst8 = (UINT8 *) Dst;
+  for (; Width > 0; Width--, Src++, Dst8 += 3) {
+    P0 = Swap ? SwapRedBlue (*Src) : *Src;
+    Dst8[0] = (UINT8) P0;
+    Dst8[1] = (UINT8) (P0 >> 8);
+    Dst8[2] = (UINT8) (P0 >> 16);
+  }
+}
+
+
+/**
+  Converts a line of pixels from a 24-bit RGB or BGR format to the
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL format. Four pixels are unpacked from three
+  32-bit words at a time.
+
+  @param[out] Destination   Converted pixels
+  @param[in]  Source        Pixels to convert
+  @param[in]  Width         Number of pixels
+  @param[in]  Swap          TRUE to swap the red and blue channels
+
+**/
+STATIC
+VOID
+VideoToBltLine24 (
+  OUT VOID                                  *Destination,
+  IN  CONST VOID                            *Source,
+  IN  UINTN                                 Width,
+  IN  BOOLEAN                               Swap
+  )
+{
+  CONST UINT32                    *Src;
+  CONST UINT8                     *Src8;
+  UINT32                          *Dst;
+  UINT32                          P0;
+  UINT32                          P1;
+  UINT32                          P2;
+  UINT32                          P3;
+
+  Src = (CONST UINT32 *) Source;
+  Dst = (UINT32 *) Destination;
+  for (; Width >= 4; Width -= 4, Src += 3, Dst += 4) {
+    P0 = Src[0] & 0x00ffffff;
+    P1 = (Src[0] >> 24) | ((Src[1] & 0x0000ffff) << 8);
+    P2 = (Src[1] >> 16) | ((Src[2] & 0x000000ff) << 16);
+    P3 = Src[2] >> 8;
+    if (Swap) {
+      P0 = SwapRedBlue (P0);
+      P1 = SwapRedBlue (P1);
+      P2 = SwapRedBlue (P2);
+      P3 = SwapRedBlue (P3);
+    }
+    Dst[0] = P0;
+    Dst[1] = P1;
+    Dst[2] = P2;
+    Dst[3] = P3;
+  }
+
+  Src8 = (CONST UINT8 *) Src;
+  for (; Width > 0; Width--, Src8 += 3, Dst++) {
+    P0 = Src8[0] | ((UINT32) Src8[1] << 8) | ((UINT32) Src8[2] << 16);
+    *Dst = Swap ? SwapRedBlue (P0) : P0;
+  }
+}
+
+
+/**
+  Converts a line of pixels from the EFI_GRAPHICS_OUTPUT_BLT_PIXEL format to
+  the 24-bit BGR format.
+
+  @param[out] Destination   Converted pixels
+  @param[in]  Source        Pixels to convert
+  @param[in]  Width         Number of pixels
+
+**/
+STATIC
+VOID
+BltToVideoLineBgr24 (
+  OUT VOID                                  *Destination,
+  IN  CONST VOID                            *Source,
+  IN  UINTN                                 Width
+  )
+{
+  BltToVideoLine24 (Destination, Source, Width, FALSE);
+}
+
+
+/**
+  Converts a line of pixels from the 24-bit BGR format to the
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL format.
+
+  @param[out] Destination   Converted pixels
+  @param[in]  Source        Pixels to convert
+  @param[in]  Width         Number of pixels
+
+**/
+STATIC
+VOID
+VideoToBltLineBgr24 (
+  OUT VOID                                  *Destination,
+  IN  CONST VOID                            *Source,
+  IN  UINTN                                 Width
+  )
+{
+  VideoToBltLine24 (Destination, Source, Width, FALSE);
+}
+
+
+/**
+  Converts a line of pixels from the EFI_GRAPHICS_OUTPUT_BLT_PIXEL format to
+  the 24-bit RGB format.
+
+  @param[out] Destination   Converted pixels
+  @param[in]  Source        Pixels to convert
+  @param[in]  Width         Number of pixels
+
+**/
+STATIC
+VOID
+BltToVideoLineRgb24 (
+  OUT VOID                                  *Destination,
+  IN  CONST VOID                            *Source,
+  IN  UINTN                                 Width
+  )
+{
+  BltToVideoLine24 (Destination, Source, Width, TRUE);
+}
+
+
+/**
+  Converts a line of pixels from the 24-bit RGB format to the
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL format.
+
+  @param[out] Destination   Converted pixels
+  @param[in]  Source        Pixels to convert
+  @param[in]  Width         Number of pixels
+
+**/
+STATIC
+VOID
+VideoToBltLineRgb24 (
+  OUT VOID                                  *Destination,
+  IN  CONST VOID                            *Source,
+  IN  UINTN                                 Width
+  )
+{
+  VideoToBltLine24 (Destination, Source, Width, TRUE);
+}
 
 
 VOID
@@ -65,6 +390,32 @@ ConfigurePixelBitMaskFormat (
   DEBUG ((EFI_D_INFO, "Bytes per pixel: %d\n", mBltLibBytesPerPixel));
 
   CopyMem (&mPixelBitMasks, BitMask, sizeof (*BitMask));
+
+  //
+  // Use the line conversion specific to the common 8 bits per color formats,
+  // the shifts and masks are only needed for the other formats.
+  //
+  mBltLibBltToVideoLine = BltToVideoLineBitMask;
+  mBltLibVideoToBltLine = VideoToBltLineBitMask;
+  if ((BitMask->GreenMask == 0x0000ff00) && (mBltLibBytesPerPixel >= 3)) {
+    if ((BitMask->RedMask == 0x00ff0000) && (BitMask->BlueMask == 0x000000ff)) {
+      if (mBltLibBytesPerPixel == 4) {
+        mBltLibBltToVideoLine = NULL;
+        mBltLibVideoToBltLine = NULL;
+      } else {
+        mBltLibBltToVideoLine = BltToVideoLineBgr24;
+        mBltLibVideoToBltLine = VideoToBltLineBgr24;
+      }
+    } else if ((BitMask->RedMask == 0x000000ff) && (BitMask->BlueMask == 0x00ff0000)) {
+      if (mBltLibBytesPerPixel == 4) {
+        mBltLibBltToVideoLine = ConvertLineRgb32;
+        mBltLibVideoToBltLine = ConvertLineRgb32;
+      } else {
+        mBltLibBltToVideoLine = BltToVideoLineRgb24;
+        mBltLibVideoToBltLine = VideoToBltLineRgb24;
+      }
+    }
+  }
 }
 
 
@@ -306,6 +657,7 @@ BltLibVideoFill (
     SizeInBytes = WidthInBytes * Height;
     if (SizeInBytes >= 8) {
       SetMem32 (BltMemDst, SizeInBytes & ~3, (UINT32) WideFill);
+      BltMemDst = (VOID*) ((UINT8*) BltMemDst + (SizeInBytes & ~3));
       SizeInBytes = SizeInBytes & 3;
     }
     if (SizeInBytes > 0) {
@@ -326,8 +678,14 @@ BltLibVideoFill (
           SizeInBytes = SizeInBytes & 7;
         }
         if (SizeInBytes > 0) {
-          CopyMem (BltMemDst, (VOID*) &WideFill, SizeInBytes);
+          CopyMem ((UINT8*) BltMemDst + (WidthInBytes & ~7), (VOID*) &WideFill, SizeInBytes);
         }
+      } else if (UseWideFill && (mBltLibBytesPerPixel == 4) && (((UINTN) BltMemDst & 3) == 0)) {
+        //
+        // Lines of 32-bit pixels starting at an odd pixel are 4-byte aligned only
+        //
+        VDEBUG ((EFI_D_INFO, "VideoFill (wide, 32-bit)\n"));
+        SetMem32 (BltMemDst, WidthInBytes, (UINT32) WideFill);
       } else {
         VDEBUG ((EFI_D_INFO, "VideoFill (not wide)\n"));
         if (!LineBufferReady) {
@@ -421,11 +779,8 @@ BltLibVideoToBltBufferEx (
 {
   UINTN                           DstY;
   UINTN                           SrcY;
-  EFI_GRAPHICS_OUTPUT_BLT_PIXEL   *Blt;
   VOID                            *BltMemSrc;
   VOID                            *BltMemDst;
-  UINTN                           X;
-  UINT32                          Uint32;
   UINTN                           Offset;
   UINTN                           WidthInBytes;
 
@@ -464,30 +819,21 @@ BltLibVideoToBltBufferEx (
     Offset = mBltLibBytesPerPixel * Offset;
     BltMemSrc = (VOID *) (mBltLibFrameBuffer + Offset);
 
-    if (mPixelFormat == PixelBlueGreenRedReserved8BitPerColor) {
-      BltMemDst =
-        (VOID *) (
-            (UINT8 *) BltBuffer +
-            (DstY * Delta) +
-            (DestinationX * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL))
-          );
-    } else {
-      BltMemDst = (VOID *) mBltLibLineBuffer;
-    }
-
-    CopyMem (BltMemDst, BltMemSrc, WidthInBytes);
+    BltMemDst =
+      (VOID *) (
+          (UINT8 *) BltBuffer +
+          (DstY * Delta) +
+          (DestinationX * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL))
+        );
 
-    if (mPixelFormat != PixelBlueGreenRedReserved8BitPerColor) {
-      for (X = 0; X < Width; X++) {
-        Blt         = (EFI_GRAPHICS_OUTPUT_BLT_PIXEL *) ((UINT8 *) BltBuffer + (DstY * Delta) + (DestinationX + X) * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
-        Uint32 = *(UINT32*) (mBltLibLineBuffer + (X * mBltLibBytesPerPixel));
-        *(UINT32*) Blt =
-          (UINT32) (
-              (((Uint32 & mPixelBitMasks.RedMask)   >> mPixelShl[0]) << mPixelShr[0]) |
-              (((Uint32 & mPixelBitMasks.GreenMask) >> mPixelShl[1]) << mPixelShr[1]) |
-              (((Uint32 & mPixelBitMasks.BlueMask)  >> mPixelShl[2]) << mPixelShr[2])
-            );
-      }
+    //
+    // The frame buffer is read a whole line at a time, then converted
+    //
+    if (mBltLibVideoToBltLine == NULL) {
+      CopyMem (BltMemDst, BltMemSrc, WidthInBytes);
+    } else {
+      CopyMem (mBltLibLineBuffer, BltMemSrc, WidthInBytes);
+      mBltLibVideoToBltLine (BltMemDst, mBltLibLineBuffer, Width);
     }
   }
 
@@ -565,11 +911,8 @@ BltLibBufferToVideoEx (
 {
   UINTN                           DstY;
   UINTN                           SrcY;
-  EFI_GRAPHICS_OUTPUT_BLT_PIXEL   *Blt;
   VOID                            *BltMemSrc;
   VOID                            *BltMemDst;
-  UINTN                           X;
-  UINT32                          Uint32;
   UINTN                           Offset;
   UINTN                           WidthInBytes;
 
@@ -605,24 +948,19 @@ BltLibBufferToVideoEx (
     Offset = mBltLibBytesPerPixel * Offset;
     BltMemDst = (VOID*) (mBltLibFrameBuffer + Offset);
 
-    if (mPixelFormat == PixelBlueGreenRedReserved8BitPerColor) {
-      BltMemSrc = (VOID *) ((UINT8 *) BltBuffer + (SrcY * Delta));
-    } else {
-      for (X = 0; X < Width; X++) {
-        Blt =
-          (EFI_GRAPHICS_OUTPUT_BLT_PIXEL *) (
-              (UINT8 *) BltBuffer +
-              (SrcY * Delta) +
-              ((SourceX + X) * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL))
-            );
-        Uint32 = *(UINT32*) Blt;
-        *(UINT32*) (mBltLibLineBuffer + (X * mBltLibBytesPerPixel)) =
-          (UINT32) (
-              (((Uint32 << mPixelShl[0]) >> mPixelShr[0]) & mPixelBitMasks.RedMask) |
-              (((Uint32 << mPixelShl[1]) >> mPixelShr[1]) & mPixelBitMasks.GreenMask) |
-              (((Uint32 << mPixelShl[2]) >> mPixelShr[2]) & mPixelBitMasks.BlueMask)
-            );
-      }
+    BltMemSrc =
+      (VOID *) (
+          (UINT8 *) BltBuffer +
+          (SrcY * Delta) +
+          (SourceX * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL))
+        );
+
+    //
+    // The line is converted first so that the frame buffer is written
+    // a whole line at a time
+    //
+    if (mBltLibBltToVideoLine != NULL) {
+      mBltLibBltToVideoLine (mBltLibLineBuffer, BltMemSrc, Width);
       BltMemSrc = (VOID *) mBltLibLineBuffer;
     }
 
@@ -1066,7 +1066,9 @@ UNDI_Status (
     //
     // acknoledge the interrupts
     //
-    OutWord (AdapterInfo, (UINT16) (Status & 0xfc00), (UINT32) (AdapterInfo->ioaddr + SCBStatus));
+    if ((Status & SCB_STATUS_MASK) != 0) {
+      OutWord (AdapterInfo, (UINT16) (Status & SCB_STATUS_MASK), (UINT32) (AdapterInfo->ioaddr + SCBStatus));
+    }
 
     //
     // report all the outstanding interrupts
@@ -445,8 +445,21 @@ IssueCB (
   )
 {
   UINT16  status;
+  UINT32  scb_value;
+  INT16   wait_count;
 
-  wait_for_cmd_done (AdapterInfo->ioaddr + SCBCmd);
+  //
+  // wait for the command unit to accept the previous command and read the
+  // CU status with the same access: the SCB status word is followed by the
+  // command byte, which reads back as 0 once the command is accepted.
+  // Every port access is a VM exit when the NIC is emulated.
+  //
+  wait_count = 2000;
+  scb_value  = InLong (AdapterInfo, AdapterInfo->ioaddr + SCBStatus);
+  while (((scb_value & 0x00ff0000) != 0) && --wait_count >= 0) {
+    DelayIt (AdapterInfo, 10);
+    scb_value = InLong (AdapterInfo, AdapterInfo->ioaddr + SCBStatus);
+  }
 
   //
   // read the CU status, if it is idle, write the address of cb_ptr
@@ -456,7 +469,7 @@ IssueCB (
   //
   // Ensure that the CU Active Status bit is not on from previous CBs.
   //
-  status = InWord (AdapterInfo, AdapterInfo->ioaddr + SCBStatus);
+  status = (UINT16) scb_value;
 
   //
   // Skip acknowledging the interrupt if it is not already set
@@ -1203,17 +1216,11 @@ E100bReceive (
   EtherHeader     *hdr_ptr;
   ret_code  = PXE_STATCODE_NO_DATA;
   pkt_type  = PXE_FRAME_TYPE_NONE;
-  status    = InWord (AdapterInfo, AdapterInfo->ioaddr + SCBStatus);
-  AdapterInfo->Int_Status = (UINT16) (AdapterInfo->Int_Status | status);
-  //
-  // acknoledge the interrupts
-  //
-  OutWord (AdapterInfo, (UINT16) (status & 0xfc00), (UINT32) (AdapterInfo->ioaddr + SCBStatus));
 
   //
-  // include the prev ints as well
+  // The frames already in the ring are reaped without accessing the SCB,
+  // the status register is only read once the ring is empty.
   //
-  status = AdapterInfo->Int_Status;
   rx_cpbptr = (PXE_CPB_RECEIVE *) (UINTN) cpb;
   rx_dbptr  = (PXE_DB_RECEIVE *) (UINTN) db;
 
@@ -1335,11 +1342,27 @@ FreeRFD:
     rx_ptr = &AdapterInfo->rx_ring[AdapterInfo->cur_rx_ind];
   }
 
-  if (pkt_type == PXE_FRAME_TYPE_NONE) {
-    AdapterInfo->Int_Status &= (~SCB_STATUS_FR);
+  if (pkt_type != PXE_FRAME_TYPE_NONE) {
+    return ret_code;
   }
 
   status = InWord (AdapterInfo, AdapterInfo->ioaddr + SCBStatus);
+  AdapterInfo->Int_Status = (UINT16) (AdapterInfo->Int_Status | status);
+  //
+  // acknoledge the interrupts
+  //
+  if ((status & SCB_STATUS_MASK) != 0) {
+    OutWord (AdapterInfo, (UINT16) (status & SCB_STATUS_MASK), (UINT32) (AdapterInfo->ioaddr + SCBStatus));
+  }
+
+  //
+  // a frame may have completed since the ring was checked, keep its
+  // FR status for GetStatus
+  //
+  if ((rx_ptr->cb_header.status & RX_COMPLETE) == 0) {
+    AdapterInfo->Int_Status &= (~SCB_STATUS_FR);
+  }
+
   if ((status & SCB_RUS_NO_RESOURCES) != 0) {
     //
     // start the receive unit here!
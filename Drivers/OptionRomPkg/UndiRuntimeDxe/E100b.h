@@ -11,8 +11,12 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 // pci config offsets:
 
-#define RX_BUFFER_COUNT 32
-#define TX_BUFFER_COUNT 32
+//
+// The rings are sized at build time, they are part of the memory block
+// requested from the UNDI client (see MEMORY_NEEDED)
+//
+#define RX_BUFFER_COUNT FixedPcdGet16 (PcdUndiRxBufferCount)
+#define TX_BUFFER_COUNT FixedPcdGet16 (PcdUndiTxBufferCount)
 
 #define PCI_VENDOR_ID_INTEL 0x8086
 #define PCI_DEVICE_ID_INTEL_82557 0x1229
@@ -597,6 +597,13 @@ NorFlashRead (
 /*
   Write a full or portion of a block. It must not span block boundaries; that is,
   Offset + *NumBytes <= Instance->Media.BlockSize.
+
+  The block is handled in chunks the size of the P30 write buffer. The
+  chunks covered by the write are read once into the shadow buffer and
+  merged with the new data. If every merged chunk only clears bits, the
+  chunks that changed are programmed in place with buffered writes. Only
+  when a chunk needs a 0 to 1 transition is the rest of the block read
+  into the shadow buffer and the block erased and rewritten.
 */
 EFI_STATUS
 NorFlashWriteSingleBlock (
@@ -608,19 +615,19 @@ NorFlashWriteSingleBlock (
   )
 {
   EFI_STATUS  TempStatus;
-  UINT32      Tmp;
-  UINT32      TmpBuf;
-  UINT32      WordToWrite;
-  UINT32      Mask;
+  UINT8       *Shadow;
+  UINT32      *NewWords;
+  UINT32      OldWord;
   BOOLEAN     DoErase;
-  UINTN       BytesToWrite;
-  UINTN       CurOffset;
-  UINTN       WordAddr;
+  UINTN       DirtyStart;
+  UINTN       DirtyEnd;
+  UINTN       ChunkStart;
+  UINTN       ChunkEnd;
+  UINTN       ChunkOffset;
+  UINTN       ChunkSize;
+  UINTN       Index;
   UINTN       BlockSize;
   UINTN       BlockAddress;
-  UINTN       PrevBlockAddress;
-
-  PrevBlockAddress = 0;
 
   DEBUG ((DEBUG_BLKIO, "NorFlashWriteSingleBlock(Parameters: Lba=%ld, Offset=0x%x, *NumBytes=0x%x, Buffer @ 0x%08x)\n", Lba, Offset, *NumBytes, Buffer));
 
@@ -650,158 +657,110 @@ NorFlashWriteSingleBlock (
     return EFI_BAD_BUFFER_SIZE;
   }
 
-  // Pick 128bytes as a good start for word operations as opposed to erasing the
-  // block and writing the data regardless if an erase is really needed.
-  // It looks like most individual NV variable writes are smaller than 128bytes.
-  if (*NumBytes <= 128) {
-    // Check to see if we need to erase before programming the data into NOR.
-    // If the destination bits are only changing from 1s to 0s we can just write.
-    // After a block is erased all bits in the block is set to 1.
-    // If any byte requires us to erase we just give up and rewrite all of it.
-    DoErase      = FALSE;
-    BytesToWrite = *NumBytes;
-    CurOffset    = Offset;
-
-    while (BytesToWrite > 0) {
-      // Read full word from NOR, splice as required. A word is the smallest
-      // unit we can write.
-      TempStatus = NorFlashRead (Instance, Lba, CurOffset & ~(0x3), sizeof (Tmp), &Tmp);
-      if (EFI_ERROR (TempStatus)) {
-        return EFI_DEVICE_ERROR;
-      }
+  // Check we did get some memory. Buffer is BlockSize.
+  if (Instance->ShadowBuffer == NULL) {
+    DEBUG ((DEBUG_ERROR, "FvbWrite: ERROR - Buffer not ready\n"));
+    return EFI_DEVICE_ERROR;
+  }
 
-      // Physical address of word in NOR to write.
-      WordAddr = (CurOffset & ~(0x3)) + GET_NOR_BLOCK_ADDRESS (
-                                          Instance->RegionBaseAddress,
-                                          Lba,
-                                          BlockSize
-                                          );
-      // The word of data that is to be written.
-      TmpBuf = *((UINT32 *)(Buffer + (*NumBytes - BytesToWrite)));
-
-      // First do word aligned chunks.
-      if ((CurOffset & 0x3) == 0) {
-        if (BytesToWrite >= 4) {
-          // Is the destination still in 'erased' state?
-          if (~Tmp != 0) {
-            // Check to see if we are only changing bits to zero.
-            if ((Tmp ^ TmpBuf) & TmpBuf) {
-              DoErase = TRUE;
-              break;
-            }
-          }
-
-          // Write this word to NOR
-          WordToWrite   = TmpBuf;
-          CurOffset    += sizeof (TmpBuf);
-          BytesToWrite -= sizeof (TmpBuf);
-        } else {
-          // BytesToWrite < 4. Do small writes and left-overs
-          Mask = ~((~0) << (BytesToWrite * 8));
-          // Mask out the bytes we want.
-          TmpBuf &= Mask;
-          // Is the destination still in 'erased' state?
-          if ((Tmp & Mask) != Mask) {
-            // Check to see if we are only changing bits to zero.
-            if ((Tmp ^ TmpBuf) & TmpBuf) {
-              DoErase = TRUE;
-              break;
-            }
-          }
-
-          // Merge old and new data. Write merged word to NOR
-          WordToWrite  = (Tmp & ~Mask) | TmpBuf;
-          CurOffset   += BytesToWrite;
-          BytesToWrite = 0;
-        }
-      } else {
-        // Do multiple words, but starting unaligned.
-        if (BytesToWrite > (4 - (CurOffset & 0x3))) {
-          Mask = ((~0) << ((CurOffset & 0x3) * 8));
-          // Mask out the bytes we want.
-          TmpBuf &= Mask;
-          // Is the destination still in 'erased' state?
-          if ((Tmp & Mask) != Mask) {
-            // Check to see if we are only changing bits to zero.
-            if ((Tmp ^ TmpBuf) & TmpBuf) {
-              DoErase = TRUE;
-              break;
-            }
-          }
-
-          // Merge old and new data. Write merged word to NOR
-          WordToWrite   = (Tmp & ~Mask) | TmpBuf;
-          BytesToWrite -= (4 - (CurOffset & 0x3));
-          CurOffset    += (4 - (CurOffset & 0x3));
-        } else {
-          // Unaligned and fits in one word.
-          Mask = (~((~0) << (BytesToWrite * 8))) << ((CurOffset & 0x3) * 8);
-          // Mask out the bytes we want.
-          TmpBuf = (TmpBuf << ((CurOffset & 0x3) * 8)) & Mask;
-          // Is the destination still in 'erased' state?
-          if ((Tmp & Mask) != Mask) {
-            // Check to see if we are only changing bits to zero.
-            if ((Tmp ^ TmpBuf) & TmpBuf) {
-              DoErase = TRUE;
-              break;
-            }
-          }
-
-          // Merge old and new data. Write merged word to NOR
-          WordToWrite  = (Tmp & ~Mask) | TmpBuf;
-          CurOffset   += BytesToWrite;
-          BytesToWrite = 0;
-        }
-      }
+  Shadow       = (UINT8 *)Instance->ShadowBuffer;
+  BlockAddress = GET_NOR_BLOCK_ADDRESS (Instance->RegionBaseAddress, Lba, BlockSize);
 
-      //
-      // Write the word to NOR.
-      //
+  // Widen the write to whole write buffer chunks
+  ChunkStart = Offset & ~(P30_MAX_BUFFER_SIZE_IN_BYTES - 1);
+  ChunkEnd   = ALIGN_VALUE (Offset + *NumBytes, P30_MAX_BUFFER_SIZE_IN_BYTES);
+  if (ChunkEnd > BlockSize) {
+    ChunkEnd = BlockSize;
+  }
 
-      BlockAddress = GET_NOR_BLOCK_ADDRESS (Instance->RegionBaseAddress, Lba, BlockSize);
-      if (BlockAddress != PrevBlockAddress) {
-        TempStatus = NorFlashUnlockSingleBlockIfNecessary (Instance, BlockAddress);
-        if (EFI_ERROR (TempStatus)) {
-          return EFI_DEVICE_ERROR;
-        }
+  // Read the affected chunks from NOR and merge the new data into them
+  TempStatus = NorFlashRead (Instance, Lba, ChunkStart, ChunkEnd - ChunkStart, Shadow + ChunkStart);
+  if (EFI_ERROR (TempStatus)) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  // Check to see if we need to erase before programming the data into NOR.
+  // If the destination bits are only changing from 1s to 0s we can just write.
+  // After a block is erased all bits in the block is set to 1.
+  // Also track which words actually change, so unchanged chunks are skipped.
+  DoErase    = FALSE;
+  DirtyStart = BlockSize;
+  DirtyEnd   = 0;
+  for (Index = Offset & ~(0x3); Index < Offset + *NumBytes; Index += sizeof (UINT32)) {
+    OldWord = *(UINT32 *)(Shadow + Index);
+    CopyMem (
+      Shadow + MAX (Index, Offset),
+      Buffer + (MAX (Index, Offset) - Offset),
+      MIN (Index + sizeof (UINT32), Offset + *NumBytes) - MAX (Index, Offset)
+      );
+    if (OldWord != *(UINT32 *)(Shadow + Index)) {
+      DirtyStart = MIN (DirtyStart, Index);
+      DirtyEnd   = Index + sizeof (UINT32);
+    }
 
-        PrevBlockAddress = BlockAddress;
+    if ((OldWord & *(UINT32 *)(Shadow + Index)) != *(UINT32 *)(Shadow + Index)) {
+      DoErase = TRUE;
+    }
+  }
+
+  // Nothing to do if NOR already holds the data
+  if (DirtyEnd == 0) {
+    return EFI_SUCCESS;
+  }
+
+  if (DoErase) {
+    // Complete the shadow copy with the parts of the block we have not read yet
+    if (ChunkStart > 0) {
+      TempStatus = NorFlashRead (Instance, Lba, 0, ChunkStart, Shadow);
+      if (EFI_ERROR (TempStatus)) {
+        return EFI_DEVICE_ERROR;
       }
+    }
 
-      TempStatus = NorFlashWriteSingleWord (Instance, WordAddr, WordToWrite);
+    if (ChunkEnd < BlockSize) {
+      TempStatus = NorFlashRead (Instance, Lba, ChunkEnd, BlockSize - ChunkEnd, Shadow + ChunkEnd);
       if (EFI_ERROR (TempStatus)) {
         return EFI_DEVICE_ERROR;
       }
     }
 
-    // Exit if we got here and could write all the data. Otherwise do the
-    // Erase-Write cycle.
-    if (!DoErase) {
-      return EFI_SUCCESS;
+    // Erase the block and write the modified buffer back to the NorFlash
+    TempStatus = NorFlashWriteBlocks (Instance, Lba, BlockSize, Shadow);
+    if (EFI_ERROR (TempStatus)) {
+      // Return one of the pre-approved error statuses
+      return EFI_DEVICE_ERROR;
     }
-  }
 
-  // Check we did get some memory. Buffer is BlockSize.
-  if (Instance->ShadowBuffer == NULL) {
-    DEBUG ((DEBUG_ERROR, "FvbWrite: ERROR - Buffer not ready\n"));
-    return EFI_DEVICE_ERROR;
+    return EFI_SUCCESS;
   }
 
-  // Read NOR Flash data into shadow buffer
-  TempStatus = NorFlashReadBlocks (Instance, Lba, BlockSize, Instance->ShadowBuffer);
+  TempStatus = NorFlashUnlockSingleBlockIfNecessary (Instance, BlockAddress);
   if (EFI_ERROR (TempStatus)) {
-    // Return one of the pre-approved error statuses
     return EFI_DEVICE_ERROR;
   }
 
-  // Put the data at the appropriate location inside the buffer area
-  CopyMem ((VOID *)((UINTN)Instance->ShadowBuffer + Offset), Buffer, *NumBytes);
+  // Program the chunks holding changed words. Reprogramming a word with
+  // the value it already holds leaves it as it is.
+  ChunkStart = DirtyStart & ~(P30_MAX_BUFFER_SIZE_IN_BYTES - 1);
+  for (ChunkOffset = ChunkStart; ChunkOffset < DirtyEnd; ChunkOffset += ChunkSize) {
+    ChunkSize = MIN (P30_MAX_BUFFER_SIZE_IN_BYTES, ChunkEnd - ChunkOffset);
+    NewWords  = (UINT32 *)(Shadow + ChunkOffset);
 
-  // Write the modified buffer back to the NorFlash
-  TempStatus = NorFlashWriteBlocks (Instance, Lba, BlockSize, Instance->ShadowBuffer);
-  if (EFI_ERROR (TempStatus)) {
-    // Return one of the pre-approved error statuses
-    return EFI_DEVICE_ERROR;
+    if (((BlockAddress + ChunkOffset) & BOUNDARY_OF_32_WORDS) == 0) {
+      TempStatus = NorFlashWriteBuffer (Instance, BlockAddress + ChunkOffset, ChunkSize, NewWords);
+    } else {
+      // The chunk is not aligned to the write buffer, program it word by word
+      for (Index = 0; Index < ChunkSize / sizeof (UINT32); Index++) {
+        TempStatus = NorFlashWriteSingleWord (Instance, BlockAddress + ChunkOffset + Index * sizeof (UINT32), NewWords[Index]);
+        if (EFI_ERROR (TempStatus)) {
+          break;
+        }
+      }
+    }
+
+    if (EFI_ERROR (TempStatus)) {
+      return EFI_DEVICE_ERROR;
+    }
   }
 
   return EFI_SUCCESS;
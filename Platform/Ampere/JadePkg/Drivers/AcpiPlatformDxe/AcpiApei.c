@@ -231,8 +231,7 @@ WriteSpinorDefaultBertTable (
              OFFSET_OF (APEI_CRASH_DUMP_DATA, Vendor) +
              OFFSET_OF (APEI_BERT_ERROR_DATA, Type);
     Length = sizeof (DefaultData.Type);
-    FlashEraseCommand (Offset, Length);
-    FlashWriteCommand (Offset, &(DefaultData.Type), Length);
+    FlashUpdateCommand (Offset, &(DefaultData.Type), Length);
   }
 
   if ((Bed->Vendor.SubType != DefaultData.SubType)) {
@@ -240,8 +239,7 @@ WriteSpinorDefaultBertTable (
              OFFSET_OF (APEI_CRASH_DUMP_DATA, Vendor) +
              OFFSET_OF (APEI_BERT_ERROR_DATA, SubType);
     Length = sizeof (DefaultData.SubType);
-    FlashEraseCommand (Offset, Length);
-    FlashWriteCommand (Offset, &(DefaultData.SubType), Length);
+    FlashUpdateCommand (Offset, &(DefaultData.SubType), Length);
   }
 
   if ((Bed->Vendor.Instance != DefaultData.Instance)) {
@@ -249,8 +247,7 @@ WriteSpinorDefaultBertTable (
              OFFSET_OF (APEI_CRASH_DUMP_DATA, Vendor) +
              OFFSET_OF (APEI_BERT_ERROR_DATA, Instance);
     Length = sizeof (DefaultData.Instance);
-    FlashEraseCommand (Offset, Length);
-    FlashWriteCommand (Offset, &(DefaultData.Instance), Length);
+    FlashUpdateCommand (Offset, &(DefaultData.Instance), Length);
   }
 
   MsgDiff = AsciiStrnCmp (Bed->Vendor.Msg, DefaultData.Msg, BERT_MSG_SIZE);
@@ -259,16 +256,14 @@ WriteSpinorDefaultBertTable (
              OFFSET_OF (APEI_CRASH_DUMP_DATA, Vendor) +
              OFFSET_OF (APEI_BERT_ERROR_DATA, Msg);
     Length = sizeof (DefaultData.Msg);
-    FlashEraseCommand (Offset, Length);
-    FlashWriteCommand (Offset, &(DefaultData.Msg), Length);
+    FlashUpdateCommand (Offset, &(DefaultData.Msg), Length);
   }
 
   if (Bed->BertRev != CURRENT_BERT_VERSION) {
     Offset = BERT_FLASH_OFFSET + OFFSET_OF (APEI_CRASH_DUMP_DATA, BertRev);
     Length = sizeof (Bed->BertRev);
     BertRev = CURRENT_BERT_VERSION;
-    FlashEraseCommand (Offset, Length);
-    FlashWriteCommand (Offset, &BertRev, Length);
+    FlashUpdateCommand (Offset, &BertRev, Length);
   }
 
 }
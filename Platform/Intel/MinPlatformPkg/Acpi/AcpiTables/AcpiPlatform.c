@@ -60,6 +60,24 @@ EFI_MP_SERVICES_PROTOCOL    *mMpService;
 UINTN                       mNumberOfCpus = 0;
 UINTN                       mNumberOfEnabledCPUs = 0;
 
+//
+// Slice-by-8 lookup tables of the CRC32 used for the FACS HardwareSignature,
+// ACPI_CRC32_TABLE_COUNT tables of 256 entries.
+//
+#define ACPI_CRC32_POLYNOMIAL   0xEDB88320
+#define ACPI_CRC32_TABLE_COUNT  8
+
+UINT32                      *mAcpiCrc32Table = NULL;
+
+///
+/// CRC records of the ACPI tables found by EnumerateAllAcpiTables ().
+///
+typedef struct {
+  UINTN                     Count;
+  UINTN                     MaxCount;
+  UINT32                    *TableCrcRecord;
+} ACPI_TABLE_CRC_CONTEXT;
+
 /**
   Print Cpu Apic ID Table
 
@@ -1191,12 +1209,11 @@ PlatformUpdateTables (
 }
 
 /**
-  Function prototype for GetAcpiTableCount/CalculateAcpiTableCrc.
+  Function prototype for CalculateAcpiTableCrc.
 
   @param[in] Table        The pointer to ACPI table.
   @param[in] TableIndex   The ACPI table index.
-  @param[in] Context      The pointer to UINTN for GetAcpiTableCount.
-                          The pointer to UINT32 array for CalculateAcpiTableCrc.
+  @param[in] Context      The pointer to ACPI_TABLE_CRC_CONTEXT for CalculateAcpiTableCrc.
 **/
 typedef
 VOID
@@ -1212,9 +1229,8 @@ VOID
   @param[in] Sdt                ACPI XSDT/RSDT.
   @param[in] TablePointerSize   Size of table pointer:
                                 4(RSDT) or 8(XSDT).
-  @param[in] CallbackFunction   The pointer to GetAcpiTableCount/CalculateAcpiTableCrc.
-  @param[in] Context            The pointer to UINTN for GetAcpiTableCount.
-                                The pointer to UINT32 array for CalculateAcpiTableCrc.
+  @param[in] CallbackFunction   The pointer to CalculateAcpiTableCrc.
+  @param[in] Context            The pointer to ACPI_TABLE_CRC_CONTEXT for CalculateAcpiTableCrc.
 **/
 VOID
 EnumerateAllAcpiTables (
@@ -1286,30 +1302,106 @@ EnumerateAllAcpiTables (
 }
 
 /**
-  Count the number of ACPI tables.
+  Build the slice-by-8 lookup tables of the CRC32.
 
-  @param[in] Table        The pointer to ACPI table.
-  @param[in] TableIndex   The ACPI table index.
-  @param[in] Context      The pointer to UINTN.
+  @retval EFI_SUCCESS           The tables are built.
+  @retval EFI_OUT_OF_RESOURCES  The tables could not be allocated.
 **/
-VOID
-EFIAPI
-GetAcpiTableCount (
-  IN  EFI_ACPI_COMMON_HEADER  *Table,
-  IN  UINTN                   TableIndex,
-  IN  VOID                    *Context
+EFI_STATUS
+InitializeAcpiCrc32Table (
+  VOID
   )
 {
-  UINTN  *TableCount;
-
-  TableCount = (UINTN *)Context;
+  UINT32  *Table;
+  UINTN   Index;
+  UINTN   Slice;
+  UINTN   Bit;
+  UINT32  Crc;
+
+  if (mAcpiCrc32Table != NULL) {
+    return EFI_SUCCESS;
+  }
 
+  Table = AllocatePool (ACPI_CRC32_TABLE_COUNT * 256 * sizeof (UINT32));
   if (Table == NULL) {
-    ASSERT (Table != NULL);
-    return;
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  for (Index = 0; Index < 256; Index++) {
+    Crc = (UINT32)Index;
+    for (Bit = 0; Bit < 8; Bit++) {
+      Crc = ((Crc & 1) != 0) ? ((Crc >> 1) ^ ACPI_CRC32_POLYNOMIAL) : (Crc >> 1);
+    }
+    Table[Index] = Crc;
+  }
+
+  //
+  // Table[Slice][Index] is the CRC of byte Index followed by Slice zero bytes.
+  //
+  for (Slice = 1; Slice < ACPI_CRC32_TABLE_COUNT; Slice++) {
+    for (Index = 0; Index < 256; Index++) {
+      Crc                        = Table[(Slice - 1) * 256 + Index];
+      Table[Slice * 256 + Index] = (Crc >> 8) ^ Table[Crc & 0xFF];
+    }
   }
 
-  (*TableCount)++;
+  mAcpiCrc32Table = Table;
+  return EFI_SUCCESS;
+}
+
+/**
+  Calculate the CRC32 of a buffer eight bytes at a time.
+
+  The result is the same as the one of gBS->CalculateCrc32 (), which processes
+  one byte at a time and dominates the time spent on large DSDT/SSDT sets.
+
+  @param[in] Data     The buffer.
+  @param[in] Length   The size of the buffer in bytes.
+
+  @return The CRC32 of the buffer.
+**/
+UINT32
+AcpiCalculateCrc32 (
+  IN  VOID   *Data,
+  IN  UINTN  Length
+  )
+{
+  CONST UINT32  *T;
+  UINT8         *Ptr;
+  UINT32        Crc;
+  UINT32        Low;
+  UINT32        High;
+
+  if (mAcpiCrc32Table == NULL) {
+    gBS->CalculateCrc32 (Data, Length, &Crc);
+    return Crc;
+  }
+
+  T   = mAcpiCrc32Table;
+  Ptr = (UINT8 *)Data;
+  Crc = 0xFFFFFFFF;
+  while (Length >= 8) {
+    Low  = ReadUnaligned32 ((UINT32 *)Ptr) ^ Crc;
+    High = ReadUnaligned32 ((UINT32 *)(Ptr + 4));
+    Crc  = T[7 * 256 + (Low & 0xFF)] ^
+           T[6 * 256 + ((Low >> 8) & 0xFF)] ^
+           T[5 * 256 + ((Low >> 16) & 0xFF)] ^
+           T[4 * 256 + (Low >> 24)] ^
+           T[3 * 256 + (High & 0xFF)] ^
+           T[2 * 256 + ((High >> 8) & 0xFF)] ^
+           T[1 * 256 + ((High >> 16) & 0xFF)] ^
+           T[0 * 256 + (High >> 24)];
+    Ptr    += 8;
+    Length -= 8;
+  }
+
+  while (Length > 0) {
+    Crc = T[(Crc ^ *Ptr) & 0xFF] ^ (Crc >> 8);
+    Ptr++;
+    Length--;
+  }
+
+  return Crc ^ 0xFFFFFFFF;
 }
 
 /**
@@ -1317,7 +1409,7 @@ GetAcpiTableCount (
 
   @param[in] Table        The pointer to ACPI table.
   @param[in] TableIndex   The ACPI table index.
-  @param[in] Context      The pointer to UINT32 array.
+  @param[in] Context      The pointer to ACPI_TABLE_CRC_CONTEXT.
 **/
 VOID
 EFIAPI
@@ -1327,15 +1419,20 @@ CalculateAcpiTableCrc (
   IN  VOID                    *Context
   )
 {
-  UINT32  *TableCrcRecord;
+  ACPI_TABLE_CRC_CONTEXT  *CrcContext;
 
-  TableCrcRecord = (UINT32 *)Context;
+  CrcContext = (ACPI_TABLE_CRC_CONTEXT *)Context;
 
   if (Table == NULL) {
     ASSERT (Table != NULL);
     return;
   }
 
+  if (TableIndex >= CrcContext->MaxCount) {
+    ASSERT (TableIndex < CrcContext->MaxCount);
+    return;
+  }
+
   //
   // Calculate CRC value.
   //
@@ -1346,7 +1443,8 @@ CalculateAcpiTableCrc (
     ((EFI_ACPI_6_5_FIRMWARE_ACPI_CONTROL_STRUCTURE *)Table)->HardwareSignature = 0;
   }
 
-  gBS->CalculateCrc32 ((UINT8 *)Table, (UINTN)Table->Length, &TableCrcRecord[TableIndex]);
+  CrcContext->TableCrcRecord[TableIndex] = AcpiCalculateCrc32 (Table, (UINTN)Table->Length);
+  CrcContext->Count                      = TableIndex + 1;
 }
 
 /**
@@ -1360,16 +1458,15 @@ IsAcpiTableChange (
 {
   EFI_STATUS                                    Status;
   BOOLEAN                                       IsRsdt;
-  UINTN                                         AcpiTableCount;
-  UINT32                                        *TableCrcRecord;
+  ACPI_TABLE_CRC_CONTEXT                        CrcContext;
+  EFI_ACPI_DESCRIPTION_HEADER                   *Sdt;
   EFI_ACPI_6_5_ROOT_SYSTEM_DESCRIPTION_POINTER  *Rsdp;
   EFI_ACPI_DESCRIPTION_HEADER                   *Rsdt;
   EFI_ACPI_DESCRIPTION_HEADER                   *Xsdt;
   EFI_ACPI_6_5_FIRMWARE_ACPI_CONTROL_STRUCTURE  *FacsPtr;
 
   IsRsdt         = FALSE;
-  AcpiTableCount = 0;
-  TableCrcRecord = NULL;
+  Sdt            = NULL;
   Rsdp           = NULL;
   Rsdt           = NULL;
   Xsdt           = NULL;
@@ -1398,38 +1495,34 @@ IsAcpiTableChange (
   }
 
   //
-  // Count the ACPI tables found by RSDT/XSDT and FADT.
-  //
-  if (IsRsdt) {
-    EnumerateAllAcpiTables (Rsdt, sizeof (UINT32), GetAcpiTableCount, (VOID *)&AcpiTableCount);
-  } else {
-    EnumerateAllAcpiTables (Xsdt, sizeof (UINT64), GetAcpiTableCount, (VOID *)&AcpiTableCount);
-  }
-
-  //
-  // Allocate memory for founded ACPI tables.
+  // Every RSDT/XSDT entry is one table, plus the FACS and DSDT of a FADT, so the
+  // records can be sized without counting the tables first.
   //
-  TableCrcRecord = AllocateZeroPool (sizeof (UINT32) * AcpiTableCount);
-  if (TableCrcRecord == NULL) {
+  Sdt = IsRsdt ? Rsdt : Xsdt;
+  ZeroMem (&CrcContext, sizeof (CrcContext));
+  CrcContext.MaxCount       = ((Sdt->Length - sizeof (EFI_ACPI_DESCRIPTION_HEADER)) / (IsRsdt ? sizeof (UINT32) : sizeof (UINT64))) * 3;
+  CrcContext.TableCrcRecord = AllocateZeroPool (sizeof (UINT32) * CrcContext.MaxCount);
+  if (CrcContext.TableCrcRecord == NULL) {
     return;
   }
 
   //
   // Calculate CRC for each ACPI table and set record.
   //
-  if (IsRsdt) {
-    EnumerateAllAcpiTables (Rsdt, sizeof (UINT32), CalculateAcpiTableCrc, (VOID *)TableCrcRecord);
-  } else {
-    EnumerateAllAcpiTables (Xsdt, sizeof (UINT64), CalculateAcpiTableCrc, (VOID *)TableCrcRecord);
-  }
+  InitializeAcpiCrc32Table ();
+  EnumerateAllAcpiTables (Sdt, IsRsdt ? sizeof (UINT32) : sizeof (UINT64), CalculateAcpiTableCrc, (VOID *)&CrcContext);
 
   //
   // Calculate and set HardwareSignature data.
   //
-  Status = gBS->CalculateCrc32 ((UINT8 *)TableCrcRecord, AcpiTableCount, &(FacsPtr->HardwareSignature));
+  Status = gBS->CalculateCrc32 ((UINT8 *)CrcContext.TableCrcRecord, sizeof (UINT32) * CrcContext.Count, &(FacsPtr->HardwareSignature));
   DEBUG ((DEBUG_INFO, "HardwareSignature = %x and Status = %r\n", FacsPtr->HardwareSignature, Status));
 
-  FreePool (TableCrcRecord);
+  FreePool (CrcContext.TableCrcRecord);
+  if (mAcpiCrc32Table != NULL) {
+    FreePool (mAcpiCrc32Table);
+    mAcpiCrc32Table = NULL;
+  }
   DEBUG ((DEBUG_INFO, "%a() - End\n", __FUNCTION__));
 }
 
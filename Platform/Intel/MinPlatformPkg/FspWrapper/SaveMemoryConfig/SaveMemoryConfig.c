@@ -22,9 +22,115 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/LargeVariableReadLib.h>
 #include <Library/LargeVariableWriteLib.h>
 #include <Library/PcdLib.h>
+#include <Library/VariableReadLib.h>
 #include <Library/VariableWriteLib.h>
+#include <Library/BaseCryptLib.h>
 #include <Guid/FspNonVolatileStorageHob2.h>
 
+#define FSP_NVS_BUFFER_DIGEST_VARIABLE_NAME  L"FspNvsBufferDigest"
+#define FSP_NVS_BUFFER_DIGEST_VERSION        1
+#define FSP_NVS_BUFFER_DIGEST_COMPRESSED     BIT0
+
+///
+/// Companion variable of FspNvsBuffer. It holds the SHA-256 digest of the
+/// uncompressed FSP NVS data saved in FspNvsBuffer, so that an unchanged
+/// FSP NVS HOB is detected without compressing it and reading back the
+/// whole FspNvsBuffer.
+///
+typedef struct {
+  UINT32    Version;
+  UINT32    Flags;
+  UINT64    StoredSize;                     ///< Size of the data stored in FspNvsBuffer
+  UINT8     Digest[SHA256_DIGEST_SIZE];     ///< SHA-256 digest of the uncompressed FSP NVS data
+} FSP_NVS_BUFFER_DIGEST;
+
+/**
+  Check the FspNvsBufferDigest variable against the digest of the present FSP NVS data.
+
+  @param[in]  Digest        Digest of the present FSP NVS data, StoredSize is filled on a match.
+  @param[out] DigestFound   TRUE if a FspNvsBufferDigest variable of the present version exists.
+
+  @retval TRUE    FspNvsBuffer holds the present FSP NVS data.
+  @retval FALSE   FspNvsBuffer must be checked or updated.
+**/
+BOOLEAN
+IsFspNvsBufferDigestMatch (
+  IN OUT FSP_NVS_BUFFER_DIGEST  *Digest,
+  OUT    BOOLEAN                *DigestFound
+  )
+{
+  EFI_STATUS             Status;
+  FSP_NVS_BUFFER_DIGEST  SavedDigest;
+  UINTN                  Size;
+  UINTN                  BufferSize;
+
+  *DigestFound = FALSE;
+
+  Size   = sizeof (SavedDigest);
+  Status = VarLibGetVariable (FSP_NVS_BUFFER_DIGEST_VARIABLE_NAME, &gFspNvsBufferVariableGuid, NULL, &Size, &SavedDigest);
+  if (EFI_ERROR (Status) || (Size != sizeof (SavedDigest)) || (SavedDigest.Version != FSP_NVS_BUFFER_DIGEST_VERSION)) {
+    return FALSE;
+  }
+  *DigestFound = TRUE;
+
+  if ((SavedDigest.Flags != Digest->Flags) || (CompareMem (SavedDigest.Digest, Digest->Digest, SHA256_DIGEST_SIZE) != 0)) {
+    return FALSE;
+  }
+
+  //
+  // The digest only describes the data, make sure FspNvsBuffer is still present with the size saved next to it.
+  //
+  BufferSize = 0;
+  Status     = GetLargeVariable (L"FspNvsBuffer", &gFspNvsBufferVariableGuid, &BufferSize, NULL);
+  if ((Status != EFI_BUFFER_TOO_SMALL) || (BufferSize != SavedDigest.StoredSize)) {
+    return FALSE;
+  }
+
+  Digest->StoredSize = SavedDigest.StoredSize;
+  return TRUE;
+}
+
+/**
+  Save and lock the FspNvsBufferDigest variable, or delete it.
+
+  @param[in] Digest         Digest of the data saved in FspNvsBuffer, NULL to delete the variable.
+**/
+VOID
+SaveFspNvsBufferDigest (
+  IN FSP_NVS_BUFFER_DIGEST  *Digest OPTIONAL
+  )
+{
+  EFI_STATUS  Status;
+
+  Status = VarLibSetVariable (
+             FSP_NVS_BUFFER_DIGEST_VARIABLE_NAME,
+             &gFspNvsBufferVariableGuid,
+             EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_RUNTIME_ACCESS,
+             (Digest == NULL) ? 0 : sizeof (FSP_NVS_BUFFER_DIGEST),
+             Digest
+             );
+  if ((Digest == NULL) || EFI_ERROR (Status)) {
+    return;
+  }
+
+  if (VarLibIsVariableRequestToLockSupported ()) {
+    Status = VarLibVariableRequestToLock (FSP_NVS_BUFFER_DIGEST_VARIABLE_NAME, &gFspNvsBufferVariableGuid);
+    if (EFI_ERROR (Status)) {
+      //
+      // An unlocked digest could hide a changed FspNvsBuffer, delete it so the next boot compares the data.
+      //
+      DEBUG ((DEBUG_ERROR, "Failed to lock FspNvsBufferDigest, delete it!\n"));
+      VarLibSetVariable (
+        FSP_NVS_BUFFER_DIGEST_VARIABLE_NAME,
+        &gFspNvsBufferVariableGuid,
+        EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_RUNTIME_ACCESS,
+        0,
+        NULL
+        );
+    }
+  }
+}
+
 /**
   This is the standard EFI driver point that detects whether there is a
   MemoryConfigurationData HOB and, if so, saves its data to nvRAM.
@@ -41,16 +147,19 @@ SaveMemoryConfigEntryPoint (
   IN EFI_SYSTEM_TABLE   *SystemTable
   )
 {
-  EFI_STATUS         Status;
-  EFI_HOB_GUID_TYPE  *GuidHob;
-  VOID               *HobData;
-  VOID               *VariableData;
-  UINTN              DataSize;
-  UINTN              BufferSize;
-  BOOLEAN            DataIsIdentical;
-  VOID               *CompressedData;
-  UINT64             CompressedSize;
-  UINTN              CompressedAllocationPages;
+  EFI_STATUS             Status;
+  EFI_HOB_GUID_TYPE      *GuidHob;
+  VOID                   *HobData;
+  VOID                   *VariableData;
+  UINTN                  DataSize;
+  UINTN                  BufferSize;
+  BOOLEAN                DataIsIdentical;
+  VOID                   *CompressedData;
+  UINT64                 CompressedSize;
+  UINTN                  CompressedAllocationPages;
+  FSP_NVS_BUFFER_DIGEST  Digest;
+  BOOLEAN                DigestValid;
+  BOOLEAN                DigestFound;
 
   DataSize                  = 0;
   BufferSize                = 0;
@@ -61,6 +170,8 @@ SaveMemoryConfigEntryPoint (
   CompressedData            = NULL;
   CompressedSize            = 0;
   CompressedAllocationPages = 0;
+  DigestValid               = FALSE;
+  DigestFound               = FALSE;
 
   //
   // Search for the Memory Configuration GUID HOB.  If it is not present, then
@@ -82,6 +193,32 @@ SaveMemoryConfigEntryPoint (
     }
   }
 
+  //
+  // Hash the uncompressed data. If FspNvsBufferDigest matches, FspNvsBuffer is up to date and
+  // neither the compression nor the read back of FspNvsBuffer is needed.
+  //
+  if ((HobData != NULL) && (DataSize > 0)) {
+    ZeroMem (&Digest, sizeof (Digest));
+    Digest.Version = FSP_NVS_BUFFER_DIGEST_VERSION;
+    if (PcdGetBool (PcdEnableCompressedFspNvsBuffer)) {
+      Digest.Flags = FSP_NVS_BUFFER_DIGEST_COMPRESSED;
+    }
+    DigestValid = Sha256HashAll (HobData, DataSize, Digest.Digest);
+    if (DigestValid && IsFspNvsBufferDigestMatch (&Digest, &DigestFound)) {
+      Status = LockLargeVariable (L"FspNvsBuffer",  &gFspNvsBufferVariableGuid);
+      if (!EFI_ERROR (Status)) {
+        SaveFspNvsBufferDigest (&Digest);
+        DEBUG ((DEBUG_INFO, "FSP / MRC Training Data digest is identical to data from last boot, no need to save.\n"));
+        return EFI_REQUEST_UNLOAD_IMAGE;
+      }
+      //
+      // Fail to lock variable is security vulnerability and should not happen.
+      // Take the full path below, it deletes the variable when it cannot be locked.
+      //
+      ASSERT_EFI_ERROR (Status);
+    }
+  }
+
   if (PcdGetBool (PcdEnableCompressedFspNvsBuffer)) {
     if (DataSize > 0) {
       CompressedAllocationPages = EFI_SIZE_TO_PAGES (DataSize);
@@ -110,9 +247,14 @@ SaveMemoryConfigEntryPoint (
     DEBUG ((DEBUG_INFO, "FspNvsHob.NvsDataPtr   : 0x%x\n", HobData));
     if (DataSize > 0) {
       //
-      // Check if the presently saved data is identical to the data given by MRC/FSP
+      // Check if the presently saved data is identical to the data given by MRC/FSP.
+      // When a digest of the saved data exists and differs, the data has changed and
+      // there is no need to read it back.
       //
-      Status = GetLargeVariable (L"FspNvsBuffer", &gFspNvsBufferVariableGuid, &BufferSize, NULL);
+      Status = EFI_NOT_FOUND;
+      if (!DigestValid || !DigestFound) {
+        Status = GetLargeVariable (L"FspNvsBuffer", &gFspNvsBufferVariableGuid, &BufferSize, NULL);
+      }
       if (Status == EFI_BUFFER_TOO_SMALL) {
         if (BufferSize == DataSize) {
           VariableData = AllocatePool (BufferSize);
@@ -145,6 +287,13 @@ SaveMemoryConfigEntryPoint (
       Status = EFI_SUCCESS;
 
       if (!DataIsIdentical) {
+        //
+        // Drop the digest of the old data first, a stale digest must never describe the new data.
+        //
+        if (DigestFound) {
+          SaveFspNvsBufferDigest (NULL);
+          DigestFound = FALSE;
+        }
         Status = SetLargeVariable (L"FspNvsBuffer", &gFspNvsBufferVariableGuid, TRUE, DataSize, HobData);
         if (Status == EFI_ABORTED) {
           //
@@ -163,6 +312,16 @@ SaveMemoryConfigEntryPoint (
       } else {
         DEBUG ((DEBUG_INFO, "FSP / MRC Training Data is identical to data from last boot, no need to save.\n"));
       }
+
+      //
+      // Keep the digest in sync with FspNvsBuffer, a deleted FspNvsBuffer deletes the digest.
+      //
+      if (DigestValid && !EFI_ERROR (Status) && (DataSize > 0)) {
+        Digest.StoredSize = DataSize;
+        SaveFspNvsBufferDigest (&Digest);
+      } else if (DigestFound || (DataSize == 0)) {
+        SaveFspNvsBufferDigest (NULL);
+      }
     }
   } else {
     DEBUG((DEBUG_ERROR, "Memory S3 Data HOB was not found\n"));
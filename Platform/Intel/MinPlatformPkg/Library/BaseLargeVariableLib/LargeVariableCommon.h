@@ -51,4 +51,41 @@
 //
 #define MAX_VARIABLE_NAME_PAD_SIZE  3
 
+//
+// When more than one variable is needed to store the data, a manifest variable
+// named "<VariableName>#Manifest" describes the size and CRC32 of every chunk.
+// It lets GetLargeVariable() read the chunks without probing their sizes first
+// and lets SetLargeVariable() skip the chunks whose content did not change.
+// Data sets needing more than LARGE_VARIABLE_MANIFEST_MAX_CHUNKS variables are
+// stored without a manifest.
+//
+#define LARGE_VARIABLE_MANIFEST_NAME_FORMAT    L"%s#Manifest"
+#define LARGE_VARIABLE_MANIFEST_SUFFIX_LENGTH  9
+#define LARGE_VARIABLE_MANIFEST_SIGNATURE      SIGNATURE_32 ('L', 'V', 'M', 'F')
+#define LARGE_VARIABLE_MANIFEST_MAX_CHUNKS     64
+
+typedef struct {
+  UINT32    Signature;
+  UINT32    ChunkCount;
+  UINT64    TotalSize;
+  UINT32    Crc32;        ///< CRC32 of the whole data set
+  UINT32    Reserved;
+} LARGE_VARIABLE_MANIFEST_HEADER;
+
+typedef struct {
+  UINT32    Size;
+  UINT32    Crc32;
+} LARGE_VARIABLE_MANIFEST_CHUNK;
+
+///
+/// Only Header and the first Header.ChunkCount entries of Chunk are stored.
+///
+typedef struct {
+  LARGE_VARIABLE_MANIFEST_HEADER    Header;
+  LARGE_VARIABLE_MANIFEST_CHUNK     Chunk[LARGE_VARIABLE_MANIFEST_MAX_CHUNKS];
+} LARGE_VARIABLE_MANIFEST;
+
+#define LARGE_VARIABLE_MANIFEST_SIZE(ChunkCount) \
+  (sizeof (LARGE_VARIABLE_MANIFEST_HEADER) + (ChunkCount) * sizeof (LARGE_VARIABLE_MANIFEST_CHUNK))
+
 #endif  // _LARGE_VARIABLE_COMMON_H_
@@ -24,6 +24,122 @@
 
 #include "LargeVariableCommon.h"
 
+/**
+  Reads and validates the manifest of a large variable stored in multiple variables.
+
+  @param[in]  VariableName       A Null-terminated string that is the name of the vendor's variable.
+  @param[in]  VendorGuid         A unique identifier for the vendor.
+  @param[out] Manifest           The manifest read.
+
+  @retval EFI_SUCCESS            A valid manifest was read.
+  @retval EFI_NOT_FOUND          There is no valid manifest for the variable.
+
+**/
+STATIC
+EFI_STATUS
+GetLargeVariableManifest (
+  IN  CHAR16                       *VariableName,
+  IN  EFI_GUID                     *VendorGuid,
+  OUT LARGE_VARIABLE_MANIFEST      *Manifest
+  )
+{
+  CHAR16        ManifestName[MAX_VARIABLE_NAME_SIZE];
+  EFI_STATUS    Status;
+  UINTN         Size;
+  UINTN         Index;
+  UINT64        TotalSize;
+
+  if (StrLen (VariableName) >= (MAX_VARIABLE_NAME_SIZE - LARGE_VARIABLE_MANIFEST_SUFFIX_LENGTH)) {
+    return EFI_NOT_FOUND;
+  }
+  UnicodeSPrint (ManifestName, sizeof (ManifestName), LARGE_VARIABLE_MANIFEST_NAME_FORMAT, VariableName);
+
+  Size   = sizeof (LARGE_VARIABLE_MANIFEST);
+  Status = VarLibGetVariable (ManifestName, VendorGuid, NULL, &Size, Manifest);
+  if (EFI_ERROR (Status) ||
+      (Size < sizeof (LARGE_VARIABLE_MANIFEST_HEADER)) ||
+      (Manifest->Header.Signature != LARGE_VARIABLE_MANIFEST_SIGNATURE) ||
+      (Manifest->Header.ChunkCount == 0) ||
+      (Manifest->Header.ChunkCount > LARGE_VARIABLE_MANIFEST_MAX_CHUNKS) ||
+      (Size != LARGE_VARIABLE_MANIFEST_SIZE (Manifest->Header.ChunkCount))) {
+    return EFI_NOT_FOUND;
+  }
+
+  TotalSize = 0;
+  for (Index = 0; Index < Manifest->Header.ChunkCount; Index++) {
+    TotalSize += Manifest->Chunk[Index].Size;
+  }
+  if ((TotalSize != Manifest->Header.TotalSize) || (TotalSize > MAX_UINTN)) {
+    return EFI_NOT_FOUND;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Reads a large variable using its manifest. Every chunk is read once with the
+  size recorded in the manifest, and the result is checked against the CRC32 of
+  the whole data set.
+
+  @param[in]       VariableName  A Null-terminated string that is the name of the vendor's variable.
+  @param[in]       VendorGuid    A unique identifier for the vendor.
+  @param[in]       Manifest      The manifest of the variable.
+  @param[in, out]  DataSize      On input, the size in bytes of the return Data buffer.
+                                 On output the size of data returned in Data.
+  @param[out]      Data          The buffer to return the contents of the variable.
+
+  @retval EFI_SUCCESS            The function completed successfully.
+  @retval EFI_BUFFER_TOO_SMALL   The DataSize is too small for the result.
+  @retval EFI_INVALID_PARAMETER  The DataSize is not too small and Data is NULL.
+  @retval EFI_VOLUME_CORRUPTED   The variables do not match the manifest.
+
+**/
+STATIC
+EFI_STATUS
+GetLargeVariableFromManifest (
+  IN     CHAR16                      *VariableName,
+  IN     EFI_GUID                    *VendorGuid,
+  IN     LARGE_VARIABLE_MANIFEST     *Manifest,
+  IN OUT UINTN                       *DataSize,
+  OUT    VOID                        *Data           OPTIONAL
+  )
+{
+  CHAR16        TempVariableName[MAX_VARIABLE_NAME_SIZE];
+  EFI_STATUS    Status;
+  UINTN         Index;
+  UINTN         VariableSize;
+  UINT8         *OffsetPtr;
+
+  if (*DataSize < (UINTN) Manifest->Header.TotalSize) {
+    *DataSize = (UINTN) Manifest->Header.TotalSize;
+    return EFI_BUFFER_TOO_SMALL;
+  }
+  if (Data == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  DEBUG ((DEBUG_VERBOSE, "GetLargeVariable: Reading %d Variables using the manifest\n", Manifest->Header.ChunkCount));
+  OffsetPtr = (UINT8 *) Data;
+  for (Index = 0; Index < Manifest->Header.ChunkCount; Index++) {
+    UnicodeSPrint (TempVariableName, sizeof (TempVariableName), L"%s%d", VariableName, Index);
+    VariableSize = Manifest->Chunk[Index].Size;
+    Status = VarLibGetVariable (TempVariableName, VendorGuid, NULL, &VariableSize, (VOID *) OffsetPtr);
+    if (EFI_ERROR (Status) || (VariableSize != Manifest->Chunk[Index].Size)) {
+      DEBUG ((DEBUG_WARN, "GetLargeVariable: %s does not match the manifest, Status = %r\n", TempVariableName, Status));
+      return EFI_VOLUME_CORRUPTED;
+    }
+    OffsetPtr += VariableSize;
+  }
+
+  if (CalculateCrc32 (Data, (UINTN) Manifest->Header.TotalSize) != Manifest->Header.Crc32) {
+    DEBUG ((DEBUG_WARN, "GetLargeVariable: CRC32 does not match the manifest\n"));
+    return EFI_VOLUME_CORRUPTED;
+  }
+
+  *DataSize = (UINTN) Manifest->Header.TotalSize;
+  return EFI_SUCCESS;
+}
+
 /**
   Returns the value of a large variable.
 
@@ -55,21 +171,33 @@ GetLargeVariable (
   OUT    VOID                        *Data           OPTIONAL
   )
 {
-  CHAR16        TempVariableName[MAX_VARIABLE_NAME_SIZE];
-  EFI_STATUS    Status;
-  UINTN         TotalSize;
-  UINTN         VarDataSize;
-  UINTN         Index;
-  UINTN         VariableSize;
-  UINTN         BytesRemaining;
-  UINT8         *OffsetPtr;
+  CHAR16                   TempVariableName[MAX_VARIABLE_NAME_SIZE];
+  EFI_STATUS               Status;
+  UINTN                    TotalSize;
+  UINTN                    VarDataSize;
+  UINTN                    Index;
+  UINTN                    VariableSize;
+  UINTN                    BytesRemaining;
+  UINT8                    *OffsetPtr;
+  LARGE_VARIABLE_MANIFEST  Manifest;
 
   VarDataSize = 0;
 
   //
-  // First check if a variable with the given name exists
+  // First check if a variable with the given name exists. When a buffer is
+  // given, read it right away instead of probing the size first.
   //
-  Status = VarLibGetVariable (VariableName, VendorGuid, NULL, &VarDataSize, NULL);
+  if ((Data != NULL) && (*DataSize != 0)) {
+    VarDataSize = *DataSize;
+    Status = VarLibGetVariable (VariableName, VendorGuid, NULL, &VarDataSize, Data);
+    if (!EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_VERBOSE, "GetLargeVariable: Single Variable Found\n"));
+      *DataSize = VarDataSize;
+      goto Done;
+    }
+  } else {
+    Status = VarLibGetVariable (VariableName, VendorGuid, NULL, &VarDataSize, NULL);
+  }
   if (Status == EFI_BUFFER_TOO_SMALL) {
     if (*DataSize >= VarDataSize) {
       if (Data == NULL) {
@@ -95,6 +223,18 @@ GetLargeVariable (
       goto Done;
     }
 
+    //
+    // Use the manifest if there is one. Fall back to probing the variables one
+    // by one if the variables do not match it.
+    //
+    Status = GetLargeVariableManifest (VariableName, VendorGuid, &Manifest);
+    if (!EFI_ERROR (Status)) {
+      Status = GetLargeVariableFromManifest (VariableName, VendorGuid, &Manifest, DataSize, Data);
+      if (Status != EFI_VOLUME_CORRUPTED) {
+        goto Done;
+      }
+    }
+
     VarDataSize = 0;
     Index       = 0;
     ZeroMem (TempVariableName, MAX_VARIABLE_NAME_SIZE);
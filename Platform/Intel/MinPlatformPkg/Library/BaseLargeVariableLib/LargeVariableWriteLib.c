@@ -19,6 +19,7 @@
 #include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
 #include <Library/PrintLib.h>
 #include <Library/VariableReadLib.h>
 #include <Library/VariableWriteLib.h>
@@ -118,6 +119,218 @@ GetVariableSplitSize (
   return VariableSplitSize;
 }
 
+/**
+  Builds the name of the manifest variable of a large variable.
+
+  @param[in]  VariableName       A Null-terminated string that is the name of the vendor's variable.
+  @param[out] ManifestName       Buffer of MAX_VARIABLE_NAME_SIZE characters receiving the name.
+
+  @retval EFI_SUCCESS            The name is built.
+  @retval EFI_OUT_OF_RESOURCES   The VariableName is too long to append the manifest suffix.
+
+**/
+STATIC
+EFI_STATUS
+GetLargeVariableManifestName (
+  IN  CHAR16                       *VariableName,
+  OUT CHAR16                       *ManifestName
+  )
+{
+  if (StrLen (VariableName) >= (MAX_VARIABLE_NAME_SIZE - LARGE_VARIABLE_MANIFEST_SUFFIX_LENGTH)) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+  UnicodeSPrint (ManifestName, MAX_VARIABLE_NAME_SIZE * sizeof (CHAR16), LARGE_VARIABLE_MANIFEST_NAME_FORMAT, VariableName);
+  return EFI_SUCCESS;
+}
+
+/**
+  Reads and validates the manifest of a large variable stored in multiple variables.
+
+  @param[in]  VariableName       A Null-terminated string that is the name of the vendor's variable.
+  @param[in]  VendorGuid         A unique identifier for the vendor.
+  @param[out] Manifest           The manifest read.
+
+  @retval EFI_SUCCESS            A valid manifest was read.
+  @retval EFI_NOT_FOUND          There is no valid manifest for the variable.
+
+**/
+STATIC
+EFI_STATUS
+GetLargeVariableManifest (
+  IN  CHAR16                       *VariableName,
+  IN  EFI_GUID                     *VendorGuid,
+  OUT LARGE_VARIABLE_MANIFEST      *Manifest
+  )
+{
+  CHAR16        ManifestName[MAX_VARIABLE_NAME_SIZE];
+  EFI_STATUS    Status;
+  UINTN         Size;
+  UINTN         Index;
+  UINT64        TotalSize;
+
+  if (EFI_ERROR (GetLargeVariableManifestName (VariableName, ManifestName))) {
+    return EFI_NOT_FOUND;
+  }
+
+  Size   = sizeof (LARGE_VARIABLE_MANIFEST);
+  Status = VarLibGetVariable (ManifestName, VendorGuid, NULL, &Size, Manifest);
+  if (EFI_ERROR (Status) ||
+      (Size < sizeof (LARGE_VARIABLE_MANIFEST_HEADER)) ||
+      (Manifest->Header.Signature != LARGE_VARIABLE_MANIFEST_SIGNATURE) ||
+      (Manifest->Header.ChunkCount == 0) ||
+      (Manifest->Header.ChunkCount > LARGE_VARIABLE_MANIFEST_MAX_CHUNKS) ||
+      (Size != LARGE_VARIABLE_MANIFEST_SIZE (Manifest->Header.ChunkCount))) {
+    return EFI_NOT_FOUND;
+  }
+
+  TotalSize = 0;
+  for (Index = 0; Index < Manifest->Header.ChunkCount; Index++) {
+    TotalSize += Manifest->Chunk[Index].Size;
+  }
+  if (TotalSize != Manifest->Header.TotalSize) {
+    return EFI_NOT_FOUND;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Writes or deletes the manifest of a large variable.
+
+  @param[in]  VariableName       A Null-terminated string that is the name of the vendor's variable.
+  @param[in]  VendorGuid         A unique identifier for the vendor.
+  @param[in]  Manifest           The manifest to write, NULL to delete the manifest.
+
+  @retval EFI_SUCCESS            The manifest is written or deleted.
+  @retval EFI_NOT_FOUND          The manifest to delete does not exist.
+  @retval Others                 The manifest could not be written or deleted.
+
+**/
+STATIC
+EFI_STATUS
+SetLargeVariableManifest (
+  IN  CHAR16                       *VariableName,
+  IN  EFI_GUID                     *VendorGuid,
+  IN  LARGE_VARIABLE_MANIFEST      *Manifest       OPTIONAL
+  )
+{
+  CHAR16        ManifestName[MAX_VARIABLE_NAME_SIZE];
+  EFI_STATUS    Status;
+
+  Status = GetLargeVariableManifestName (VariableName, ManifestName);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  return VarLibSetVariable (
+           ManifestName,
+           VendorGuid,
+           EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_RUNTIME_ACCESS,
+           (Manifest == NULL) ? 0 : LARGE_VARIABLE_MANIFEST_SIZE (Manifest->Header.ChunkCount),
+           Manifest
+           );
+}
+
+/**
+  Locks the manifest of a large variable if it exists.
+
+  @param[in]  VariableName       A Null-terminated string that is the name of the vendor's variable.
+  @param[in]  VendorGuid         A unique identifier for the vendor.
+
+  @retval EFI_SUCCESS            The manifest is locked or does not exist.
+  @retval EFI_ABORTED            Fail to lock the manifest.
+
+**/
+STATIC
+EFI_STATUS
+LockLargeVariableManifest (
+  IN  CHAR16                       *VariableName,
+  IN  EFI_GUID                     *VendorGuid
+  )
+{
+  CHAR16        ManifestName[MAX_VARIABLE_NAME_SIZE];
+  EFI_STATUS    Status;
+  UINTN         VariableSize;
+
+  if (EFI_ERROR (GetLargeVariableManifestName (VariableName, ManifestName))) {
+    return EFI_SUCCESS;
+  }
+
+  VariableSize = 0;
+  Status = VarLibGetVariable (ManifestName, VendorGuid, NULL, &VariableSize, NULL);
+  if (Status != EFI_BUFFER_TOO_SMALL) {
+    return EFI_SUCCESS;
+  }
+
+  DEBUG ((DEBUG_INFO, "Locking %s, Guid = %g\n", ManifestName, VendorGuid));
+  Status = VarLibVariableRequestToLock (ManifestName, VendorGuid);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "LockLargeVariableManifest: Failed! Satus = %r\n", Status));
+    return EFI_ABORTED;
+  }
+  return EFI_SUCCESS;
+}
+
+/**
+  Checks if a chunk of a large variable already holds the given data.
+
+  The CRC32 and size recorded in the old manifest rule out most changed chunks
+  without reading them, a chunk whose CRC32 matches is read back and compared.
+
+  @param[in]      VariableName   A Null-terminated string that is the name of the chunk variable.
+  @param[in]      VendorGuid     A unique identifier for the vendor.
+  @param[in]      OldManifest    The manifest of the stored data.
+  @param[in]      Index          Index of the chunk.
+  @param[in]      Data           The new content of the chunk.
+  @param[in]      Size           The size of the new content of the chunk.
+  @param[in]      Crc32          CRC32 of the new content of the chunk.
+  @param[in, out] CompareBuffer  Buffer to read the chunk into, allocated on first use.
+
+  @retval TRUE                   The chunk holds the data and does not need to be written.
+  @retval FALSE                  The chunk must be written.
+
+**/
+STATIC
+BOOLEAN
+IsLargeVariableChunkUnchanged (
+  IN     CHAR16                    *VariableName,
+  IN     EFI_GUID                  *VendorGuid,
+  IN     LARGE_VARIABLE_MANIFEST   *OldManifest,
+  IN     UINTN                     Index,
+  IN     VOID                      *Data,
+  IN     UINTN                     Size,
+  IN     UINT32                    Crc32,
+  IN OUT VOID                      **CompareBuffer
+  )
+{
+  EFI_STATUS    Status;
+  UINTN         VariableSize;
+
+  if ((Index >= OldManifest->Header.ChunkCount) ||
+      (OldManifest->Chunk[Index].Size != Size) ||
+      (OldManifest->Chunk[Index].Crc32 != Crc32)) {
+    return FALSE;
+  }
+
+  //
+  // Chunk sizes never grow with the index, a buffer of the first chunk size
+  // fits them all.
+  //
+  if (*CompareBuffer == NULL) {
+    *CompareBuffer = AllocatePool (MAX (Size, OldManifest->Chunk[0].Size));
+    if (*CompareBuffer == NULL) {
+      return FALSE;
+    }
+  }
+
+  VariableSize = Size;
+  Status = VarLibGetVariable (VariableName, VendorGuid, NULL, &VariableSize, *CompareBuffer);
+  if (EFI_ERROR (Status) || (VariableSize != Size)) {
+    return FALSE;
+  }
+  return (BOOLEAN) (CompareMem (*CompareBuffer, Data, Size) == 0);
+}
+
 /**
   Deletes a large variable.
 
@@ -186,9 +399,11 @@ DeleteLargeVariableInternal (
     if (Status == EFI_BUFFER_TOO_SMALL) {
 
       //
-      // The first variable exists. Delete all the variables.
+      // The first variable exists. Delete the manifest first so it never
+      // describes partially deleted data, then delete all the variables.
       //
       DEBUG ((DEBUG_VERBOSE, "DeleteLargeVariableInternal: Multiple Variables Found\n"));
+      SetLargeVariableManifest (VariableName, VendorGuid, NULL);
       Status = EFI_SUCCESS;
       for (Index = 0; Index < MAX_VARIABLE_SPLIT; Index++) {
         VarDataSize = 0;
@@ -259,18 +474,24 @@ SetLargeVariable (
   IN  VOID                         *Data
   )
 {
-  CHAR16        TempVariableName[MAX_VARIABLE_NAME_SIZE];
-  UINT64        VariableSplitSize;
-  UINT64        RemainingVariableStorage;
-  EFI_STATUS    Status;
-  EFI_STATUS    Status2;
-  UINTN         VariableNameLength;
-  UINTN         Index;
-  UINTN         VariablesSaved;
-  UINT8         *OffsetPtr;
-  UINTN         BytesRemaining;
-  UINTN         SizeToSave;
-  UINTN         BufferSize = 0;
+  CHAR16                   TempVariableName[MAX_VARIABLE_NAME_SIZE];
+  UINT64                   VariableSplitSize;
+  UINT64                   RemainingVariableStorage;
+  EFI_STATUS               Status;
+  EFI_STATUS               Status2;
+  UINTN                    VariableNameLength;
+  UINTN                    Index;
+  UINTN                    VariablesSaved;
+  UINT8                    *OffsetPtr;
+  UINTN                    BytesRemaining;
+  UINTN                    SizeToSave;
+  UINTN                    BufferSize = 0;
+  UINT32                   ChunkCrc32;
+  BOOLEAN                  HaveOldManifest;
+  BOOLEAN                  ManifestDeleted;
+  VOID                     *CompareBuffer;
+  LARGE_VARIABLE_MANIFEST  OldManifest;
+  LARGE_VARIABLE_MANIFEST  Manifest;
 
   //
   // Check input parameters.
@@ -288,7 +509,9 @@ SetLargeVariable (
     return EFI_INVALID_PARAMETER;
   }
 
-  VariablesSaved = 0;
+  VariablesSaved  = 0;
+  ManifestDeleted = FALSE;
+  CompareBuffer   = NULL;
   if (LockVariable && !VarLibIsVariableRequestToLockSupported ()) {
       Status = EFI_INVALID_PARAMETER;
       DEBUG ((DEBUG_ERROR, "SetLargeVariable: Variable locking is not currently supported\n"));
@@ -385,7 +608,22 @@ SetLargeVariable (
     VariablesSaved    = 0;
 
     //
-    // Store chunks of data in UEFI variables until all data is stored
+    // The manifest of the stored data tells which chunks may be unchanged. Pool
+    // allocation is needed to compare them, so skip this at OS runtime.
+    //
+    HaveOldManifest = FALSE;
+    if (!VarLibAtOsRuntime ()) {
+      HaveOldManifest = !EFI_ERROR (GetLargeVariableManifest (VariableName, VendorGuid, &OldManifest));
+    }
+    ZeroMem (&Manifest, sizeof (Manifest));
+    Manifest.Header.Signature = LARGE_VARIABLE_MANIFEST_SIGNATURE;
+    Manifest.Header.TotalSize = DataSize;
+    Manifest.Header.Crc32     = CalculateCrc32 (Data, DataSize);
+    Status                    = EFI_SUCCESS;
+
+    //
+    // Store chunks of data in UEFI variables until all data is stored. Chunks
+    // that already hold the same data are not written again.
     //
     for (Index = 0; (Index < MAX_VARIABLE_SPLIT) && (BytesRemaining > 0); Index++) {
       ZeroMem (TempVariableName, MAX_VARIABLE_NAME_SIZE);
@@ -405,23 +643,89 @@ SetLargeVariable (
       } else {
         SizeToSave = BytesRemaining;
       }
-      DEBUG ((DEBUG_INFO, "Saving %s, Guid = %g, Size %d\n", TempVariableName, VendorGuid, SizeToSave));
-      Status = VarLibSetVariable (
-                TempVariableName,
-                VendorGuid,
-                EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_RUNTIME_ACCESS,
-                SizeToSave,
-                (VOID *) OffsetPtr
-                );
-      if (EFI_ERROR (Status)) {
-        DEBUG ((DEBUG_ERROR, "SetLargeVariable: Error writting variable: Status = %r\n", Status));
-        goto Done;
+
+      ChunkCrc32 = CalculateCrc32 (OffsetPtr, SizeToSave);
+      if (Index < LARGE_VARIABLE_MANIFEST_MAX_CHUNKS) {
+        Manifest.Chunk[Index].Size  = (UINT32) SizeToSave;
+        Manifest.Chunk[Index].Crc32 = ChunkCrc32;
+      }
+      if (HaveOldManifest &&
+          IsLargeVariableChunkUnchanged (
+            TempVariableName,
+            VendorGuid,
+            &OldManifest,
+            Index,
+            OffsetPtr,
+            SizeToSave,
+            ChunkCrc32,
+            &CompareBuffer
+            )) {
+        DEBUG ((DEBUG_INFO, "Skipping unchanged %s, Guid = %g, Size %d\n", TempVariableName, VendorGuid, SizeToSave));
+      } else {
+        //
+        // Delete the manifest before the first write so it never describes
+        // partially written data.
+        //
+        if (!ManifestDeleted) {
+          SetLargeVariableManifest (VariableName, VendorGuid, NULL);
+          ManifestDeleted = TRUE;
+        }
+        DEBUG ((DEBUG_INFO, "Saving %s, Guid = %g, Size %d\n", TempVariableName, VendorGuid, SizeToSave));
+        Status = VarLibSetVariable (
+                  TempVariableName,
+                  VendorGuid,
+                  EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_RUNTIME_ACCESS,
+                  SizeToSave,
+                  (VOID *) OffsetPtr
+                  );
+        if (EFI_ERROR (Status)) {
+          DEBUG ((DEBUG_ERROR, "SetLargeVariable: Error writting variable: Status = %r\n", Status));
+          goto Done;
+        }
       }
       VariablesSaved++;
       BytesRemaining -= SizeToSave;
       OffsetPtr += SizeToSave;
     }   // End of for loop
 
+    //
+    // Delete the chunks of the old data beyond the end of the new data.
+    //
+    if (HaveOldManifest && (OldManifest.Header.ChunkCount > VariablesSaved)) {
+      if (!ManifestDeleted) {
+        SetLargeVariableManifest (VariableName, VendorGuid, NULL);
+        ManifestDeleted = TRUE;
+      }
+      for (Index = VariablesSaved; Index < OldManifest.Header.ChunkCount; Index++) {
+        ZeroMem (TempVariableName, MAX_VARIABLE_NAME_SIZE);
+        UnicodeSPrint (TempVariableName, MAX_VARIABLE_NAME_SIZE, L"%s%d", VariableName, Index);
+        DEBUG ((DEBUG_INFO, "Deleting %s, Guid = %g\n", TempVariableName, VendorGuid));
+        VarLibSetVariable (
+          TempVariableName,
+          VendorGuid,
+          EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_RUNTIME_ACCESS,
+          0,
+          NULL
+          );
+      }
+    }
+
+    //
+    // Write the manifest once all chunks are stored. It is only an accelerator,
+    // GetLargeVariable () still finds the data without it.
+    //
+    if (!HaveOldManifest || ManifestDeleted) {
+      if (VariablesSaved <= LARGE_VARIABLE_MANIFEST_MAX_CHUNKS) {
+        Manifest.Header.ChunkCount = (UINT32) VariablesSaved;
+        Status2 = SetLargeVariableManifest (VariableName, VendorGuid, &Manifest);
+        if (EFI_ERROR (Status2)) {
+          DEBUG ((DEBUG_WARN, "SetLargeVariable: Error writting manifest: Status = %r\n", Status2));
+        }
+      } else if (!ManifestDeleted) {
+        SetLargeVariableManifest (VariableName, VendorGuid, NULL);
+      }
+    }
+
     //
     // If the user requested that the variables be locked, lock them now that
     // all data is saved.
@@ -443,12 +747,24 @@ SetLargeVariable (
           goto Done;
         }
       }
+      Status = LockLargeVariableManifest (VariableName, VendorGuid);
+      if (EFI_ERROR (Status)) {
+        //
+        // Do not delete Variable when failed to lock. Caller is responsible to do this.
+        //
+        VariablesSaved = 0;
+        goto Done;
+      }
     }
   }
 
 Done:
+  if (CompareBuffer != NULL) {
+    FreePool (CompareBuffer);
+  }
   if (EFI_ERROR (Status) && VariablesSaved > 0) {
     DEBUG ((DEBUG_ERROR, "SetLargeVariable: An error was encountered, deleting variables with partially stored data\n"));
+    SetLargeVariableManifest (VariableName, VendorGuid, NULL);
     for (Index = 0; Index < VariablesSaved; Index++) {
       ZeroMem (TempVariableName, MAX_VARIABLE_NAME_SIZE);
       UnicodeSPrint (TempVariableName, MAX_VARIABLE_NAME_SIZE, L"%s%d", VariableName, Index);
@@ -547,8 +863,12 @@ LockLargeVariable (
     Status = VarLibGetVariable (TempVariableName, VendorGuid, NULL, &VariableSize, NULL);
     if (Status == EFI_BUFFER_TOO_SMALL) {
       //
-      // Lock first variable and continue to rest of the variables.
+      // Lock the manifest and the first variable, then continue to rest of the variables.
       //
+      Status = LockLargeVariableManifest (VariableName, VendorGuid);
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
       DEBUG ((DEBUG_INFO, "Locking %s, Guid = %g\n", TempVariableName, VendorGuid));
       Status = VarLibVariableRequestToLock (TempVariableName, VendorGuid);
       if (EFI_ERROR (Status)) {
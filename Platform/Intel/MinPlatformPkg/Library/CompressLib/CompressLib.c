@@ -7,6 +7,10 @@
   This sequence is further divided into Blocks and Huffman codings
   are applied to each Block.
 
+  Repeated strings are found with hash chains of bounded length and lazy
+  matching. The work buffers are allocated on the first call and kept for
+  the following ones.
+
   Copyright (c) 2007 - 2020, Intel Corporation. All rights reserved.<BR>
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -30,21 +34,27 @@
 //
 // Macro Definitions
 //
-typedef INT16             NODE;
 #define UINT8_BIT         8
 #define THRESHOLD         3
-#define INIT_CRC          0
 #define WNDBIT            13
 #define WNDSIZ            (1U << WNDBIT)
+#define WNDMASK           (WNDSIZ - 1)
 #define MAXMATCH          256
 #define BLKSIZ            (1U << 14)  // 16 * 1024U
-#define PERC_FLAG         0x8000U
 #define CODE_BIT          16
-#define NIL               0
-#define MAX_HASH_VAL      (3 * WNDSIZ + (WNDSIZ / 512 + 1) * MAX_UINT8)
-#define HASH(LoopVar7, LoopVar5)        ((LoopVar7) + ((LoopVar5) << (WNDBIT - 9)) + WNDSIZ * 2)
-#define CRCPOLY           0xA001
-#define UPDATE_CRC(LoopVar5)     mCrc = mCrcTable[(mCrc ^ (LoopVar5)) & 0xFF] ^ (mCrc >> UINT8_BIT)
+
+//
+// Hash chains of the match finder. A chain is searched at most MAX_CHAIN deep,
+// the search stops at a match of NICE_MATCH bytes, and no lazy match is tried
+// after a match of LAZY_MATCH bytes.
+//
+#define HASH_BIT          15
+#define HASH_SIZE         (1U << HASH_BIT)
+#define HASH3(Ptr)        ((((UINT32) (Ptr)[0] | ((UINT32) (Ptr)[1] << 8) | ((UINT32) (Ptr)[2] << 16)) * 0x9E3779B1U) >> (32 - HASH_BIT))
+#define HASH_NIL          0
+#define MAX_CHAIN         32
+#define NICE_MATCH        128
+#define LAZY_MATCH        32
 
 //
 // C: the Char&Len Set; P: the Position Set; T: the exTra Set
@@ -83,16 +93,11 @@ STATIC UINT8  *mDst;
 STATIC UINT8  *mSrcUpperLimit;
 STATIC UINT8  *mDstUpperLimit;
 
-STATIC UINT8  *mLevel;
-STATIC UINT8  *mText;
-STATIC UINT8  *mChildCount;
-STATIC UINT8  *mBuf;
+STATIC UINT8  *mBuf = NULL;
 STATIC UINT8  mCLen[NC];
 STATIC UINT8  mPTLen[NPT];
 STATIC UINT8  *mLen;
 STATIC INT16  mHeap[NC + 1];
-STATIC INT32  mRemainder;
-STATIC INT32  mMatchLen;
 STATIC INT32  mBitCount;
 STATIC INT32  mHeapSize;
 STATIC INT32  mTempInt32;
@@ -100,7 +105,6 @@ STATIC UINT32 mBufSiz = 0;
 STATIC UINT32 mOutputPos;
 STATIC UINT32 mOutputMask;
 STATIC UINT32 mSubBitBuf;
-STATIC UINT32 mCrc;
 STATIC UINT32 mCompSize;
 STATIC UINT32 mOrigSize;
 
@@ -109,52 +113,21 @@ STATIC UINT16 *mSortPtr;
 STATIC UINT16 mLenCnt[17];
 STATIC UINT16 mLeft[2 * NC - 1];
 STATIC UINT16 mRight[2 * NC - 1];
-STATIC UINT16 mCrcTable[MAX_UINT8 + 1];
 STATIC UINT16 mCFreq[2 * NC - 1];
 STATIC UINT16 mCCode[NC];
 STATIC UINT16 mPFreq[2 * NP - 1];
 STATIC UINT16 mPTCode[NPT];
 STATIC UINT16 mTFreq[2 * NT - 1];
 
-STATIC NODE   mPos;
-STATIC NODE   mMatchPos;
-STATIC NODE   mAvail;
-STATIC NODE   *mPosition;
-STATIC NODE   *mParent;
-STATIC NODE   *mPrev;
-STATIC NODE   *mNext = NULL;
+//
+// Hash chains, positions are stored plus one so that HASH_NIL ends a chain.
+// mHashHead holds the last position of each hash value and mHashPrev the
+// previous position with the same hash for the last WNDSIZ positions.
+//
+STATIC UINT32 *mHashHead = NULL;
+STATIC UINT32 *mHashPrev = NULL;
 INT32         mHuffmanDepth = 0;
 
-/**
-  Make a CRC table.
-
-**/
-VOID
-EFIAPI
-MakeCrcTable (
-  VOID
-  )
-{
-  UINT32  LoopVar1;
-
-  UINT32  LoopVar2;
-
-  UINT32  LoopVar4;
-
-  for (LoopVar1 = 0; LoopVar1 <= MAX_UINT8; LoopVar1++) {
-    LoopVar4 = LoopVar1;
-    for (LoopVar2 = 0; LoopVar2 < UINT8_BIT; LoopVar2++) {
-      if ((LoopVar4 & 1) != 0) {
-        LoopVar4 = (LoopVar4 >> 1) ^ CRCPOLY;
-      } else {
-        LoopVar4 >>= 1;
-      }
-    }
-
-    mCrcTable[LoopVar1] = (UINT16) LoopVar4;
-  }
-}
-
 /**
   Put a dword to output stream
 
@@ -185,6 +158,7 @@ PutDword (
 
 /**
   Allocate memory spaces for data structures used in compression process.
+  The buffers are kept for the following compressions once allocated.
 
   @retval EFI_SUCCESS           Memory was allocated successfully.
   @retval EFI_OUT_OF_RESOURCES  A memory allocation failed.
@@ -195,33 +169,34 @@ AllocateMemory (
   VOID
   )
 {
-  mText       = AllocateZeroPool (WNDSIZ * 2 + MAXMATCH);
-  mLevel      = AllocateZeroPool ((WNDSIZ + MAX_UINT8 + 1) * sizeof (*mLevel));
-  mChildCount = AllocateZeroPool ((WNDSIZ + MAX_UINT8 + 1) * sizeof (*mChildCount));
-  mPosition   = AllocateZeroPool ((WNDSIZ + MAX_UINT8 + 1) * sizeof (*mPosition));
-  mParent     = AllocateZeroPool (WNDSIZ * 2 * sizeof (*mParent));
-  mPrev       = AllocateZeroPool (WNDSIZ * 2 * sizeof (*mPrev));
-  mNext       = AllocateZeroPool ((MAX_HASH_VAL + 1) * sizeof (*mNext));
-
-  mBufSiz     = BLKSIZ;
-  mBuf        = AllocateZeroPool (mBufSiz);
-  while (mBuf == NULL) {
-    mBufSiz = (mBufSiz / 10U) * 9U;
-    if (mBufSiz < 4 * 1024U) {
-      return EFI_OUT_OF_RESOURCES;
-    }
+  if (mHashHead == NULL) {
+    mHashHead = AllocatePool (HASH_SIZE * sizeof (*mHashHead));
+  }
+  if (mHashPrev == NULL) {
+    mHashPrev = AllocatePool (WNDSIZ * sizeof (*mHashPrev));
+  }
+  if ((mHashHead == NULL) || (mHashPrev == NULL)) {
+    return EFI_OUT_OF_RESOURCES;
+  }
 
-    mBuf = AllocateZeroPool (mBufSiz);
+  if (mBuf == NULL) {
+    mBufSiz     = BLKSIZ;
+    mBuf        = AllocateZeroPool (mBufSiz);
+    while (mBuf == NULL) {
+      mBufSiz = (mBufSiz / 10U) * 9U;
+      if (mBufSiz < 4 * 1024U) {
+        return EFI_OUT_OF_RESOURCES;
+      }
+      mBuf = AllocateZeroPool (mBufSiz);
+    }
   }
 
   mBuf[0] = 0;
-
   return EFI_SUCCESS;
 }
 
 /**
-  Called when compression is completed to free memory previously allocated.
-
+  Called when compression failed to free memory previously allocated.
 **/
 VOID
 EFIAPI
@@ -229,18 +204,14 @@ FreeMemory (
   VOID
   )
 {
-  SHELL_FREE_NON_NULL (mText);
-  SHELL_FREE_NON_NULL (mLevel);
-  SHELL_FREE_NON_NULL (mChildCount);
-  SHELL_FREE_NON_NULL (mPosition);
-  SHELL_FREE_NON_NULL (mParent);
-  SHELL_FREE_NON_NULL (mPrev);
-  SHELL_FREE_NON_NULL (mNext);
+  SHELL_FREE_NON_NULL (mHashHead);
+  SHELL_FREE_NON_NULL (mHashPrev);
   SHELL_FREE_NON_NULL (mBuf);
+  mBufSiz = 0;
 }
 
 /**
-  Initialize String Info Log data structures.
+  Initialize the hash chains.
 **/
 VOID
 EFIAPI
@@ -248,403 +219,88 @@ InitSlide (
   VOID
   )
 {
-  NODE  LoopVar1;
-
-  SetMem (mLevel + WNDSIZ, (MAX_UINT8 + 1) * sizeof (UINT8), 1);
-  SetMem (mPosition + WNDSIZ, (MAX_UINT8 + 1) * sizeof (NODE), 0);
-
-  SetMem (mParent + WNDSIZ, WNDSIZ * sizeof (NODE), 0);
-
-  mAvail = 1;
-  for (LoopVar1 = 1; LoopVar1 < WNDSIZ - 1; LoopVar1++) {
-    mNext[LoopVar1] = (NODE) (LoopVar1 + 1);
-  }
-
-  mNext[WNDSIZ - 1] = NIL;
-  SetMem (mNext + WNDSIZ * 2, (MAX_HASH_VAL - WNDSIZ * 2 + 1) * sizeof (NODE), 0);
+  SetMem (mHashHead, HASH_SIZE * sizeof (*mHashHead), 0);
 }
 
 /**
-  Find child node given the parent node and the edge character
-
-  @param[in] LoopVar6       The parent node.
-  @param[in] LoopVar5       The edge character.
-
-  @return             The child node.
-  @retval NIL(Zero)   No child could be found.
-
-**/
-NODE
-EFIAPI
-Child (
-  IN NODE   LoopVar6,
-  IN UINT8  LoopVar5
-  )
-{
-  NODE  LoopVar4;
-
-  LoopVar4      = mNext[HASH (LoopVar6, LoopVar5)];
-  mParent[NIL]  = LoopVar6;  /* sentinel */
-  while (mParent[LoopVar4] != LoopVar6) {
-    LoopVar4 = mNext[LoopVar4];
-  }
-
-  return LoopVar4;
-}
-
-/**
-  Create a new child for a given parent node.
-
-  @param[in] LoopVar6       The parent node.
-  @param[in] LoopVar5       The edge character.
-  @param[in] LoopVar4       The child node.
+  Insert the string at a position into the hash chains.
 
+  @param[in] Pos      The position in the source data, at least THRESHOLD
+                      bytes must be available from it.
 **/
 VOID
 EFIAPI
-MakeChild (
-  IN NODE   LoopVar6,
-  IN UINT8  LoopVar5,
-  IN NODE   LoopVar4
+InsertHash (
+  IN UINT32 Pos
   )
 {
-  NODE  LoopVar12;
-
-  NODE  LoopVar10;
-
-  LoopVar12          = (NODE) HASH (LoopVar6, LoopVar5);
-  LoopVar10          = mNext[LoopVar12];
-  mNext[LoopVar12]   = LoopVar4;
-  mNext[LoopVar4]    = LoopVar10;
-  mPrev[LoopVar10]   = LoopVar4;
-  mPrev[LoopVar4]    = LoopVar12;
-  mParent[LoopVar4]  = LoopVar6;
-  mChildCount[LoopVar6]++;
+  UINT32  Hash;
+
+  Hash                      = HASH3 (mSrc + Pos);
+  mHashPrev[Pos & WNDMASK]  = mHashHead[Hash];
+  mHashHead[Hash]           = Pos + 1;
 }
 
 /**
-  Split a node.
+  Insert the string at a position into the hash chains and find the longest
+  earlier string matching it within the window.
 
-  @param[in] Old     The node to split.
+  @param[in]  Pos       The position in the source data, at least THRESHOLD
+                        bytes must be available from it.
+  @param[in]  MaxLen    The maximum length of the match.
+  @param[out] MatchPos  The position of the match found.
 
+  @return The length of the match found, less than THRESHOLD if none.
 **/
-VOID
+UINT32
 EFIAPI
-Split (
-  IN NODE Old
+InsertHashAndMatch (
+  IN  UINT32 Pos,
+  IN  UINT32 MaxLen,
+  OUT UINT32 *MatchPos
   )
 {
-  NODE  New;
-
-  NODE  LoopVar10;
-
-  New               = mAvail;
-  mAvail            = mNext[New];
-  mChildCount[New]  = 0;
-  LoopVar10         = mPrev[Old];
-  mPrev[New]        = LoopVar10;
-  mNext[LoopVar10]  = New;
-  LoopVar10         = mNext[Old];
-  mNext[New]        = LoopVar10;
-  mPrev[LoopVar10]  = New;
-  mParent[New]      = mParent[Old];
-  mLevel[New]       = (UINT8) mMatchLen;
-  mPosition[New]    = mPos;
-  MakeChild (New, mText[mMatchPos + mMatchLen], Old);
-  MakeChild (New, mText[mPos + mMatchLen], mPos);
-}
+  UINT32  Hash;
+  UINT32  Candidate;
+  UINT32  Limit;
+  UINT32  Chain;
+  UINT32  BestLen;
+  UINT32  Len;
+  UINT8   *Scan;
+  UINT8   *Match;
+
+  Hash                      = HASH3 (mSrc + Pos);
+  Candidate                 = mHashHead[Hash];
+  mHashPrev[Pos & WNDMASK]  = Candidate;
+  mHashHead[Hash]           = Pos + 1;
 
-/**
-  Insert string info for current position into the String Info Log.
-
-**/
-VOID
-EFIAPI
-InsertNode (
-  VOID
-  )
-{
-  NODE  LoopVar6;
-
-  NODE  LoopVar4;
-
-  NODE  LoopVar2;
-
-  NODE  LoopVar10;
-  UINT8 LoopVar5;
-  UINT8 *TempString3;
-  UINT8 *TempString2;
-
-  if (mMatchLen >= 4) {
-    //
-    // We have just got a long match, the target tree
-    // can be located by MatchPos + 1. Travese the tree
-    // from bottom up to get to a proper starting point.
-    // The usage of PERC_FLAG ensures proper node deletion
-    // in DeleteNode() later.
-    //
-    mMatchLen--;
-    LoopVar4 = (NODE) ((mMatchPos + 1) | WNDSIZ);
-    LoopVar6 = mParent[LoopVar4];
-    while (LoopVar6 == NIL) {
-      LoopVar4 = mNext[LoopVar4];
-      LoopVar6 = mParent[LoopVar4];
-    }
-
-    while (mLevel[LoopVar6] >= mMatchLen) {
-      LoopVar4 = LoopVar6;
-      LoopVar6 = mParent[LoopVar6];
-    }
-
-    LoopVar10 = LoopVar6;
-    while (mPosition[LoopVar10] < 0) {
-      mPosition[LoopVar10]  = mPos;
-      LoopVar10             = mParent[LoopVar10];
-    }
-
-    if (LoopVar10 < WNDSIZ) {
-      mPosition[LoopVar10] = (NODE) (mPos | PERC_FLAG);
-    }
-  } else {
-    //
-    // Locate the target tree
-    //
-    LoopVar6 = (NODE) (mText[mPos] + WNDSIZ);
-    LoopVar5 = mText[mPos + 1];
-    LoopVar4 = Child (LoopVar6, LoopVar5);
-    if (LoopVar4 == NIL) {
-      MakeChild (LoopVar6, LoopVar5, mPos);
-      mMatchLen = 1;
-      return;
-    }
-
-    mMatchLen = 2;
-  }
   //
-  // Traverse down the tree to find a match.
-  // Update Position value along the route.
-  // Node split or creation is involved.
+  // The position field of a pointer holds distances up to WNDSIZ - 1.
   //
-  for (;;) {
-    if (LoopVar4 >= WNDSIZ) {
-      LoopVar2  = MAXMATCH;
-      mMatchPos = LoopVar4;
-    } else {
-      LoopVar2  = mLevel[LoopVar4];
-      mMatchPos = (NODE) (mPosition[LoopVar4] & ~PERC_FLAG);
-    }
-
-    if (mMatchPos >= mPos) {
-      mMatchPos -= WNDSIZ;
-    }
-
-    TempString3 = &mText[mPos + mMatchLen];
-    TempString2 = &mText[mMatchPos + mMatchLen];
-    while (mMatchLen < LoopVar2) {
-      if (*TempString3 != *TempString2) {
-        Split (LoopVar4);
-        return;
+  Limit   = (Pos >= WNDSIZ) ? (Pos - WNDSIZ + 1) : 0;
+  BestLen = THRESHOLD - 1;
+  Scan    = mSrc + Pos;
+  for (Chain = MAX_CHAIN; (Candidate != HASH_NIL) && (Candidate - 1 >= Limit) && (Chain > 0); Chain--) {
+    Match = mSrc + Candidate - 1;
+    //
+    // Only a string longer than the best one so far is of interest, check
+    // its last byte first.
+    //
+    if ((Match[BestLen] == Scan[BestLen]) && (Match[0] == Scan[0])) {
+      for (Len = 1; (Len < MaxLen) && (Match[Len] == Scan[Len]); Len++) {
+      }
+      if (Len > BestLen) {
+        BestLen   = Len;
+        *MatchPos = Candidate - 1;
+        if (Len >= NICE_MATCH || Len >= MaxLen) {
+          break;
+        }
       }
-
-      mMatchLen++;
-      TempString3++;
-      TempString2++;
-    }
-
-    if (mMatchLen >= MAXMATCH) {
-      break;
-    }
-
-    mPosition[LoopVar4]  = mPos;
-    LoopVar6             = LoopVar4;
-    LoopVar4             = Child (LoopVar6, *TempString3);
-    if (LoopVar4 == NIL) {
-      MakeChild (LoopVar6, *TempString3, mPos);
-      return;
-    }
-
-    mMatchLen++;
-  }
-
-  LoopVar10             = mPrev[LoopVar4];
-  mPrev[mPos]           = LoopVar10;
-  mNext[LoopVar10]      = mPos;
-  LoopVar10             = mNext[LoopVar4];
-  mNext[mPos]           = LoopVar10;
-  mPrev[LoopVar10]      = mPos;
-  mParent[mPos]         = LoopVar6;
-  mParent[LoopVar4]     = NIL;
-
-  //
-  // Special usage of 'next'
-  //
-  mNext[LoopVar4] = mPos;
-
-}
-
-/**
-  Delete outdated string info. (The Usage of PERC_FLAG
-  ensures a clean deletion).
-
-**/
-VOID
-EFIAPI
-DeleteNode (
-  VOID
-  )
-{
-  NODE  LoopVar6;
-
-  NODE  LoopVar4;
-
-  NODE  LoopVar11;
-
-  NODE  LoopVar10;
-
-  NODE  LoopVar9;
-
-  if (mParent[mPos] == NIL) {
-    return;
-  }
-
-  LoopVar4             = mPrev[mPos];
-  LoopVar11            = mNext[mPos];
-  mNext[LoopVar4]      = LoopVar11;
-  mPrev[LoopVar11]     = LoopVar4;
-  LoopVar4             = mParent[mPos];
-  mParent[mPos]        = NIL;
-  if (LoopVar4 >= WNDSIZ) {
-    return;
-  }
-
-  mChildCount[LoopVar4]--;
-  if (mChildCount[LoopVar4] > 1) {
-    return;
-  }
-
-  LoopVar10 = (NODE) (mPosition[LoopVar4] & ~PERC_FLAG);
-  if (LoopVar10 >= mPos) {
-    LoopVar10 -= WNDSIZ;
-  }
-
-  LoopVar11 = LoopVar10;
-  LoopVar6 = mParent[LoopVar4];
-  LoopVar9 = mPosition[LoopVar6];
-  while ((LoopVar9 & PERC_FLAG) != 0) {
-    LoopVar9 &= ~PERC_FLAG;
-    if (LoopVar9 >= mPos) {
-      LoopVar9 -= WNDSIZ;
-    }
-
-    if (LoopVar9 > LoopVar11) {
-      LoopVar11 = LoopVar9;
-    }
-
-    mPosition[LoopVar6]  = (NODE) (LoopVar11 | WNDSIZ);
-    LoopVar6             = mParent[LoopVar6];
-    LoopVar9             = mPosition[LoopVar6];
-  }
-
-  if (LoopVar6 < WNDSIZ) {
-    if (LoopVar9 >= mPos) {
-      LoopVar9 -= WNDSIZ;
-    }
-
-    if (LoopVar9 > LoopVar11) {
-      LoopVar11 = LoopVar9;
-    }
-
-    mPosition[LoopVar6] = (NODE) (LoopVar11 | WNDSIZ | PERC_FLAG);
-  }
-
-  LoopVar11           = Child (LoopVar4, mText[LoopVar10 + mLevel[LoopVar4]]);
-  LoopVar10           = mPrev[LoopVar11];
-  LoopVar9            = mNext[LoopVar11];
-  mNext[LoopVar10]    = LoopVar9;
-  mPrev[LoopVar9]     = LoopVar10;
-  LoopVar10           = mPrev[LoopVar4];
-  mNext[LoopVar10]    = LoopVar11;
-  mPrev[LoopVar11]    = LoopVar10;
-  LoopVar10           = mNext[LoopVar4];
-  mPrev[LoopVar10]    = LoopVar11;
-  mNext[LoopVar11]    = LoopVar10;
-  mParent[LoopVar11]  = mParent[LoopVar4];
-  mParent[LoopVar4]   = NIL;
-  mNext[LoopVar4]     = mAvail;
-  mAvail              = LoopVar4;
-}
-
-/**
-  Read in source data
-
-  @param[out] LoopVar7   The buffer to hold the data.
-  @param[in] LoopVar8    The number of bytes to read.
-
-  @return The number of bytes actually read.
-
-**/
-INT32
-EFIAPI
-FreadCrc (
-  OUT UINT8 *LoopVar7,
-  IN  INT32 LoopVar8
-  )
-{
-  INT32 LoopVar1;
-
-  for (LoopVar1 = 0; mSrc < mSrcUpperLimit && LoopVar1 < LoopVar8; LoopVar1++) {
-    *LoopVar7++ = *mSrc++;
-  }
-
-  LoopVar8 = LoopVar1;
-
-  LoopVar7 -= LoopVar8;
-  mOrigSize += LoopVar8;
-  LoopVar1--;
-  while (LoopVar1 >= 0) {
-    UPDATE_CRC (*LoopVar7++);
-    LoopVar1--;
-  }
-
-  return LoopVar8;
-}
-
-/**
-  Advance the current position (read in new data if needed).
-  Delete outdated string info. Find a match string for current position.
-
-  @retval TRUE      The operation was successful.
-  @retval FALSE     The operation failed due to insufficient memory.
-
-**/
-BOOLEAN
-EFIAPI
-GetNextMatch (
-  VOID
-  )
-{
-  INT32 LoopVar8;
-  VOID  *Temp;
-
-  mRemainder--;
-  mPos++;
-  if (mPos == WNDSIZ * 2) {
-    Temp = AllocateZeroPool (WNDSIZ + MAXMATCH);
-    if (Temp == NULL) {
-      return (FALSE);
     }
-    CopyMem (Temp, &mText[WNDSIZ], WNDSIZ + MAXMATCH);
-    CopyMem (&mText[0], Temp, WNDSIZ + MAXMATCH);
-    FreePool (Temp);
-    LoopVar8 = FreadCrc (&mText[WNDSIZ + MAXMATCH], WNDSIZ);
-    mRemainder += LoopVar8;
-    mPos = WNDSIZ;
+    Candidate = mHashPrev[(Candidate - 1) & WNDMASK];
   }
 
-  DeleteNode ();
-  InsertNode ();
-
-  return (TRUE);
+  return BestLen;
 }
 
 /**
@@ -1277,6 +933,9 @@ HufEncodeEnd (
 /**
   The main controlling routine for compression process.
 
+  A match found at a position is only output if the next position does not
+  start a longer one (lazy matching).
+
   @retval EFI_SUCCESS           The compression is successful.
   @retval EFI_OUT_0F_RESOURCES  Not enough memory for compression process.
 **/
@@ -1287,8 +946,15 @@ Encode (
   )
 {
   EFI_STATUS  Status;
-  INT32       LastMatchLen;
-  NODE        LastMatchPos;
+  UINT32      Size;
+  UINT32      Pos;
+  UINT32      End;
+  UINT32      MaxLen;
+  UINT32      MatchLen;
+  UINT32      MatchPos;
+  UINT32      PrevLen;
+  UINT32      PrevPos;
+  BOOLEAN     PrevAvailable;
 
   Status = AllocateMemory ();
   if (EFI_ERROR (Status)) {
@@ -1297,57 +963,65 @@ Encode (
   }
 
   InitSlide ();
-
   HufEncodeStart ();
 
-  mRemainder  = FreadCrc (&mText[WNDSIZ], WNDSIZ + MAXMATCH);
-
-  mMatchLen   = 0;
-  mPos        = WNDSIZ;
-  InsertNode ();
-  if (mMatchLen > mRemainder) {
-    mMatchLen = mRemainder;
-  }
+  Size          = (UINT32) (mSrcUpperLimit - mSrc);
+  mOrigSize     = Size;
+  Pos           = 0;
+  PrevLen       = 0;
+  PrevPos       = 0;
+  MatchPos      = 0;
+  PrevAvailable = FALSE;
 
-  while (mRemainder > 0) {
-    LastMatchLen = mMatchLen;
-    LastMatchPos = mMatchPos;
-    if (!GetNextMatch ()) {
-      Status = EFI_OUT_OF_RESOURCES;
-    }
-    if (mMatchLen > mRemainder) {
-      mMatchLen = mRemainder;
+  for (;;) {
+    MatchLen = 0;
+    if (Size - Pos >= THRESHOLD) {
+      if (PrevLen < LAZY_MATCH) {
+        MaxLen   = MIN (Size - Pos, MAXMATCH);
+        MatchLen = InsertHashAndMatch (Pos, MaxLen, &MatchPos);
+      } else {
+        InsertHash (Pos);
+      }
     }
 
-    if (mMatchLen > LastMatchLen || LastMatchLen < THRESHOLD) {
-      //
-      // Not enough benefits are gained by outputting a pointer,
-      // so just output the original character
-      //
-      CompressOutput (mText[mPos - 1], 0);
-    } else {
+    if (PrevAvailable && (PrevLen >= THRESHOLD) && (MatchLen <= PrevLen)) {
       //
-      // Outputting a pointer is beneficial enough, do it.
+      // The match at the previous position is at least as long, output it
+      // and insert the strings it covers.
       //
-
-      CompressOutput (LastMatchLen + (MAX_UINT8 + 1 - THRESHOLD),
-        (mPos - LastMatchPos - 2) & (WNDSIZ - 1));
-      LastMatchLen--;
-      while (LastMatchLen > 0) {
-        if (!GetNextMatch ()) {
-          Status = EFI_OUT_OF_RESOURCES;
+      CompressOutput (
+        PrevLen + (MAX_UINT8 + 1 - THRESHOLD),
+        (Pos - 1 - PrevPos - 1) & WNDMASK
+        );
+      End = Pos - 1 + PrevLen;
+      for (Pos++; Pos < End; Pos++) {
+        if (Size - Pos >= THRESHOLD) {
+          InsertHash (Pos);
         }
-        LastMatchLen--;
       }
+      PrevAvailable = FALSE;
+      PrevLen       = 0;
+      continue;
+    }
 
-      if (mMatchLen > mRemainder) {
-        mMatchLen = mRemainder;
-      }
+    if (PrevAvailable) {
+      //
+      // Not enough benefits are gained by outputting a pointer,
+      // so just output the original character
+      //
+      CompressOutput (mSrc[Pos - 1], 0);
+    }
+    if (Pos >= Size) {
+      break;
     }
+
+    PrevAvailable = TRUE;
+    PrevLen       = MatchLen;
+    PrevPos       = MatchPos;
+    Pos++;
   }
 
   HufEncodeEnd ();
-  FreeMemory ();
   return (Status);
 }
 
@@ -1362,6 +1036,7 @@ Encode (
 
   @retval EFI_SUCCESS           The compression was sucessful.
   @retval EFI_BUFFER_TOO_SMALL  The buffer was too small.  DstSize is required.
+  @retval EFI_INVALID_PARAMETER SrcSize does not fit in the 32 bit size field.
 **/
 EFI_STATUS
 EFIAPI
@@ -1377,15 +1052,9 @@ Compress (
   //
   // Initializations
   //
-  mBufSiz         = 0;
-  mBuf            = NULL;
-  mText           = NULL;
-  mLevel          = NULL;
-  mChildCount     = NULL;
-  mPosition       = NULL;
-  mParent         = NULL;
-  mPrev           = NULL;
-  mNext           = NULL;
+  if (SrcSize > MAX_UINT32) {
+    return EFI_INVALID_PARAMETER;
+  }
 
   mSrc            = SrcBuffer;
   mSrcUpperLimit  = mSrc + SrcSize;
@@ -1395,10 +1064,7 @@ Compress (
   PutDword (0L);
   PutDword (0L);
 
-  MakeCrcTable ();
-
   mOrigSize       = mCompSize = 0;
-  mCrc            = INIT_CRC;
 
   //
   // Compress it
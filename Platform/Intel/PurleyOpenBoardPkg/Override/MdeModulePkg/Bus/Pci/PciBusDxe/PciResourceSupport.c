@@ -84,7 +84,8 @@ SkipIsaAliasAperture (
 
 /**
   This function inserts a resource node into the resource list.
-  The resource list is sorted in descend order.
+  The resource list is sorted by SortResourceNode() in descend order
+  when the aperture of the bridge is calculated.
 
   @param Bridge  PCI resource node for bridge.
   @param ResNode Resource node want to be inserted.
@@ -96,34 +97,160 @@ InsertResourceNode (
   IN     PCI_RESOURCE_NODE   *ResNode
   )
 {
-  LIST_ENTRY        *CurrentLink;
-  PCI_RESOURCE_NODE *Temp;
-  UINT64            ResNodeAlignRest;
-  UINT64            TempAlignRest;
-
   ASSERT (Bridge  != NULL);
   ASSERT (ResNode != NULL);
 
-  InsertHeadList (&Bridge->ChildList, &ResNode->Link);
+  InsertTailList (&Bridge->ChildList, &ResNode->Link);
+}
 
-  CurrentLink = Bridge->ChildList.ForwardLink->ForwardLink;
-  while (CurrentLink != &Bridge->ChildList) {
-    Temp = RESOURCE_NODE_FROM_LINK (CurrentLink);
+/**
+  This function checks whether a resource node has to be placed after another
+  one in a resource list sorted in descend order.
 
-    if (ResNode->Alignment > Temp->Alignment) {
-      break;
-    } else if (ResNode->Alignment == Temp->Alignment) {
-      ResNodeAlignRest  = ResNode->Length & ResNode->Alignment;
-      TempAlignRest     = Temp->Length & Temp->Alignment;
-      if ((ResNodeAlignRest == 0) || (ResNodeAlignRest >= TempAlignRest)) {
-        break;
+  Nodes are sorted by alignment. Among the nodes of the same alignment, the ones
+  whose length is a multiple of the alignment come first and the others follow
+  in descend order of the remainder, so that the node leaving the largest gap is
+  the last one and the following nodes with smaller alignment can use that gap.
+
+  @param Node1   Resource node to check.
+  @param Node2   Resource node to compare with.
+
+  @retval TRUE   Node1 has to be placed after Node2.
+  @retval FALSE  Node1 can be placed before Node2.
+
+**/
+BOOLEAN
+IsResourceNodeAfter (
+  IN PCI_RESOURCE_NODE       *Node1,
+  IN PCI_RESOURCE_NODE       *Node2
+  )
+{
+  UINT64            Node1AlignRest;
+  UINT64            Node2AlignRest;
+
+  if (Node1->Alignment != Node2->Alignment) {
+    return (BOOLEAN) (Node1->Alignment < Node2->Alignment);
+  }
+
+  Node1AlignRest = Node1->Length & Node1->Alignment;
+  Node2AlignRest = Node2->Length & Node2->Alignment;
+  if (Node1AlignRest == 0) {
+    return FALSE;
+  }
+  if (Node2AlignRest == 0) {
+    return TRUE;
+  }
+  return (BOOLEAN) (Node1AlignRest < Node2AlignRest);
+}
+
+/**
+  This function sorts the resource list of a bridge in descend order.
+
+  The nodes are collected into an array and merge sorted once, instead of
+  being sorted one by one into the list when they are inserted. Nodes that
+  compare equal keep the order of their insertion.
+
+  @param Bridge  PCI resource node for bridge.
+
+**/
+VOID
+SortResourceNode (
+  IN OUT PCI_RESOURCE_NODE   *Bridge
+  )
+{
+  LIST_ENTRY        *CurrentLink;
+  LIST_ENTRY        *PreviousLink;
+  PCI_RESOURCE_NODE **Buffer;
+  PCI_RESOURCE_NODE **Source;
+  PCI_RESOURCE_NODE **Target;
+  PCI_RESOURCE_NODE **Swap;
+  PCI_RESOURCE_NODE *Node;
+  UINTN             Count;
+  UINTN             Width;
+  UINTN             Left;
+  UINTN             Middle;
+  UINTN             Right;
+  UINTN             Index;
+  UINTN             Index1;
+  UINTN             Index2;
+  BOOLEAN           Sorted;
+
+  ASSERT (Bridge != NULL);
+
+  Count  = 0;
+  Sorted = TRUE;
+  for ( CurrentLink = GetFirstNode (&Bridge->ChildList)
+      ; !IsNull (&Bridge->ChildList, CurrentLink)
+      ; CurrentLink = GetNextNode (&Bridge->ChildList, CurrentLink)
+      ) {
+    if ((Count != 0) &&
+        IsResourceNodeAfter (RESOURCE_NODE_FROM_LINK (CurrentLink->BackLink), RESOURCE_NODE_FROM_LINK (CurrentLink))) {
+      Sorted = FALSE;
+    }
+    Count++;
+  }
+
+  if (Sorted) {
+    return;
+  }
+
+  Buffer = AllocatePool (2 * Count * sizeof (PCI_RESOURCE_NODE *));
+  if (Buffer == NULL) {
+    //
+    // Sort the list in place if the arrays cannot be allocated
+    //
+    CurrentLink = Bridge->ChildList.ForwardLink->ForwardLink;
+    while (CurrentLink != &Bridge->ChildList) {
+      Node         = RESOURCE_NODE_FROM_LINK (CurrentLink);
+      CurrentLink  = CurrentLink->ForwardLink;
+      PreviousLink = Node->Link.BackLink;
+      while ((PreviousLink != &Bridge->ChildList) &&
+             IsResourceNodeAfter (RESOURCE_NODE_FROM_LINK (PreviousLink), Node)) {
+        PreviousLink = PreviousLink->BackLink;
+      }
+      if (PreviousLink != Node->Link.BackLink) {
+        RemoveEntryList (&Node->Link);
+        InsertHeadList (PreviousLink, &Node->Link);
       }
     }
+    return;
+  }
 
-    SwapListEntries (&ResNode->Link, CurrentLink);
+  Source = Buffer;
+  Target = Buffer + Count;
+  Index  = 0;
+  for ( CurrentLink = GetFirstNode (&Bridge->ChildList)
+      ; !IsNull (&Bridge->ChildList, CurrentLink)
+      ; CurrentLink = GetNextNode (&Bridge->ChildList, CurrentLink)
+      ) {
+    Source[Index++] = RESOURCE_NODE_FROM_LINK (CurrentLink);
+  }
 
-    CurrentLink = ResNode->Link.ForwardLink;
+  for (Width = 1; Width < Count; Width *= 2) {
+    for (Left = 0; Left < Count; Left += 2 * Width) {
+      Middle = MIN (Left + Width, Count);
+      Right  = MIN (Left + 2 * Width, Count);
+      Index1 = Left;
+      Index2 = Middle;
+      for (Index = Left; Index < Right; Index++) {
+        if ((Index1 < Middle) && ((Index2 == Right) || !IsResourceNodeAfter (Source[Index1], Source[Index2]))) {
+          Target[Index] = Source[Index1++];
+        } else {
+          Target[Index] = Source[Index2++];
+        }
+      }
+    }
+    Swap   = Source;
+    Source = Target;
+    Target = Swap;
+  }
+
+  InitializeListHead (&Bridge->ChildList);
+  for (Index = 0; Index < Count; Index++) {
+    InsertTailList (&Bridge->ChildList, &Source[Index]->Link);
   }
+
+  FreePool (Buffer);
 }
 
 /**
@@ -345,6 +472,11 @@ CalculateResourceAperture (
     return ;
   }
 
+  //
+  // The children are placed in descend order of alignment
+  //
+  SortResourceNode (Bridge);
+
   if (Bridge->ResType == PciBarTypeIo16) {
 
     CalculateApertureIo16 (Bridge);
@@ -62,7 +62,8 @@ SkipIsaAliasAperture (
 
 /**
   This function inserts a resource node into the resource list.
-  The resource list is sorted in descend order.
+  The resource list is sorted by SortResourceNode() in descend order
+  when the aperture of the bridge is calculated.
 
   @param Bridge  PCI resource node for bridge.
   @param ResNode Resource node want to be inserted.
@@ -74,6 +75,34 @@ InsertResourceNode (
   IN     PCI_RESOURCE_NODE   *ResNode
   );
 
+/**
+  This function checks whether a resource node has to be placed after another
+  one in a resource list sorted in descend order.
+
+  @param Node1   Resource node to check.
+  @param Node2   Resource node to compare with.
+
+  @retval TRUE   Node1 has to be placed after Node2.
+  @retval FALSE  Node1 can be placed before Node2.
+
+**/
+BOOLEAN
+IsResourceNodeAfter (
+  IN PCI_RESOURCE_NODE       *Node1,
+  IN PCI_RESOURCE_NODE       *Node2
+  );
+
+/**
+  This function sorts the resource list of a bridge in descend order.
+
+  @param Bridge  PCI resource node for bridge.
+
+**/
+VOID
+SortResourceNode (
+  IN OUT PCI_RESOURCE_NODE   *Bridge
+  );
+
 /**
   This routine is used to merge two different resource trees in need of
   resource degradation.
@@ -340,6 +340,15 @@ SetupVariables (
     ASSERT_EFI_ERROR (Status);
   }
 
+  Size = sizeof (UINT32);
+  Status = gRT->GetVariable (L"MmcDisableSetBlockCount",
+                  &gConfigDxeFormSetGuid,
+                  NULL, &Size, &Var32);
+  if (EFI_ERROR (Status)) {
+    Status = PcdSet32S (PcdMmcDisableSetBlockCount, PcdGet32 (PcdMmcDisableSetBlockCount));
+    ASSERT_EFI_ERROR (Status);
+  }
+
   Size = sizeof (UINT32);
   Status = gRT->GetVariable (L"MmcForce1Bit",
                   &gConfigDxeFormSetGuid,
@@ -107,17 +107,35 @@ MMC_HOST_INSTANCE* CreateMmcHostInstance (
   MmcHostInstance->BlockIo.WriteBlocks = MmcWriteBlocks;
   MmcHostInstance->BlockIo.FlushBlocks = MmcFlushBlocks;
 
+  MmcHostInstance->BlockIo2.Media = MmcHostInstance->BlockIo.Media;
+  MmcHostInstance->BlockIo2.Reset = MmcResetEx;
+  MmcHostInstance->BlockIo2.ReadBlocksEx = MmcReadBlocksEx;
+  MmcHostInstance->BlockIo2.WriteBlocksEx = MmcWriteBlocksEx;
+  MmcHostInstance->BlockIo2.FlushBlocksEx = MmcFlushBlocksEx;
+
+  InitializeListHead (&MmcHostInstance->Queue);
+  Status = gBS->CreateEvent (
+                  EVT_NOTIFY_SIGNAL,
+                  TPL_CALLBACK,
+                  MmcProcessQueue,
+                  MmcHostInstance,
+                  &MmcHostInstance->QueueEvent
+                );
+  if (EFI_ERROR (Status)) {
+    goto FREE_MEDIA;
+  }
+
   MmcHostInstance->MmcHost = MmcHost;
 
   // Create DevicePath for the new MMC Host
   Status = MmcHost->BuildDevicePath (MmcHost, &NewDevicePathNode);
   if (EFI_ERROR (Status)) {
-    goto FREE_MEDIA;
+    goto FREE_EVENT;
   }
 
   DevicePath = (EFI_DEVICE_PATH_PROTOCOL*)AllocatePool (END_DEVICE_PATH_LENGTH);
   if (DevicePath == NULL) {
-    goto FREE_MEDIA;
+    goto FREE_EVENT;
   }
 
   SetDevicePathEndNode (DevicePath);
@@ -127,6 +145,7 @@ MMC_HOST_INSTANCE* CreateMmcHostInstance (
   Status = gBS->InstallMultipleProtocolInterfaces (
                   &MmcHostInstance->MmcHandle,
                   &gEfiBlockIoProtocolGuid, &MmcHostInstance->BlockIo,
+                  &gEfiBlockIo2ProtocolGuid, &MmcHostInstance->BlockIo2,
                   &gEfiDevicePathProtocolGuid, MmcHostInstance->DevicePath,
                   NULL
                 );
@@ -139,6 +158,9 @@ MMC_HOST_INSTANCE* CreateMmcHostInstance (
 FREE_DEVICE_PATH:
   FreePool (DevicePath);
 
+FREE_EVENT:
+  gBS->CloseEvent (MmcHostInstance->QueueEvent);
+
 FREE_MEDIA:
   FreePool (MmcHostInstance->BlockIo.Media);
 
@@ -153,16 +175,23 @@ EFI_STATUS DestroyMmcHostInstance (
   )
 {
   EFI_STATUS Status;
+  EFI_TPL    OldTpl;
 
   // Uninstall Protocol Interfaces
   Status = gBS->UninstallMultipleProtocolInterfaces (
                   MmcHostInstance->MmcHandle,
                   &gEfiBlockIoProtocolGuid, &(MmcHostInstance->BlockIo),
+                  &gEfiBlockIo2ProtocolGuid, &(MmcHostInstance->BlockIo2),
                   &gEfiDevicePathProtocolGuid, MmcHostInstance->DevicePath,
                   NULL
                 );
   ASSERT_EFI_ERROR (Status);
 
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+  MmcAbortRequests (MmcHostInstance, EFI_ABORTED);
+  gBS->RestoreTPL (OldTpl);
+  gBS->CloseEvent (MmcHostInstance->QueueEvent);
+
   // Free Memory allocated for the instance
   if (MmcHostInstance->BlockIo.Media) {
     FreePool (MmcHostInstance->BlockIo.Media);
@@ -373,6 +402,8 @@ CheckCardsCallback (
           MmcHostInstance->Initialized = !MmcHostInstance->Initialized;
           continue;
         }
+      } else {
+        MmcAbortRequests (MmcHostInstance, EFI_NO_MEDIA);
       }
 
       Status = gBS->ReinstallProtocolInterface (
@@ -385,6 +416,17 @@ CheckCardsCallback (
       if (EFI_ERROR (Status)) {
         Print (L"MMC Card: Error reinstalling BlockIo interface\n");
       }
+
+      Status = gBS->ReinstallProtocolInterface (
+                      (MmcHostInstance->MmcHandle),
+                      &gEfiBlockIo2ProtocolGuid,
+                      &(MmcHostInstance->BlockIo2),
+                      &(MmcHostInstance->BlockIo2)
+                    );
+
+      if (EFI_ERROR (Status)) {
+        Print (L"MMC Card: Error reinstalling BlockIo2 interface\n");
+      }
     }
 
     CurrentLink = CurrentLink->ForwardLink;
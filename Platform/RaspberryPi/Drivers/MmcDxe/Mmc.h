@@ -15,6 +15,7 @@
 
 #include <Protocol/DiskIo.h>
 #include <Protocol/BlockIo.h>
+#include <Protocol/BlockIo2.h>
 #include <Protocol/DevicePath.h>
 #include <Protocol/RpiMmcHost.h>
 
@@ -45,6 +46,9 @@
 
 #define MMC_R0_READY_FOR_DATA               (1 << 8)
 
+/* Card status error bits: 31-26 and 24-19, CARD_IS_LOCKED (25) is not an error */
+#define MMC_R0_ERROR_MASK                   0xFDF80000
+
 #define MMC_R0_CURRENTSTATE(Response)       ((Response[0] >> 9) & 0xF)
 
 #define MMC_R0_STATE_IDLE       0
@@ -328,6 +332,7 @@ typedef struct {
   CID       CIDData;
   CSD       CSDData;
   ECSD      *ECSDData;                         // MMC V4 extended card specific
+  BOOLEAN   Cmd23Supported;                    // SET_BLOCK_COUNT supported
 } CARD_INFO;
 
 typedef struct _MMC_HOST_INSTANCE {
@@ -338,14 +343,22 @@ typedef struct _MMC_HOST_INSTANCE {
 
   MMC_STATE                 State;
   EFI_BLOCK_IO_PROTOCOL     BlockIo;
+  EFI_BLOCK_IO2_PROTOCOL    BlockIo2;
   CARD_INFO                 CardInfo;
   EFI_MMC_HOST_PROTOCOL     *MmcHost;
 
   BOOLEAN                   Initialized;
+
+  //
+  // Pending EFI_BLOCK_IO2 requests, drained by QueueEvent.
+  //
+  LIST_ENTRY                Queue;
+  EFI_EVENT                 QueueEvent;
 } MMC_HOST_INSTANCE;
 
 #define MMC_HOST_INSTANCE_SIGNATURE                 SIGNATURE_32('m', 'm', 'c', 'h')
 #define MMC_HOST_INSTANCE_FROM_BLOCK_IO_THIS(a)     CR (a, MMC_HOST_INSTANCE, BlockIo, MMC_HOST_INSTANCE_SIGNATURE)
+#define MMC_HOST_INSTANCE_FROM_BLOCK_IO2_THIS(a)    CR (a, MMC_HOST_INSTANCE, BlockIo2, MMC_HOST_INSTANCE_SIGNATURE)
 #define MMC_HOST_INSTANCE_FROM_LINK(a)              CR (a, MMC_HOST_INSTANCE, Link, MMC_HOST_INSTANCE_SIGNATURE)
 
 
@@ -481,6 +494,150 @@ MmcFlushBlocks (
   IN EFI_BLOCK_IO_PROTOCOL  *This
   );
 
+/**
+  Reset the block device.
+
+  This function implements EFI_BLOCK_IO2_PROTOCOL.Reset().
+  Pending requests are completed with EFI_ABORTED before
+  the device is reset.
+
+  @param  This                   Indicates a pointer to the calling context.
+  @param  ExtendedVerification   Indicates that the driver may perform a more exhaustive
+                                 verification operation of the device during reset.
+
+  @retval EFI_SUCCESS            The block device was reset.
+  @retval EFI_DEVICE_ERROR       The block device is not functioning correctly and could not be reset.
+
+**/
+EFI_STATUS
+EFIAPI
+MmcResetEx (
+  IN EFI_BLOCK_IO2_PROTOCOL   *This,
+  IN BOOLEAN                  ExtendedVerification
+  );
+
+/**
+  Reads the requested number of blocks from the device.
+
+  This function implements EFI_BLOCK_IO2_PROTOCOL.ReadBlocksEx().
+  With a non-NULL Token->Event, the request is queued and
+  Token->Event is signaled once the data has been read.
+
+  @param  This                   Indicates a pointer to the calling context.
+  @param  MediaId                The media ID that the read request is for.
+  @param  Lba                    The starting logical block address to read from on the device.
+  @param  Token                  A pointer to the token associated with the transaction.
+  @param  BufferSize             The size of the Buffer in bytes.
+                                 This must be a multiple of the intrinsic block size of the device.
+  @param  Buffer                 A pointer to the destination buffer for the data.
+
+  @retval EFI_SUCCESS            The read request was queued, or the data was read correctly.
+  @retval EFI_DEVICE_ERROR       The device reported an error while attempting to perform the read operation.
+  @retval EFI_NO_MEDIA           There is no media in the device.
+  @retval EFI_MEDIA_CHANGED      The MediaId is not for the current media.
+  @retval EFI_BAD_BUFFER_SIZE    The BufferSize parameter is not a multiple of the intrinsic block size of the device.
+  @retval EFI_INVALID_PARAMETER  The read request contains LBAs that are not valid,
+                                 or the buffer is not on proper alignment.
+  @retval EFI_OUT_OF_RESOURCES   The request could not be queued.
+
+**/
+EFI_STATUS
+EFIAPI
+MmcReadBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN     UINT32                 MediaId,
+  IN     EFI_LBA                Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token,
+  IN     UINTN                  BufferSize,
+  OUT    VOID                   *Buffer
+  );
+
+/**
+  Writes a specified number of blocks to the device.
+
+  This function implements EFI_BLOCK_IO2_PROTOCOL.WriteBlocksEx().
+  With a non-NULL Token->Event, the request is queued and
+  Token->Event is signaled once the data has been written.
+
+  @param  This                   Indicates a pointer to the calling context.
+  @param  MediaId                The media ID that the write request is for.
+  @param  Lba                    The starting logical block address to be written.
+  @param  Token                  A pointer to the token associated with the transaction.
+  @param  BufferSize             The size in bytes of Buffer.
+                                 This must be a multiple of the intrinsic block size of the device.
+  @param  Buffer                 A pointer to the source buffer for the data.
+
+  @retval EFI_SUCCESS            The write request was queued, or the data was written correctly.
+  @retval EFI_WRITE_PROTECTED    The device cannot be written to.
+  @retval EFI_NO_MEDIA           There is no media in the device.
+  @retval EFI_MEDIA_CHANGED      The MediaId is not for the current media.
+  @retval EFI_DEVICE_ERROR       The device reported an error while attempting to perform the write operation.
+  @retval EFI_BAD_BUFFER_SIZE    The BufferSize parameter is not a multiple of the intrinsic block size of the device.
+  @retval EFI_INVALID_PARAMETER  The write request contains LBAs that are not valid,
+                                 or the buffer is not on proper alignment.
+  @retval EFI_OUT_OF_RESOURCES   The request could not be queued.
+
+**/
+EFI_STATUS
+EFIAPI
+MmcWriteBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN     UINT32                 MediaId,
+  IN     EFI_LBA                Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token,
+  IN     UINTN                  BufferSize,
+  IN     VOID                   *Buffer
+  );
+
+/**
+  Flushes all modified data to a physical block device.
+
+  This function implements EFI_BLOCK_IO2_PROTOCOL.FlushBlocksEx().
+  All queued requests are completed before the flush completes.
+
+  @param  This                   Indicates a pointer to the calling context.
+  @param  Token                  A pointer to the token associated with the transaction.
+
+  @retval EFI_SUCCESS            All outstanding data were written correctly to the device.
+
+**/
+EFI_STATUS
+EFIAPI
+MmcFlushBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token
+  );
+
+/**
+  Processes the queued EFI_BLOCK_IO2 requests.
+
+  Requests for adjacent LBAs in the same direction are merged
+  into a single multi-block transfer. Runs at TPL_CALLBACK.
+
+  @param  Event                  The queue event.
+  @param  Context                The MMC_HOST_INSTANCE owning the queue.
+
+**/
+VOID
+EFIAPI
+MmcProcessQueue (
+  IN EFI_EVENT                Event,
+  IN VOID                     *Context
+  );
+
+/**
+  Completes all queued EFI_BLOCK_IO2 requests with Status.
+
+  @param  MmcHostInstance        The MMC_HOST_INSTANCE owning the queue.
+  @param  Status                 The status to complete the requests with.
+
+**/
+VOID
+MmcAbortRequests (
+  IN MMC_HOST_INSTANCE        *MmcHostInstance,
+  IN EFI_STATUS               Status
+  );
+
 EFI_STATUS
 MmcNotifyState (
   IN MMC_HOST_INSTANCE      *MmcHostInstance,
@@ -7,12 +7,39 @@
  **/
 
 #include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
 
 #include "Mmc.h"
 
 #define MMCI0_BLOCKLEN 512
 #define MMCI0_TIMEOUT  1000
 
+/*
+ * Largest number of queued EFI_BLOCK_IO2 requests merged into one
+ * transfer, and largest block count that can be set with CMD23.
+ */
+#define MMC_MAX_MERGED_REQUESTS  32
+#define MMC_MAX_SET_BLOCK_COUNT  0xFFFF
+
+#define MMC_BLOCK_IO2_REQUEST_SIGNATURE     SIGNATURE_32 ('m', 'm', 'c', 'r')
+#define MMC_BLOCK_IO2_REQUEST_FROM_LINK(a)  CR (a, MMC_BLOCK_IO2_REQUEST, Link, MMC_BLOCK_IO2_REQUEST_SIGNATURE)
+
+typedef struct {
+  UINTN                   Signature;
+  LIST_ENTRY              Link;
+  UINTN                   Transfer;
+  UINT32                  MediaId;
+  EFI_LBA                 Lba;
+  UINTN                   BufferSize;
+  VOID                    *Buffer;
+  EFI_BLOCK_IO2_TOKEN     *Token;
+} MMC_BLOCK_IO2_REQUEST;
+
+typedef struct {
+  UINTN                   BufferSize;
+  VOID                    *Buffer;
+} MMC_TRANSFER_SEGMENT;
+
 STATIC
 EFI_STATUS
 R1TranAndReady (
@@ -213,27 +240,91 @@ MmcStopTransmission (
   return Status;
 }
 
+STATIC
+BOOLEAN
+MmcIsMultiBlock (
+  IN EFI_MMC_HOST_PROTOCOL    *MmcHost
+  )
+{
+  return PcdGet32 (PcdMmcDisableMulti) == 0 &&
+         MMC_HOST_HAS_ISMULTIBLOCK (MmcHost) &&
+         MmcHost->IsMultiBlock (MmcHost);
+}
+
+/*
+ * Transfers BlockCount blocks starting at Lba with a single
+ * single- or multi-block command. The data phase is spread
+ * over the caller buffers described by Segments, which is how
+ * queued EFI_BLOCK_IO2 requests for adjacent LBAs are merged.
+ */
 STATIC
 EFI_STATUS
 MmcTransferBlock (
   IN EFI_BLOCK_IO_PROTOCOL    *This,
-  IN UINTN                    Cmd,
   IN UINTN                    Transfer,
-  IN UINT32                   MediaId,
   IN EFI_LBA                  Lba,
-  IN UINTN                    BufferSize,
-  OUT VOID                    *Buffer,
+  IN MMC_TRANSFER_SEGMENT     *Segments,
+  IN UINTN                    SegmentCount,
   OUT UINTN                   *TransferredSize
   )
 {
   EFI_STATUS              Status;
   MMC_HOST_INSTANCE       *MmcHostInstance;
   EFI_MMC_HOST_PROTOCOL   *MmcHost;
+  UINTN                   Cmd;
   UINTN                   CmdArg;
+  UINTN                   BufferSize;
+  UINTN                   BlockCount;
+  UINTN                   Index;
+  EFI_LBA                 SegmentLba;
+  BOOLEAN                 SetBlockCount;
+  UINT32                  Response[4];
 
   MmcHostInstance = MMC_HOST_INSTANCE_FROM_BLOCK_IO_THIS (This);
   MmcHost = MmcHostInstance->MmcHost;
 
+  BufferSize = 0;
+  for (Index = 0; Index < SegmentCount; Index++) {
+    BufferSize += Segments[Index].BufferSize;
+  }
+  BlockCount = BufferSize / This->Media->BlockSize;
+
+  if (Transfer == MMC_IOBLOCKS_READ) {
+    Cmd = (BlockCount == 1) ? MMC_CMD17 : MMC_CMD18;
+  } else {
+    Cmd = (BlockCount == 1) ? MMC_CMD24 : MMC_CMD25;
+  }
+
+  /*
+   * Where the card supports it, pre-define the block count with
+   * CMD23, so the card returns to TRAN by itself and the transfer
+   * does not need to be closed with CMD12.
+   */
+  SetBlockCount = FALSE;
+  if (BlockCount > 1 &&
+      BlockCount <= MMC_MAX_SET_BLOCK_COUNT &&
+      MmcHostInstance->CardInfo.Cmd23Supported &&
+      PcdGet32 (PcdMmcDisableSetBlockCount) == 0) {
+    Response[0] = 0;
+    Status = MmcHost->SendCommand (MmcHost, MMC_CMD23, BlockCount);
+    if (!EFI_ERROR (Status)) {
+      Status = MmcHost->ReceiveResponse (MmcHost, MMC_RESPONSE_TYPE_R1, Response);
+    }
+    if (!EFI_ERROR (Status) && (Response[0] & MMC_R0_ERROR_MASK) != 0) {
+      Status = EFI_DEVICE_ERROR;
+    }
+    if (!EFI_ERROR (Status)) {
+      SetBlockCount = TRUE;
+    } else {
+      /*
+       * The card did not accept the block count, so the transfer
+       * stays open-ended and is closed with CMD12 below.
+       */
+      DEBUG ((DEBUG_BLKIO, "%a(MMC_CMD23): Error %r (R1 0x%x), using CMD12\n",
+        __func__, Status, Response[0]));
+    }
+  }
+
   //Set command argument based on the card access mode (Byte mode or Block mode)
   if ((MmcHostInstance->CardInfo.OCRData.AccessMode & MMC_OCR_ACCESS_MASK) ==
       MMC_OCR_ACCESS_SECTOR) {
@@ -248,24 +339,31 @@ MmcTransferBlock (
     return Status;
   }
 
-  if (Transfer == MMC_IOBLOCKS_READ) {
-    Status = MmcHost->ReadBlockData (MmcHost, Lba, BufferSize, Buffer);
-  } else {
-    Status = MmcHost->WriteBlockData (MmcHost, Lba, BufferSize, Buffer);
-    if (!EFI_ERROR (Status)) {
-      Status = MmcNotifyState (MmcHostInstance, MmcProgrammingState);
-      if (EFI_ERROR (Status)) {
-        DEBUG ((DEBUG_ERROR, "%a(): Error MmcProgrammingState\n", __func__));
-        return Status;
-      }
+  SegmentLba = Lba;
+  for (Index = 0; Index < SegmentCount && !EFI_ERROR (Status); Index++) {
+    if (Transfer == MMC_IOBLOCKS_READ) {
+      Status = MmcHost->ReadBlockData (MmcHost, SegmentLba,
+                          Segments[Index].BufferSize, Segments[Index].Buffer);
+    } else {
+      Status = MmcHost->WriteBlockData (MmcHost, SegmentLba,
+                          Segments[Index].BufferSize, Segments[Index].Buffer);
+    }
+    SegmentLba += Segments[Index].BufferSize / This->Media->BlockSize;
+  }
+
+  if (Transfer != MMC_IOBLOCKS_READ && !EFI_ERROR (Status)) {
+    Status = MmcNotifyState (MmcHostInstance, MmcProgrammingState);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "%a(): Error MmcProgrammingState\n", __func__));
+      return Status;
     }
   }
 
   if (EFI_ERROR (Status) ||
-      BufferSize > This->Media->BlockSize) {
+      (BlockCount > 1 && !SetBlockCount)) {
     /*
-     * CMD12 needs to be set for multiblock (to transition from
-     * RECV to PROG) or for errors.
+     * CMD12 needs to be set for open-ended multiblock (to transition
+     * from RECV to PROG) or for errors.
      */
     EFI_STATUS Status2 = MmcStopTransmission (MmcHost);
     if (EFI_ERROR (Status2)) {
@@ -303,8 +401,7 @@ MmcTransferBlock (
     UINTN BlocksWritten = 0;
 
     Status = ValidateWrittenBlockCount (MmcHostInstance,
-               BufferSize /
-               This->Media->BlockSize,
+               BlockCount,
                &BlocksWritten);
     *TransferredSize = BlocksWritten * This->Media->BlockSize;
   } else {
@@ -314,55 +411,40 @@ MmcTransferBlock (
   return Status;
 }
 
+STATIC
 EFI_STATUS
-MmcIoBlocks (
-  IN EFI_BLOCK_IO_PROTOCOL    *This,
+MmcValidateIoRequest (
+  IN MMC_HOST_INSTANCE        *MmcHostInstance,
   IN UINTN                    Transfer,
   IN UINT32                   MediaId,
   IN EFI_LBA                  Lba,
   IN UINTN                    BufferSize,
-  OUT VOID                    *Buffer
+  IN VOID                     *Buffer
   )
 {
-  EFI_STATUS              Status;
-  UINTN                   Cmd;
-  MMC_HOST_INSTANCE       *MmcHostInstance;
-  EFI_MMC_HOST_PROTOCOL   *MmcHost;
-  UINTN                   BytesRemainingToBeTransfered;
-  UINTN                   BlockCount;
-  UINTN                   ConsumeSize;
+  EFI_BLOCK_IO_MEDIA      *Media;
 
-  BlockCount = 1;
-  MmcHostInstance = MMC_HOST_INSTANCE_FROM_BLOCK_IO_THIS (This);
-  ASSERT (MmcHostInstance != NULL);
-  MmcHost = MmcHostInstance->MmcHost;
-  ASSERT (MmcHost);
+  Media = MmcHostInstance->BlockIo.Media;
 
-  if (This->Media->MediaId != MediaId) {
+  if (Media->MediaId != MediaId) {
     return EFI_MEDIA_CHANGED;
   }
 
-  if ((MmcHost == NULL) || (Buffer == NULL)) {
+  if ((MmcHostInstance->MmcHost == NULL) || (Buffer == NULL)) {
     return EFI_INVALID_PARAMETER;
   }
 
   // Check if a Card is Present
-  if (!MmcHostInstance->BlockIo.Media->MediaPresent) {
+  if (!Media->MediaPresent) {
     return EFI_NO_MEDIA;
   }
 
-  if (PcdGet32 (PcdMmcDisableMulti) == 0 &&
-      MMC_HOST_HAS_ISMULTIBLOCK (MmcHost) &&
-      MmcHost->IsMultiBlock (MmcHost)) {
-    BlockCount = (BufferSize + This->Media->BlockSize - 1) / This->Media->BlockSize;
-  }
-
   // All blocks must be within the device
-  if ((Lba + (BufferSize / This->Media->BlockSize)) > (This->Media->LastBlock + 1)) {
+  if ((Lba + (BufferSize / Media->BlockSize)) > (Media->LastBlock + 1)) {
     return EFI_INVALID_PARAMETER;
   }
 
-  if ((Transfer == MMC_IOBLOCKS_WRITE) && (This->Media->ReadOnly == TRUE)) {
+  if ((Transfer == MMC_IOBLOCKS_WRITE) && (Media->ReadOnly == TRUE)) {
     return EFI_WRITE_PROTECTED;
   }
 
@@ -372,39 +454,65 @@ MmcIoBlocks (
   }
 
   // The buffer size must be an exact multiple of the block size
-  if ((BufferSize % This->Media->BlockSize) != 0) {
+  if ((BufferSize % Media->BlockSize) != 0) {
     return EFI_BAD_BUFFER_SIZE;
   }
 
   // Check the alignment
-  if ((This->Media->IoAlign > 2) && (((UINTN)Buffer & (This->Media->IoAlign - 1)) != 0)) {
+  if ((Media->IoAlign > 2) && (((UINTN)Buffer & (Media->IoAlign - 1)) != 0)) {
     return EFI_INVALID_PARAMETER;
   }
 
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+MmcIoBlocks (
+  IN EFI_BLOCK_IO_PROTOCOL    *This,
+  IN UINTN                    Transfer,
+  IN UINT32                   MediaId,
+  IN EFI_LBA                  Lba,
+  IN UINTN                    BufferSize,
+  OUT VOID                    *Buffer
+  )
+{
+  EFI_STATUS              Status;
+  MMC_HOST_INSTANCE       *MmcHostInstance;
+  EFI_MMC_HOST_PROTOCOL   *MmcHost;
+  MMC_TRANSFER_SEGMENT    Segment;
+  UINTN                   BytesRemainingToBeTransfered;
+  UINTN                   BlockCount;
+  UINTN                   ConsumeSize;
+  EFI_TPL                 OldTpl;
+
+  BlockCount = 1;
+  MmcHostInstance = MMC_HOST_INSTANCE_FROM_BLOCK_IO_THIS (This);
+  ASSERT (MmcHostInstance != NULL);
+  MmcHost = MmcHostInstance->MmcHost;
+  ASSERT (MmcHost);
+
+  Status = MmcValidateIoRequest (MmcHostInstance, Transfer, MediaId, Lba,
+             BufferSize, Buffer);
+  if (EFI_ERROR (Status) || BufferSize == 0) {
+    return Status;
+  }
+
+  if (MmcIsMultiBlock (MmcHost)) {
+    BlockCount = (BufferSize + This->Media->BlockSize - 1) / This->Media->BlockSize;
+  }
+
+  /*
+   * Keep queued EFI_BLOCK_IO2 requests from being dispatched
+   * in the middle of this transfer.
+   */
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+
   BytesRemainingToBeTransfered = BufferSize;
   while (BytesRemainingToBeTransfered > 0) {
     Status = WaitUntilTran (MmcHostInstance);
     if (EFI_ERROR (Status)) {
       DEBUG ((DEBUG_ERROR, "WaitUntilTran before IO failed"));
-      return Status;
-    }
-
-    if (Transfer == MMC_IOBLOCKS_READ) {
-      if (BlockCount == 1) {
-        // Read a single block
-        Cmd = MMC_CMD17;
-      } else {
-        // Read multiple blocks
-        Cmd = MMC_CMD18;
-      }
-    } else {
-      if (BlockCount == 1) {
-        // Write a single block
-        Cmd = MMC_CMD24;
-      } else {
-        // Write multiple blocks
-        Cmd = MMC_CMD25;
-      }
+      break;
     }
 
     ConsumeSize = BlockCount * This->Media->BlockSize;
@@ -412,10 +520,12 @@ MmcIoBlocks (
       ConsumeSize = BytesRemainingToBeTransfered;
     }
 
-    Status = MmcTransferBlock (This, Cmd, Transfer, MediaId, Lba, ConsumeSize, Buffer, &ConsumeSize);
+    Segment.BufferSize = ConsumeSize;
+    Segment.Buffer = Buffer;
+    Status = MmcTransferBlock (This, Transfer, Lba, &Segment, 1, &ConsumeSize);
     if (EFI_ERROR (Status)) {
       DEBUG ((DEBUG_ERROR, "%a(): Failed to transfer block and Status:%r\n", __func__, Status));
-      return Status;
+      break;
     }
 
     BytesRemainingToBeTransfered -= ConsumeSize;
@@ -425,7 +535,8 @@ MmcIoBlocks (
     }
   }
 
-  return EFI_SUCCESS;
+  gBS->RestoreTPL (OldTpl);
+  return Status;
 }
 
 EFI_STATUS
@@ -462,3 +573,272 @@ MmcFlushBlocks (
 {
   return EFI_SUCCESS;
 }
+
+STATIC
+VOID
+MmcCompleteRequest (
+  IN MMC_BLOCK_IO2_REQUEST    *Request,
+  IN EFI_STATUS               Status
+  )
+{
+  RemoveEntryList (&Request->Link);
+  Request->Token->TransactionStatus = Status;
+  gBS->SignalEvent (Request->Token->Event);
+  FreePool (Request);
+}
+
+VOID
+MmcAbortRequests (
+  IN MMC_HOST_INSTANCE        *MmcHostInstance,
+  IN EFI_STATUS               Status
+  )
+{
+  MMC_BLOCK_IO2_REQUEST   *Request;
+
+  while (!IsListEmpty (&MmcHostInstance->Queue)) {
+    Request = MMC_BLOCK_IO2_REQUEST_FROM_LINK (
+                GetFirstNode (&MmcHostInstance->Queue));
+    MmcCompleteRequest (Request, Status);
+  }
+}
+
+VOID
+EFIAPI
+MmcProcessQueue (
+  IN EFI_EVENT                Event,
+  IN VOID                     *Context
+  )
+{
+  EFI_STATUS              Status;
+  EFI_STATUS              RequestStatus;
+  MMC_HOST_INSTANCE       *MmcHostInstance;
+  EFI_BLOCK_IO_PROTOCOL   *BlockIo;
+  MMC_BLOCK_IO2_REQUEST   *First;
+  MMC_BLOCK_IO2_REQUEST   *Request;
+  MMC_BLOCK_IO2_REQUEST   *Requests[MMC_MAX_MERGED_REQUESTS];
+  MMC_TRANSFER_SEGMENT    Segments[MMC_MAX_MERGED_REQUESTS];
+  LIST_ENTRY              *Link;
+  UINTN                   Count;
+  UINTN                   Index;
+  UINTN                   BlockCount;
+  UINTN                   RequestBlocks;
+  UINTN                   TransferredSize;
+
+  MmcHostInstance = (MMC_HOST_INSTANCE *)Context;
+  BlockIo = &MmcHostInstance->BlockIo;
+
+  while (!IsListEmpty (&MmcHostInstance->Queue)) {
+    First = MMC_BLOCK_IO2_REQUEST_FROM_LINK (
+              GetFirstNode (&MmcHostInstance->Queue));
+
+    /*
+     * The card may have been removed or replaced since
+     * the request was queued.
+     */
+    if (!BlockIo->Media->MediaPresent) {
+      MmcCompleteRequest (First, EFI_NO_MEDIA);
+      continue;
+    }
+
+    if (First->MediaId != BlockIo->Media->MediaId) {
+      MmcCompleteRequest (First, EFI_MEDIA_CHANGED);
+      continue;
+    }
+
+    if (!MmcIsMultiBlock (MmcHostInstance->MmcHost)) {
+      Status = MmcIoBlocks (BlockIo, First->Transfer, First->MediaId,
+                 First->Lba, First->BufferSize, First->Buffer);
+      MmcCompleteRequest (First, Status);
+      continue;
+    }
+
+    /*
+     * Merge the queued requests that continue the first one on
+     * the medium into a single multi-block transfer.
+     */
+    Requests[0] = First;
+    Segments[0].BufferSize = First->BufferSize;
+    Segments[0].Buffer = First->Buffer;
+    BlockCount = First->BufferSize / BlockIo->Media->BlockSize;
+    Count = 1;
+
+    Link = GetNextNode (&MmcHostInstance->Queue, &First->Link);
+    while (!IsNull (&MmcHostInstance->Queue, Link) &&
+           Count < MMC_MAX_MERGED_REQUESTS) {
+      Request = MMC_BLOCK_IO2_REQUEST_FROM_LINK (Link);
+      RequestBlocks = Request->BufferSize / BlockIo->Media->BlockSize;
+      if (Request->Transfer != First->Transfer ||
+          Request->MediaId != First->MediaId ||
+          Request->Lba != First->Lba + BlockCount ||
+          BlockCount + RequestBlocks > MMC_MAX_SET_BLOCK_COUNT) {
+        break;
+      }
+
+      Requests[Count] = Request;
+      Segments[Count].BufferSize = Request->BufferSize;
+      Segments[Count].Buffer = Request->Buffer;
+      BlockCount += RequestBlocks;
+      Count++;
+
+      Link = GetNextNode (&MmcHostInstance->Queue, Link);
+    }
+
+    TransferredSize = 0;
+    Status = WaitUntilTran (MmcHostInstance);
+    if (!EFI_ERROR (Status)) {
+      Status = MmcTransferBlock (BlockIo, First->Transfer, First->Lba,
+                 Segments, Count, &TransferredSize);
+    }
+
+    /*
+     * A short write fails the requests it did not fully cover.
+     */
+    for (Index = 0; Index < Count; Index++) {
+      RequestStatus = Status;
+      if (!EFI_ERROR (Status)) {
+        if (TransferredSize >= Requests[Index]->BufferSize) {
+          TransferredSize -= Requests[Index]->BufferSize;
+        } else {
+          TransferredSize = 0;
+          RequestStatus = EFI_DEVICE_ERROR;
+        }
+      }
+      MmcCompleteRequest (Requests[Index], RequestStatus);
+    }
+  }
+}
+
+STATIC
+EFI_STATUS
+MmcIoBlocksEx (
+  IN EFI_BLOCK_IO2_PROTOCOL   *This,
+  IN UINTN                    Transfer,
+  IN UINT32                   MediaId,
+  IN EFI_LBA                  Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN  *Token,
+  IN UINTN                    BufferSize,
+  IN VOID                     *Buffer
+  )
+{
+  EFI_STATUS              Status;
+  MMC_HOST_INSTANCE       *MmcHostInstance;
+  MMC_BLOCK_IO2_REQUEST   *Request;
+  EFI_TPL                 OldTpl;
+
+  MmcHostInstance = MMC_HOST_INSTANCE_FROM_BLOCK_IO2_THIS (This);
+
+  if (Token == NULL || Token->Event == NULL) {
+    return MmcIoBlocks (&MmcHostInstance->BlockIo, Transfer, MediaId, Lba,
+             BufferSize, Buffer);
+  }
+
+  Status = MmcValidateIoRequest (MmcHostInstance, Transfer, MediaId, Lba,
+             BufferSize, Buffer);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if (BufferSize == 0) {
+    Token->TransactionStatus = EFI_SUCCESS;
+    gBS->SignalEvent (Token->Event);
+    return EFI_SUCCESS;
+  }
+
+  Request = AllocatePool (sizeof (MMC_BLOCK_IO2_REQUEST));
+  if (Request == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Request->Signature = MMC_BLOCK_IO2_REQUEST_SIGNATURE;
+  Request->Transfer = Transfer;
+  Request->MediaId = MediaId;
+  Request->Lba = Lba;
+  Request->BufferSize = BufferSize;
+  Request->Buffer = Buffer;
+  Request->Token = Token;
+  Token->TransactionStatus = EFI_NOT_READY;
+
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+  InsertTailList (&MmcHostInstance->Queue, &Request->Link);
+  gBS->SignalEvent (MmcHostInstance->QueueEvent);
+  gBS->RestoreTPL (OldTpl);
+
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+EFIAPI
+MmcResetEx (
+  IN EFI_BLOCK_IO2_PROTOCOL   *This,
+  IN BOOLEAN                  ExtendedVerification
+  )
+{
+  MMC_HOST_INSTANCE       *MmcHostInstance;
+  EFI_TPL                 OldTpl;
+
+  MmcHostInstance = MMC_HOST_INSTANCE_FROM_BLOCK_IO2_THIS (This);
+
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+  MmcAbortRequests (MmcHostInstance, EFI_ABORTED);
+  gBS->RestoreTPL (OldTpl);
+
+  return MmcReset (&MmcHostInstance->BlockIo, ExtendedVerification);
+}
+
+EFI_STATUS
+EFIAPI
+MmcReadBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN     UINT32                 MediaId,
+  IN     EFI_LBA                Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token,
+  IN     UINTN                  BufferSize,
+  OUT    VOID                   *Buffer
+  )
+{
+  return MmcIoBlocksEx (This, MMC_IOBLOCKS_READ, MediaId, Lba, Token,
+           BufferSize, Buffer);
+}
+
+EFI_STATUS
+EFIAPI
+MmcWriteBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN     UINT32                 MediaId,
+  IN     EFI_LBA                Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token,
+  IN     UINTN                  BufferSize,
+  IN     VOID                   *Buffer
+  )
+{
+  return MmcIoBlocksEx (This, MMC_IOBLOCKS_WRITE, MediaId, Lba, Token,
+           BufferSize, Buffer);
+}
+
+EFI_STATUS
+EFIAPI
+MmcFlushBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token
+  )
+{
+  MMC_HOST_INSTANCE       *MmcHostInstance;
+  EFI_TPL                 OldTpl;
+
+  MmcHostInstance = MMC_HOST_INSTANCE_FROM_BLOCK_IO2_THIS (This);
+
+  /*
+   * Writes are not cached, so completing the queued
+   * requests is all a flush has to do.
+   */
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+  MmcProcessQueue (NULL, MmcHostInstance);
+  gBS->RestoreTPL (OldTpl);
+
+  if (Token != NULL && Token->Event != NULL) {
+    Token->TransactionStatus = EFI_SUCCESS;
+    gBS->SignalEvent (Token->Event);
+  }
+
+  return EFI_SUCCESS;
+}
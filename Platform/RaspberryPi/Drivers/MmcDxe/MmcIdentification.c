@@ -45,6 +45,8 @@ typedef union {
 
 #define SD_CCC_SWITCH           (1 << 10)
 
+#define SD_CMD_SUPPORT_CMD23    (1 << 1)
+
 #define DEVICE_STATE(x)         (((x) >> 9) & 0xf)
 typedef enum _EMMC_DEVICE_STATE {
   EMMC_IDLE_STATE = 0,
@@ -242,6 +244,7 @@ EmmcIdentificationMode (
 
   // Setup card type
   MmcHostInstance->CardInfo.CardType = EMMC_CARD;
+  MmcHostInstance->CardInfo.Cmd23Supported = TRUE;
   return EFI_SUCCESS;
 
 FreePageExit:
@@ -713,6 +716,9 @@ InitializeSdMmcDevice (
     }
   }
 
+  MmcHostInstance->CardInfo.Cmd23Supported =
+    (Scr.CMD_SUPPORT & SD_CMD_SUPPORT_CMD23) != 0;
+
   return EFI_SUCCESS;
 }
 
@@ -956,6 +962,7 @@ InitializeMmcDevice (
 
   BlockCount = 1;
   MmcHost = MmcHostInstance->MmcHost;
+  MmcHostInstance->CardInfo.Cmd23Supported = FALSE;
 
   Status = MmcIdentificationMode (MmcHostInstance);
   if (EFI_ERROR (Status)) {
@@ -86,6 +86,33 @@ EFI_FW_VOL_BLOCK_DEVICE mFvbDeviceTemplate = {
 };
 
 
+STATIC
+VOID
+VarStoreMarkDirty (
+  IN UINTN Address,
+  IN UINTN Length
+  )
+{
+  UINTN Index;
+  UINTN Last;
+
+  mFvInstance->Dirty = TRUE;
+  if (mFvInstance->DirtyBlocks == NULL || Length == 0) {
+    return;
+  }
+
+  //
+  // Track which blocks of the store were touched, so that only
+  // those need to be written back to the backing file.
+  //
+  Index = (Address - mFvInstance->FvBase) / mFvInstance->BlockSize;
+  Last = (Address + Length - 1 - mFvInstance->FvBase) / mFvInstance->BlockSize;
+  for (; Index <= Last; Index++) {
+    mFvInstance->DirtyBlocks[Index / 8] |= (UINT8)(1 << (Index % 8));
+  }
+}
+
+
 EFI_STATUS
 VarStoreWrite (
   IN     UINTN Address,
@@ -94,7 +121,7 @@ VarStoreWrite (
   )
 {
   CopyMem ((VOID*)Address, Buffer, *NumBytes);
-  mFvInstance->Dirty = TRUE;
+  VarStoreMarkDirty (Address, *NumBytes);
 
   return EFI_SUCCESS;
 }
@@ -107,7 +134,7 @@ VarStoreErase (
   )
 {
   SetMem ((VOID*)Address, LbaLength, 0xff);
-  mFvInstance->Dirty = TRUE;
+  VarStoreMarkDirty (Address, LbaLength);
 
   return EFI_SUCCESS;
 }
@@ -848,6 +875,15 @@ FvbInitialize (
    */
   mFvInstance->MappedFile = L"RPI_EFI.FD";
 
+  //
+  // One dirty bit per block. If this allocation fails we simply fall back
+  // to writing back the whole store.
+  //
+  mFvInstance->BlockSize = PcdGet32 (PcdFirmwareBlockSize);
+  mFvInstance->DirtyBlocks = AllocateRuntimeZeroPool (
+                               ALIGN_VALUE (Length / mFvInstance->BlockSize +
+                                 1, 8) / 8);
+
   Status = ValidateFvHeader (mFvInstance->VolumeHeader);
   if (!EFI_ERROR (Status)) {
     if (mFvInstance->VolumeHeader->FvLength != Length ||
@@ -33,6 +33,8 @@ typedef struct {
   EFI_DEVICE_PATH_PROTOCOL   *Device;
   CHAR16                     *MappedFile;
   BOOLEAN                    Dirty;
+  UINTN                      BlockSize;
+  UINT8                      *DirtyBlocks;
 } EFI_FW_VOL_INSTANCE;
 
 extern EFI_FW_VOL_INSTANCE *mFvInstance;
@@ -8,6 +8,8 @@
  *
  **/
 
+#include <Library/BaseMemoryLib.h>
+
 #include "VarBlockService.h"
 
 //
@@ -106,6 +108,7 @@ FvbVirtualAddressChangeEvent (
 {
   EfiConvertPointer (0x0, (VOID**)&mFvInstance->FvBase);
   EfiConvertPointer (0x0, (VOID**)&mFvInstance->VolumeHeader);
+  EfiConvertPointer (0x0, (VOID**)&mFvInstance->DirtyBlocks);
   EfiConvertPointer (0x0, (VOID**)&mFvInstance);
 }
 
@@ -130,14 +133,29 @@ InstallVirtualAddressChangeHandler (
 }
 
 
+STATIC
+BOOLEAN
+IsBlockDirty (
+  IN UINTN Index
+  )
+{
+  return (mFvInstance->DirtyBlocks[Index / 8] & (1 << (Index % 8))) != 0;
+}
+
+
 STATIC
 EFI_STATUS
 DoDump (
-  IN EFI_DEVICE_PATH_PROTOCOL *Device
+  IN EFI_DEVICE_PATH_PROTOCOL *Device,
+  IN BOOLEAN                  Full
   )
 {
   EFI_STATUS Status;
   EFI_FILE_PROTOCOL *File;
+  UINTN NumBlocks;
+  UINTN Start;
+  UINTN End;
+  UINTN Length;
 
   Status = FileOpen (Device,
              mFvInstance->MappedFile,
@@ -148,10 +166,39 @@ DoDump (
     return Status;
   }
 
-  Status = FileWrite (File,
-             mFvInstance->Offset,
-             mFvInstance->FvBase,
-             mFvInstance->FvLength);
+  if (Full || mFvInstance->DirtyBlocks == NULL) {
+    Status = FileWrite (File,
+               mFvInstance->Offset,
+               mFvInstance->FvBase,
+               mFvInstance->FvLength);
+    FileClose (File);
+    return Status;
+  }
+
+  //
+  // Only write back the runs of blocks that were modified.
+  //
+  Status = EFI_SUCCESS;
+  NumBlocks = (mFvInstance->FvLength + mFvInstance->BlockSize - 1) /
+              mFvInstance->BlockSize;
+  for (Start = 0; Start < NumBlocks && !EFI_ERROR (Status); Start = End) {
+    if (!IsBlockDirty (Start)) {
+      End = Start + 1;
+      continue;
+    }
+
+    for (End = Start + 1; End < NumBlocks && IsBlockDirty (End); End++);
+
+    Length = MIN ((End - Start) * mFvInstance->BlockSize,
+               mFvInstance->FvLength - Start * mFvInstance->BlockSize);
+    DEBUG ((DEBUG_INFO, "Dumping variable store blocks 0x%lx-0x%lx\n",
+      (UINT64)Start, (UINT64)End - 1));
+    Status = FileWrite (File,
+               mFvInstance->Offset + Start * mFvInstance->BlockSize,
+               mFvInstance->FvBase + Start * mFvInstance->BlockSize,
+               Length);
+  }
+
   FileClose (File);
   return Status;
 }
@@ -178,7 +225,7 @@ DumpVars (
     return;
   }
 
-  Status = DoDump (mFvInstance->Device);
+  Status = DoDump (mFvInstance->Device, FALSE);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "Couldn't dump '%s'\n", mFvInstance->MappedFile));
     ASSERT_EFI_ERROR (Status);
@@ -198,6 +245,10 @@ DumpVars (
   }
 
   mFvInstance->Dirty = FALSE;
+  if (mFvInstance->DirtyBlocks != NULL) {
+    ZeroMem (mFvInstance->DirtyBlocks,
+      ALIGN_VALUE (mFvInstance->FvLength / mFvInstance->BlockSize + 1, 8) / 8);
+  }
 }
 
 
@@ -305,7 +356,7 @@ OnSimpleFileSystemInstall (
       continue;
     }
 
-    Status = DoDump (Device);
+    Status = DoDump (Device, TRUE);
     if (EFI_ERROR (Status)) {
       DEBUG ((DEBUG_ERROR, "Couldn't update '%s'\n", mFvInstance->MappedFile));
       ASSERT_EFI_ERROR (Status);
@@ -109,6 +109,14 @@ typedef struct {
   UINT32 DisableMulti;
 } MMC_DISMULTI_VARSTORE_DATA;
 
+typedef struct {
+  /*
+   * 0 - Pre-set the block count of multi-block transfers (CMD23).
+   * 1 - Terminate multi-block transfers with CMD12.
+   */
+  UINT32 DisableSetBlockCount;
+} MMC_DISSBC_VARSTORE_DATA;
+
 typedef struct {
   /*
    * 0 - Don't force 1 bit mode.
@@ -83,12 +83,7 @@ FlashPeiEntryPoint (
   if (CompareMem ((VOID *)StoredUuid, (VOID *)BuildUuid, sizeof (BuildUuid)) != 0) {
     DEBUG ((DEBUG_INFO, "BUILD UUID Changed, Update Storage with NVRAM FV\n"));
 
-    Status = FlashEraseCommand (FWNvRamStartOffset, NvRamSize * 2 + sizeof (BuildUuid));
-    if (EFI_ERROR (Status)) {
-      return Status;
-    }
-
-    Status = FlashWriteCommand (
+    Status = FlashUpdateCommand (
                FWNvRamStartOffset,
                (UINT8 *)NvRamAddress,
                NvRamSize
@@ -97,10 +92,18 @@ FlashPeiEntryPoint (
       return Status;
     }
 
+    //
+    // The second copy holds no data, keep it erased
+    //
+    Status = FlashEraseCommand (FWNvRamStartOffset + NvRamSize, NvRamSize);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
     //
     // Write new BUILD UUID to the Flash
     //
-    Status = FlashWriteCommand (
+    Status = FlashUpdateCommand (
                FWNvRamStartOffset + NvRamSize * 2,
                (UINT8 *)BuildUuid,
                sizeof (BuildUuid)
@@ -115,4 +115,29 @@ FlashReadCommand (
   IN  UINT32 Length
   );
 
+/**
+  Update a region of the Flash with the content of Buffer.
+
+  This combines erase, write and verify. The region is handled one
+  sector (or the part of a sector it covers) at a time. Parts which
+  already hold the data are left untouched, and a part is only erased
+  when the new data cannot be programmed over the current content.
+
+  @param[in] ByteAddress         Start address of the region.
+  @param[in] Buffer              Pointer to the data buffer.
+  @param[in] Length              Number of bytes to update.
+
+  @retval EFI_SUCCESS            Operation succeeded.
+  @retval EFI_INVALID_PARAMETER  Buffer is NULL or Length is Zero.
+  @retval EFI_DEVICE_ERROR       The data read back does not match Buffer.
+  @retval Others                 An error has occurred.
+**/
+EFI_STATUS
+EFIAPI
+FlashUpdateCommand (
+  IN  UINTN  ByteAddress,
+  IN  VOID   *Buffer,
+  IN  UINT32 Length
+  );
+
 #endif /* FLASH_LIB_H_ */
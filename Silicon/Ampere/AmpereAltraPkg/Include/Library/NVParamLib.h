@@ -50,6 +50,17 @@
 
 #define NVPARAM_SIZE    0x8
 
+//
+// One parameter of a bulk request.
+//
+typedef struct {
+  UINT32     Param;   // Parameter ID
+  UINT16     ACLRd;   // Permission for read operation
+  UINT16     ACLWr;   // Permission for write operation, unused by NVParamGetBulk
+  UINT32     Val;     // Value read or to be set
+  EFI_STATUS Status;  // Status of the operation on this parameter
+} NV_PARAM_ENTRY;
+
 /**
   Retrieve a non-volatile parameter.
 
@@ -131,4 +142,42 @@ NVParamClrAll (
   VOID
   );
 
+/**
+  Retrieve a set of non-volatile parameters.
+
+  Each entry is looked up as with NVParamGet() and gets its own
+  Status. Parameters already read during this boot are served from
+  the parameter cache.
+
+  @param[in, out] Entries         Array of parameters to retrieve.
+  @param[in]      Count           Number of entries in the array.
+
+  @retval EFI_SUCCESS             All entries were processed, check the
+                                  Status of each entry.
+  @retval EFI_INVALID_PARAMETER   Entries is NULL.
+**/
+EFI_STATUS
+NVParamGetBulk (
+  IN OUT NV_PARAM_ENTRY *Entries,
+  IN     UINTN          Count
+  );
+
+/**
+  Set a set of non-volatile parameters.
+
+  Each entry is set as with NVParamSet() and gets its own Status.
+
+  @param[in, out] Entries         Array of parameters to set.
+  @param[in]      Count           Number of entries in the array.
+
+  @retval EFI_SUCCESS             All entries were processed, check the
+                                  Status of each entry.
+  @retval EFI_INVALID_PARAMETER   Entries is NULL.
+**/
+EFI_STATUS
+NVParamSetBulk (
+  IN OUT NV_PARAM_ENTRY *Entries,
+  IN     UINTN          Count
+  );
+
 #endif /* NV_PARAM_LIB_H_ */
@@ -19,6 +19,8 @@ BOOLEAN                       gFlashLibRuntime = FALSE;
 UINT8                         *gFlashLibPhysicalBuffer;
 UINT8                         *gFlashLibVirtualBuffer;
 
+STATIC UINT64                 mFlashSectorSize;
+
 /**
   Convert Virtual Address to Physical Address at Runtime.
 
@@ -343,7 +345,11 @@ FlashReadCommand (
     MmData[0] = MM_SPINOR_FUNC_READ;
     MmData[1] = ByteAddress + Count;
     MmData[2] = NumRead;
-    MmData[3] = (UINT64)gFlashLibPhysicalBuffer;  // Read data into the temp buffer with specified virtual address
+    if (gFlashLibRuntime) {
+      MmData[3] = (UINT64)gFlashLibPhysicalBuffer;  // Read data into the temp buffer with specified virtual address
+    } else {
+      MmData[3] = (UINT64)(Buffer + Count);         // Identity mapped, read straight into the caller buffer
+    }
 
     Status = FlashMmCommunicate (
               MmData,
@@ -360,13 +366,219 @@ FlashReadCommand (
       return EFI_DEVICE_ERROR;
     }
 
-    //
-    // Get data from the virtual address of the temp buffer.
-    //
-    CopyMem ((VOID *)(Buffer + Count), (VOID *)gFlashLibVirtualBuffer, NumRead);
+    if (gFlashLibRuntime) {
+      //
+      // Get data from the virtual address of the temp buffer.
+      //
+      CopyMem ((VOID *)(Buffer + Count), (VOID *)gFlashLibVirtualBuffer, NumRead);
+    }
+    Remain -= NumRead;
+    Count += NumRead;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Get the erase sector size of the Flash.
+
+  @param[out] SectorSize         Size of an erase sector in bytes.
+
+  @retval EFI_SUCCESS            Operation succeeded.
+  @retval Others                 An error has occurred.
+**/
+STATIC
+EFI_STATUS
+FlashGetSectorSize (
+  OUT UINT64 *SectorSize
+  )
+{
+  EFI_MM_COMMUNICATE_SPINOR_RESPONSE MmSpiNorRes;
+  EFI_STATUS                         Status;
+  UINT64                             MmData[5];
+
+  if (mFlashSectorSize == 0) {
+    MmData[0] = MM_SPINOR_FUNC_GET_INFO;
+
+    Status = FlashMmCommunicate (
+               MmData,
+               sizeof (MmData),
+               &MmSpiNorRes,
+               sizeof (MmSpiNorRes)
+               );
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    if (MmSpiNorRes.Status != MM_SPINOR_RES_SUCCESS || MmSpiNorRes.SectorSize == 0) {
+      DEBUG ((DEBUG_ERROR, "%a: Device error %llx\n", __FUNCTION__, MmSpiNorRes.Status));
+      return EFI_DEVICE_ERROR;
+    }
+
+    mFlashSectorSize = MmSpiNorRes.SectorSize;
+  }
+
+  *SectorSize = mFlashSectorSize;
+  return EFI_SUCCESS;
+}
+
+/**
+  Compare a region of the Flash with Buffer.
+
+  The Flash content is read into the temp buffer chunk by chunk so no
+  caller-sized scratch buffer is needed.
+
+  @param[in]  ByteAddress        Start address of the region.
+  @param[in]  Buffer             Pointer to the data buffer.
+  @param[in]  Length             Number of bytes to compare.
+  @param[out] Identical          TRUE if the Flash already holds Buffer.
+  @param[out] NeedErase          TRUE if programming Buffer needs some bits
+                                 to go from 0 to 1, i.e. an erase.
+
+  @retval EFI_SUCCESS            Operation succeeded.
+  @retval Others                 An error has occurred.
+**/
+STATIC
+EFI_STATUS
+FlashCompareCommand (
+  IN  UINTN   ByteAddress,
+  IN  UINT8   *Buffer,
+  IN  UINT32  Length,
+  OUT BOOLEAN *Identical,
+  OUT BOOLEAN *NeedErase
+  )
+{
+  EFI_STATUS Status;
+  UINTN      Remain, NumRead;
+  UINTN      Count = 0;
+  UINTN      Index;
+
+  *Identical = TRUE;
+  *NeedErase = FALSE;
+
+  Remain = Length;
+  while (Remain > 0) {
+    NumRead = (Remain > EFI_MM_MAX_TMP_BUF_SIZE) ? EFI_MM_MAX_TMP_BUF_SIZE : Remain;
+
+    Status = FlashReadCommand (ByteAddress + Count, gFlashLibVirtualBuffer, NumRead);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    if (CompareMem (gFlashLibVirtualBuffer, Buffer + Count, NumRead) != 0) {
+      *Identical = FALSE;
+      for (Index = 0; Index < NumRead; Index++) {
+        if ((gFlashLibVirtualBuffer[Index] & Buffer[Count + Index]) != Buffer[Count + Index]) {
+          *NeedErase = TRUE;
+          return EFI_SUCCESS;
+        }
+      }
+    }
+
     Remain -= NumRead;
     Count += NumRead;
   }
 
   return EFI_SUCCESS;
 }
+
+/**
+  Update a region of the Flash with the content of Buffer.
+
+  This combines erase, write and verify. The region is handled one
+  sector (or the part of a sector it covers) at a time. Parts which
+  already hold the data are left untouched, and a part is only erased
+  when the new data cannot be programmed over the current content.
+
+  @param[in] ByteAddress         Start address of the region.
+  @param[in] Buffer              Pointer to the data buffer.
+  @param[in] Length              Number of bytes to update.
+
+  @retval EFI_SUCCESS            Operation succeeded.
+  @retval EFI_INVALID_PARAMETER  Buffer is NULL or Length is Zero.
+  @retval EFI_DEVICE_ERROR       The data read back does not match Buffer.
+  @retval Others                 An error has occurred.
+**/
+EFI_STATUS
+EFIAPI
+FlashUpdateCommand (
+  IN  UINTN  ByteAddress,
+  IN  VOID   *Buffer,
+  IN  UINT32 Length
+  )
+{
+  EFI_STATUS Status;
+  UINT64     SectorInfo;
+  UINT32     SectorSize;
+  UINTN      Offset;
+  UINT32     Size;
+  BOOLEAN    Identical;
+  BOOLEAN    NeedErase;
+
+  if (Buffer == NULL || Length == 0) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Status = FlashGetSectorSize (&SectorInfo);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+  SectorSize = (UINT32)SectorInfo;
+
+  for (Offset = 0; Offset < Length; Offset += Size) {
+    //
+    // Do not cross a sector boundary, so the data of a sector which
+    // already matches is never erased.
+    //
+    Size = SectorSize - (UINT32)((ByteAddress + Offset) % SectorSize);
+    Size = MIN (Size, Length - (UINT32)Offset);
+
+    Status = FlashCompareCommand (
+               ByteAddress + Offset,
+               (UINT8 *)Buffer + Offset,
+               Size,
+               &Identical,
+               &NeedErase
+               );
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    if (Identical) {
+      continue;
+    }
+
+    if (NeedErase) {
+      Status = FlashEraseCommand (ByteAddress + Offset, Size);
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
+    }
+
+    Status = FlashWriteCommand (ByteAddress + Offset, (UINT8 *)Buffer + Offset, Size);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    //
+    // Verify the sector
+    //
+    Status = FlashCompareCommand (
+               ByteAddress + Offset,
+               (UINT8 *)Buffer + Offset,
+               Size,
+               &Identical,
+               &NeedErase
+               );
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    if (!Identical) {
+      DEBUG ((DEBUG_ERROR, "%a: Verify failed at 0x%llx\n", __FUNCTION__, ByteAddress + Offset));
+      return EFI_DEVICE_ERROR;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
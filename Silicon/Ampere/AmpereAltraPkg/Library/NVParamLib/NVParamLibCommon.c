@@ -15,6 +15,47 @@
 
 #include "NVParamLibCommon.h"
 
+//
+// Results of the parameter reads of this boot, indexed by parameter
+// number. Entries are dropped when the parameter is set or cleared.
+//
+STATIC NVPARAM_CACHE_ENTRY mNVParamCache[NVPARAM_CACHE_ENTRIES];
+
+/**
+  Get the cache entry of a parameter.
+
+  @param[in]  Param               Parameter ID.
+
+  @retval Pointer to the cache entry the parameter maps to.
+**/
+STATIC
+NVPARAM_CACHE_ENTRY *
+NVParamCacheEntry (
+  IN UINT32 Param
+  )
+{
+  return &mNVParamCache[(Param / NVPARAM_SIZE) % NVPARAM_CACHE_ENTRIES];
+}
+
+/**
+  Drop a parameter from the cache.
+
+  @param[in]  Param               Parameter ID.
+**/
+STATIC
+VOID
+NVParamCacheInvalidate (
+  IN UINT32 Param
+  )
+{
+  NVPARAM_CACHE_ENTRY *Entry;
+
+  Entry = NVParamCacheEntry (Param);
+  if (Entry->Param == Param) {
+    Entry->Valid = FALSE;
+  }
+}
+
 /**
   Retrieve a non-volatile parameter.
 
@@ -41,11 +82,24 @@ NVParamGet (
   EFI_MM_COMMUNICATE_NVPARAM_RESPONSE MmNVParamRes;
   EFI_STATUS                          Status;
   UINT64                              MmData[5];
+  NVPARAM_CACHE_ENTRY                 *Entry;
 
   if (Val == NULL) {
     return EFI_INVALID_PARAMETER;
   }
 
+  //
+  // The read permission is part of the key, so a cached value is
+  // only returned to callers which were allowed to read it.
+  //
+  Entry = NVParamCacheEntry (Param);
+  if (Entry->Valid && Entry->Param == Param && Entry->ACLRd == ACLRd) {
+    if (!EFI_ERROR (Entry->Status)) {
+      *Val = Entry->Value;
+    }
+    return Entry->Status;
+  }
+
   MmData[0] = MM_NVPARAM_FUNC_READ;
   MmData[1] = Param;
   MmData[2] = (UINT64)ACLRd;
@@ -63,9 +117,18 @@ NVParamGet (
   switch (MmNVParamRes.Status) {
   case MM_NVPARAM_RES_SUCCESS:
     *Val = (UINT32)MmNVParamRes.Value;
+    Entry->Valid = TRUE;
+    Entry->Param = Param;
+    Entry->ACLRd = ACLRd;
+    Entry->Value = *Val;
+    Entry->Status = EFI_SUCCESS;
     return EFI_SUCCESS;
 
   case MM_NVPARAM_RES_NOT_SET:
+    Entry->Valid = TRUE;
+    Entry->Param = Param;
+    Entry->ACLRd = ACLRd;
+    Entry->Status = EFI_NOT_FOUND;
     return EFI_NOT_FOUND;
 
   case MM_NVPARAM_RES_NO_PERM:
@@ -109,6 +172,8 @@ NVParamSet (
   EFI_STATUS                          Status;
   UINT64                              MmData[5];
 
+  NVParamCacheInvalidate (Param);
+
   MmData[0] = MM_NVPARAM_FUNC_WRITE;
   MmData[1] = Param;
   MmData[2] = (UINT64)ACLRd;
@@ -164,6 +229,8 @@ NVParamClr (
   EFI_STATUS                          Status;
   UINT64                              MmData[5];
 
+  NVParamCacheInvalidate (Param);
+
   MmData[0] = MM_NVPARAM_FUNC_CLEAR;
   MmData[1] = Param;
   MmData[2] = 0;
@@ -210,6 +277,8 @@ NVParamClrAll (
   EFI_STATUS                          Status;
   UINT64                              MmData[5];
 
+  ZeroMem (mNVParamCache, sizeof (mNVParamCache));
+
   MmData[0] = MM_NVPARAM_FUNC_CLEAR_ALL;
 
   Status = NVParamMmCommunicate (
@@ -233,3 +302,76 @@ NVParamClrAll (
     return EFI_INVALID_PARAMETER;
   }
 }
+
+/**
+  Retrieve a set of non-volatile parameters.
+
+  Each entry is looked up as with NVParamGet() and gets its own
+  Status. Parameters already read during this boot are served from
+  the parameter cache.
+
+  @param[in, out] Entries         Array of parameters to retrieve.
+  @param[in]      Count           Number of entries in the array.
+
+  @retval EFI_SUCCESS             All entries were processed, check the
+                                  Status of each entry.
+  @retval EFI_INVALID_PARAMETER   Entries is NULL.
+**/
+EFI_STATUS
+NVParamGetBulk (
+  IN OUT NV_PARAM_ENTRY *Entries,
+  IN     UINTN          Count
+  )
+{
+  UINTN Index;
+
+  if (Entries == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  for (Index = 0; Index < Count; Index++) {
+    Entries[Index].Status = NVParamGet (
+                              Entries[Index].Param,
+                              Entries[Index].ACLRd,
+                              &Entries[Index].Val
+                              );
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Set a set of non-volatile parameters.
+
+  Each entry is set as with NVParamSet() and gets its own Status.
+
+  @param[in, out] Entries         Array of parameters to set.
+  @param[in]      Count           Number of entries in the array.
+
+  @retval EFI_SUCCESS             All entries were processed, check the
+                                  Status of each entry.
+  @retval EFI_INVALID_PARAMETER   Entries is NULL.
+**/
+EFI_STATUS
+NVParamSetBulk (
+  IN OUT NV_PARAM_ENTRY *Entries,
+  IN     UINTN          Count
+  )
+{
+  UINTN Index;
+
+  if (Entries == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  for (Index = 0; Index < Count; Index++) {
+    Entries[Index].Status = NVParamSet (
+                              Entries[Index].Param,
+                              Entries[Index].ACLRd,
+                              Entries[Index].ACLWr,
+                              Entries[Index].Val
+                              );
+  }
+
+  return EFI_SUCCESS;
+}
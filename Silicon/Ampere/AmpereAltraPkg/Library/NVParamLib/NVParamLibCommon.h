@@ -21,6 +21,11 @@
 #define MM_NVPARAM_RES_NO_PERM            0xAABBCC02
 #define MM_NVPARAM_RES_FAIL               0xAABBCCFF
 
+//
+// Number of entries of the direct-mapped parameter cache
+//
+#define NVPARAM_CACHE_ENTRIES             256
+
 #pragma pack (1)
 
 typedef struct {
@@ -47,6 +52,14 @@ typedef struct {
 
 #pragma pack ()
 
+typedef struct {
+  BOOLEAN    Valid;
+  UINT16     ACLRd;
+  UINT32     Param;
+  UINT32     Value;
+  EFI_STATUS Status;
+} NVPARAM_CACHE_ENTRY;
+
 /**
   Provides an interface to access the NVParam services via MM interface.
 
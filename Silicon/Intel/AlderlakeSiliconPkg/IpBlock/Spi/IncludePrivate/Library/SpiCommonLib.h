@@ -12,12 +12,9 @@
 //
 // Maximum time allowed while waiting the SPI cycle to complete
 //  Wait Time = 6 seconds = 6000000 microseconds
-//  Wait Period = 10 microseconds
 //
 #define SPI_WAIT_TIME   6000000     ///< Wait Time = 6 seconds = 6000000 microseconds
 
-#define SPI_WAIT_PERIOD 10          ///< Wait Period = 10 microseconds
-
 ///
 /// Flash cycle Type
 ///
@@ -9,6 +9,7 @@
 #include <Library/IoLib.h>
 #include <Library/DebugLib.h>
 #include <Library/BaseMemoryLib.h>
+#include <Library/CacheMaintenanceLib.h>
 #include <IndustryStandard/Pci30.h>
 #include <Library/PmcLib.h>
 #include <Library/PciSegmentLib.h>
@@ -22,6 +23,7 @@
 
 #define DEFAULT_CPU_STRAP_BASE_OFFSET 0x300 // Default CPU Straps base offset
 #define B_SPI_MEM_HSFSC_SAVE_MASK     (B_SPI_MEM_HSFSC_FDBC_MASK | B_SPI_MEM_HSFSC_CYCLE_MASK)
+#define SPI_BIOS_MMIO_WINDOW_SIZE     SIZE_16MB // Top of the BIOS region decoded right below 4GB
 
 /**
   Initialize an SPI protocol instance.
@@ -265,6 +267,56 @@ PchPmTimerStallRuntimeSafe (
   }
 }
 
+/**
+  Poll HSFSC until SCIP is cleared or SPI_WAIT_TIME has elapsed.
+
+  The status is polled back to back and the elapsed time is accumulated from the
+  ACPI PM timer, so the completion is seen as soon as the cycle ends instead of
+  after a fixed stall.
+
+  @param[in]  SpiInstance          Pointer to SpiInstance
+  @param[in]  PchSpiBar0           SPI MMIO address
+  @param[out] Hsfsc                Last value read from HSFSC
+
+  @retval TRUE                    SCIP is cleared.
+  @retval FALSE                   Time out while waiting SCIP to be cleared.
+**/
+STATIC
+BOOLEAN
+WaitForScipClear (
+  IN     SPI_INSTANCE       *SpiInstance,
+  IN     UINTN              PchSpiBar0,
+  OUT    UINT32             *Hsfsc
+  )
+{
+  UINT32        LastTick;
+  UINT32        CurrentTick;
+  UINT64        ElapsedTicks;
+  UINT64        TimeoutTicks;
+
+  //
+  // The timer frequency is 3.579545 MHz. It is read at least once per poll, well
+  // within the 4.6 seconds it takes to wrap, so the masked difference of two
+  // consecutive reads is always the time elapsed between them.
+  //
+  TimeoutTicks = MultU64x32 (SPI_WAIT_TIME, 358) / 100;
+  ElapsedTicks = 0;
+  LastTick     = IoRead32 ((UINTN) (SpiInstance->PchAcpiBase + R_ACPI_IO_PM1_TMR)) & B_ACPI_IO_PM1_TMR_TMR_VAL;
+
+  for (;;) {
+    *Hsfsc = MmioRead32 (PchSpiBar0 + R_SPI_MEM_HSFSC);
+    if ((*Hsfsc & B_SPI_MEM_HSFSC_SCIP) == 0) {
+      return TRUE;
+    }
+    if (ElapsedTicks >= TimeoutTicks) {
+      return FALSE;
+    }
+    CurrentTick   = IoRead32 ((UINTN) (SpiInstance->PchAcpiBase + R_ACPI_IO_PM1_TMR)) & B_ACPI_IO_PM1_TMR_TMR_VAL;
+    ElapsedTicks += (CurrentTick - LastTick) & B_ACPI_IO_PM1_TMR_TMR_VAL;
+    LastTick      = CurrentTick;
+  }
+}
+
 /**
   Wait execution cycle to complete on the SPI interface.
 
@@ -284,33 +336,23 @@ WaitForSpiCycleComplete (
   IN     BOOLEAN            ErrorCheck
   )
 {
-  UINT64        WaitTicks;
-  UINT64        WaitCount;
   UINT32        Data32;
   SPI_INSTANCE  *SpiInstance;
 
   SpiInstance       = SPI_INSTANCE_FROM_SPIPROTOCOL (This);
 
-  //
-  // Convert the wait period allowed into to tick count
-  //
-  WaitCount = SPI_WAIT_TIME / SPI_WAIT_PERIOD;
   //
   // Wait for the SPI cycle to complete.
   //
-  for (WaitTicks = 0; WaitTicks < WaitCount; WaitTicks++) {
-    Data32 = MmioRead32 (PchSpiBar0 + R_SPI_MEM_HSFSC);
-    if ((Data32 & B_SPI_MEM_HSFSC_SCIP) == 0) {
-      MmioWrite8 (PchSpiBar0 + R_SPI_MEM_HSFSC, B_SPI_MEM_HSFSC_FCERR | B_SPI_MEM_HSFSC_FDONE);
-      if (((Data32 & B_SPI_MEM_HSFSC_FCERR) != 0) && (ErrorCheck == TRUE)) {
-        return FALSE;
-      } else {
-        return TRUE;
-      }
-    }
-    PchPmTimerStallRuntimeSafe (SpiInstance->PchAcpiBase, SPI_WAIT_PERIOD);
+  if (!WaitForScipClear (SpiInstance, PchSpiBar0, &Data32)) {
+    return FALSE;
+  }
+  MmioWrite8 (PchSpiBar0 + R_SPI_MEM_HSFSC, B_SPI_MEM_HSFSC_FCERR | B_SPI_MEM_HSFSC_FDONE);
+  if (((Data32 & B_SPI_MEM_HSFSC_FCERR) != 0) && (ErrorCheck == TRUE)) {
+    return FALSE;
+  } else {
+    return TRUE;
   }
-  return FALSE;
 }
 
 /**
@@ -331,8 +373,6 @@ WaitForScipNoClear (
   IN      UINTN               PchSpiBar0
   )
 {
-  UINT64        WaitTicks;
-  UINT64        WaitCount;
   SPI_INSTANCE  *SpiInstance;
   UINT32        Data32;
 
@@ -341,15 +381,7 @@ WaitForScipNoClear (
   //
   // Wait for the SPI cycle to complete.
   //
-  WaitCount = SPI_WAIT_TIME / SPI_WAIT_PERIOD;
-  for (WaitTicks = 0; WaitTicks < WaitCount; WaitTicks++) {
-    Data32 = MmioRead32 (PchSpiBar0 + R_SPI_MEM_HSFSC);
-    if ((Data32 & B_SPI_MEM_HSFSC_SCIP) == 0) {
-      return TRUE;
-    }
-    PchPmTimerStallRuntimeSafe (SpiInstance->PchAcpiBase, SPI_WAIT_PERIOD);
-  }
-  return FALSE;
+  return WaitForScipClear (SpiInstance, PchSpiBar0, &Data32);
 }
 
 /**
@@ -428,6 +460,55 @@ SetHsfscFdone (
   WaitForScipNoClear (This, PchSpiBar0);
 }
 
+/**
+  Get the address a flash linear address range is decoded at in the memory-mapped
+  BIOS window. The top SPI_BIOS_MMIO_WINDOW_SIZE bytes of the BIOS region are
+  decoded right below 4GB.
+
+  @param[in]  This                Pointer to the PCH_SPI_PROTOCOL instance.
+  @param[in]  HardwareSpiAddr     The Flash Linear Address of the range.
+  @param[in]  ByteCount           Number of bytes in the range.
+  @param[out] MmioAddress         Address the range starts at in the memory-mapped BIOS window.
+
+  @retval TRUE                    The whole range is decoded in the memory-mapped BIOS window.
+  @retval FALSE                   The range is not, or not entirely, decoded in the window.
+**/
+STATIC
+BOOLEAN
+GetBiosMmioAddress (
+  IN     PCH_SPI_PROTOCOL   *This,
+  IN     UINT32             HardwareSpiAddr,
+  IN     UINT32             ByteCount,
+  OUT    UINTN              *MmioAddress
+  )
+{
+  EFI_STATUS      Status;
+  UINT32          BiosBase;
+  UINT32          BiosSize;
+  UINT32          BiosLimit;
+  UINT32          WindowBase;
+
+  Status = SpiProtocolGetRegionAddress (This, FlashRegionBios, &BiosBase, &BiosSize);
+  if (EFI_ERROR (Status) || (BiosSize == 0)) {
+    return FALSE;
+  }
+
+  //
+  // The range must start inside the window and end at or below the BIOS region limit.
+  // Check the start against the limit first, so the remaining size cannot wrap.
+  //
+  BiosLimit  = BiosBase + BiosSize;
+  WindowBase = BiosLimit - MIN (BiosSize, SPI_BIOS_MMIO_WINDOW_SIZE);
+  if ((HardwareSpiAddr < WindowBase) ||
+      (HardwareSpiAddr >= BiosLimit) ||
+      (ByteCount > BiosLimit - HardwareSpiAddr)) {
+    return FALSE;
+  }
+
+  *MmioAddress = (UINTN) (BASE_4GB - (BiosLimit - HardwareSpiAddr));
+  return TRUE;
+}
+
 /**
   This function sends the programmed SPI command to the device.
 
@@ -473,6 +554,9 @@ SendSpiCmd (
   BOOLEAN         HsfscFdoneSave;
   BOOLEAN         HsfscFcerrSave;
   BOOLEAN         RestoreState;
+  UINT32          FlushSpiAddr;
+  UINT32          FlushByteCount;
+  UINTN           FlushMmioAddress;
 
   //
   // For flash write, there is a requirement that all CPU threads are in SMM
@@ -489,6 +573,7 @@ SendSpiCmd (
   SpiBaseAddress    = SpiInstance->PchSpiBase;
   ABase             = SpiInstance->PchAcpiBase;
   RestoreState      = FALSE;
+  FlushByteCount    = 0;
 
   //
   // Disable SMIs to make sure normal mode flash access is not interrupted by an SMI
@@ -574,6 +659,16 @@ SendSpiCmd (
     goto SendSpiCmdEnd;
   }
 
+  //
+  // The flash content changed by a write or erase cycle must not be read back
+  // from stale cache lines of the memory-mapped BIOS window.
+  //
+  if ((FlashCycleType == FlashCycleWrite) ||
+      (FlashCycleType == FlashCycleErase)) {
+    FlushSpiAddr   = HardwareSpiAddr;
+    FlushByteCount = ByteCount;
+  }
+
   //
   // Check for PCH SPI hardware sequencing required commands
   //
@@ -787,6 +882,10 @@ SendSpiCmdEnd:
       (UINT8) ~B_SPI_CFG_BC_SRC,
       BiosCtlSave
       );
+    if ((FlushByteCount != 0) &&
+        GetBiosMmioAddress (This, FlushSpiAddr, FlushByteCount, &FlushMmioAddress)) {
+      WriteBackInvalidateDataCacheRange ((VOID *) FlushMmioAddress, FlushByteCount);
+    }
   }
   ReleaseSpiBar0 (SpiInstance);
 
@@ -823,6 +922,21 @@ SpiProtocolFlashRead (
   )
 {
   EFI_STATUS        Status;
+  UINT32            RegionBase;
+  UINT32            RegionSize;
+  UINTN             MmioAddress;
+
+  //
+  // Serve the read from the memory-mapped BIOS window when the whole range is
+  // decoded there, instead of moving it 64 bytes per hardware sequencing cycle.
+  //
+  Status = SpiProtocolGetRegionAddress (This, FlashRegionType, &RegionBase, &RegionSize);
+  if (!EFI_ERROR (Status) &&
+      (Address <= RegionSize) && (ByteCount <= RegionSize - Address) &&
+      GetBiosMmioAddress (This, RegionBase + Address, ByteCount, &MmioAddress)) {
+    CopyMem (Buffer, (VOID *) MmioAddress, ByteCount);
+    return EFI_SUCCESS;
+  }
 
   //
   // Sends the command to the SPI interface to execute.
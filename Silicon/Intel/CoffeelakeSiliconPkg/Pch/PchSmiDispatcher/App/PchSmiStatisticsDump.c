@@ -0,0 +1,311 @@
+/** @file
+  Shell application that dumps the SMI latency statistics collected by the PCH SMI dispatcher.
+
+  Usage: PchSmiStatisticsDump [-r]
+    -r    Reset the counters after they are dumped.
+
+  The entries are sorted by their longest measured duration. The TSC frequency used to
+  convert ticks to microseconds is measured against the boot services Stall ().
+
+  Copyright (c) 2021, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/DebugLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiLib.h>
+#include <Protocol/SmmCommunication.h>
+#include <Protocol/ShellParameters.h>
+#include <Guid/PiSmmCommunicationRegionTable.h>
+#include <PchSmiStatistics.h>
+
+#define TSC_CALIBRATION_STALL_US  10000
+
+GLOBAL_REMOVE_IF_UNREFERENCED CONST CHAR8 *mPchSmiStatisticsTypeName[PchSmiStatisticsTypeMax] = {
+  "Dispatcher",
+  "Source",
+  "Child",
+  "SwSmi"
+};
+
+/**
+  Find a buffer in the SMM communication region that is at least MinimalSize bytes.
+
+  @param[in]  MinimalSize         Minimal size of the buffer
+  @param[out] Size                Size of the buffer
+
+  @retval NULL                    No buffer is available
+  @retval Others                  Address of the buffer
+**/
+UINT8 *
+GetCommunicationBuffer (
+  IN  UINTN  MinimalSize,
+  OUT UINTN  *Size
+  )
+{
+  EFI_STATUS                               Status;
+  EDKII_PI_SMM_COMMUNICATION_REGION_TABLE  *PiSmmCommunicationRegionTable;
+  EFI_MEMORY_DESCRIPTOR                    *Entry;
+  UINT32                                   Index;
+
+  Status = EfiGetSystemConfigurationTable (
+             &gEdkiiPiSmmCommunicationRegionTableGuid,
+             (VOID **) &PiSmmCommunicationRegionTable
+             );
+  if (EFI_ERROR (Status)) {
+    return NULL;
+  }
+
+  Entry = (EFI_MEMORY_DESCRIPTOR *) (PiSmmCommunicationRegionTable + 1);
+  for (Index = 0; Index < PiSmmCommunicationRegionTable->NumberOfEntries; Index++) {
+    if (Entry->Type == EfiConventionalMemory) {
+      *Size = EFI_PAGES_TO_SIZE ((UINTN) Entry->NumberOfPages);
+      if (*Size >= MinimalSize) {
+        return (UINT8 *) (UINTN) Entry->PhysicalStart;
+      }
+    }
+    Entry = (EFI_MEMORY_DESCRIPTOR *) ((UINT8 *) Entry + PiSmmCommunicationRegionTable->DescriptorSize);
+  }
+
+  return NULL;
+}
+
+/**
+  Send a command to the PCH SMI statistics handler.
+
+  @param[in]      SmmCommunication  SMM communication protocol
+  @param[in, out] CommBuffer        Communication buffer, the command follows the communicate header
+  @param[in]      CommandSize       Size of the command
+
+  @retval EFI_SUCCESS             The command is done.
+  @retval Others                  The command failed or the handler is not installed.
+**/
+EFI_STATUS
+SendCommand (
+  IN     EFI_SMM_COMMUNICATION_PROTOCOL  *SmmCommunication,
+  IN OUT UINT8                           *CommBuffer,
+  IN     UINTN                           CommandSize
+  )
+{
+  EFI_STATUS                           Status;
+  EFI_SMM_COMMUNICATE_HEADER           *CommHeader;
+  PCH_SMI_STATISTICS_PARAMETER_HEADER  *Header;
+  UINTN                                CommSize;
+
+  CommHeader = (EFI_SMM_COMMUNICATE_HEADER *) CommBuffer;
+  CopyGuid (&CommHeader->HeaderGuid, &gPchSmiStatisticsGuid);
+  CommHeader->MessageLength = CommandSize;
+
+  Header               = (PCH_SMI_STATISTICS_PARAMETER_HEADER *) CommHeader->Data;
+  Header->DataLength   = (UINT32) CommandSize;
+  Header->ReturnStatus = (UINT64) -1;
+
+  CommSize = OFFSET_OF (EFI_SMM_COMMUNICATE_HEADER, Data) + CommandSize;
+  Status   = SmmCommunication->Communicate (SmmCommunication, CommBuffer, &CommSize);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+  if (Header->ReturnStatus != 0) {
+    return EFI_UNSUPPORTED;
+  }
+  return EFI_SUCCESS;
+}
+
+/**
+  Convert TSC ticks to microseconds.
+
+  @param[in] Ticks                TSC ticks
+  @param[in] TicksPerUs           TSC ticks per microsecond
+
+  @return Microseconds
+**/
+UINT64
+TicksToUs (
+  IN UINT64  Ticks,
+  IN UINT64  TicksPerUs
+  )
+{
+  return DivU64x64Remainder (Ticks, TicksPerUs, NULL);
+}
+
+/**
+  Check if the -r option is passed to the application.
+
+  @param[in] ImageHandle          The image handle of the application
+
+  @retval TRUE                    The counters should be reset after the dump.
+  @retval FALSE                   The counters should be kept.
+**/
+BOOLEAN
+IsResetRequested (
+  IN EFI_HANDLE  ImageHandle
+  )
+{
+  EFI_STATUS                     Status;
+  EFI_SHELL_PARAMETERS_PROTOCOL  *ShellParameters;
+  UINTN                          Index;
+
+  Status = gBS->HandleProtocol (ImageHandle, &gEfiShellParametersProtocolGuid, (VOID **) &ShellParameters);
+  if (EFI_ERROR (Status)) {
+    return FALSE;
+  }
+
+  for (Index = 1; Index < ShellParameters->Argc; Index++) {
+    if ((StrCmp (ShellParameters->Argv[Index], L"-r") == 0) ||
+        (StrCmp (ShellParameters->Argv[Index], L"-R") == 0)) {
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+/**
+  Dump the SMI latency statistics of the PCH SMI dispatcher.
+
+  @param[in] ImageHandle          The firmware allocated handle for the EFI image.
+  @param[in] SystemTable          A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS             The statistics are dumped.
+  @retval Others                  The statistics are not available.
+**/
+EFI_STATUS
+EFIAPI
+PchSmiStatisticsDumpEntryPoint (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  EFI_STATUS                             Status;
+  EFI_SMM_COMMUNICATION_PROTOCOL         *SmmCommunication;
+  UINT8                                  *CommBuffer;
+  UINTN                                  CommBufferSize;
+  PCH_SMI_STATISTICS_PARAMETER_GET_INFO  *GetInfo;
+  PCH_SMI_STATISTICS_PARAMETER_GET_DATA  *GetData;
+  PCH_SMI_STATISTICS_PARAMETER_HEADER    *Reset;
+  PCH_SMI_STATISTICS_ENTRY               *Entries;
+  PCH_SMI_STATISTICS_ENTRY               Temp;
+  UINTN                                  EntryCount;
+  UINTN                                  EntriesPerCall;
+  UINTN                                  Offset;
+  UINTN                                  Index;
+  UINTN                                  Index2;
+  UINT64                                 StartTsc;
+  UINT64                                 TicksPerUs;
+  UINT64                                 AverageTicks;
+  CONST CHAR8                            *TypeName;
+
+  Status = gBS->LocateProtocol (&gEfiSmmCommunicationProtocolGuid, NULL, (VOID **) &SmmCommunication);
+  if (EFI_ERROR (Status)) {
+    Print (L"PchSmiStatisticsDump: Locate SmmCommunication protocol - %r\n", Status);
+    return Status;
+  }
+
+  CommBuffer = GetCommunicationBuffer (EFI_PAGE_SIZE, &CommBufferSize);
+  if (CommBuffer == NULL) {
+    Print (L"PchSmiStatisticsDump: No SMM communication buffer\n");
+    return EFI_NOT_FOUND;
+  }
+
+  //
+  // Get the number of entries
+  //
+  GetInfo = (PCH_SMI_STATISTICS_PARAMETER_GET_INFO *) ((EFI_SMM_COMMUNICATE_HEADER *) CommBuffer)->Data;
+  GetInfo->Header.Command = PCH_SMI_STATISTICS_COMMAND_GET_INFO;
+  GetInfo->EntryCount     = 0;
+  Status = SendCommand (SmmCommunication, CommBuffer, sizeof (*GetInfo));
+  if (EFI_ERROR (Status)) {
+    Print (L"PchSmiStatisticsDump: GetInfo - %r, is PcdPchSmiStatisticsEnable set?\n", Status);
+    return Status;
+  }
+  EntryCount = (UINTN) GetInfo->EntryCount;
+
+  Entries = AllocateZeroPool (EntryCount * sizeof (PCH_SMI_STATISTICS_ENTRY) + 1);
+  if (Entries == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  //
+  // Get the entries, as many as fit in the communication buffer at a time
+  //
+  EntriesPerCall = (CommBufferSize - OFFSET_OF (EFI_SMM_COMMUNICATE_HEADER, Data) - sizeof (PCH_SMI_STATISTICS_PARAMETER_GET_DATA)) /
+                   sizeof (PCH_SMI_STATISTICS_ENTRY);
+  GetData = (PCH_SMI_STATISTICS_PARAMETER_GET_DATA *) ((EFI_SMM_COMMUNICATE_HEADER *) CommBuffer)->Data;
+  for (Offset = 0; Offset < EntryCount; Offset += (UINTN) GetData->EntryCount) {
+    GetData->Header.Command = PCH_SMI_STATISTICS_COMMAND_GET_DATA;
+    GetData->EntryOffset    = Offset;
+    GetData->EntryCount     = MIN (EntriesPerCall, EntryCount - Offset);
+    Status = SendCommand (
+               SmmCommunication,
+               CommBuffer,
+               sizeof (*GetData) + (UINTN) GetData->EntryCount * sizeof (PCH_SMI_STATISTICS_ENTRY)
+               );
+    if (EFI_ERROR (Status) || (GetData->EntryCount == 0)) {
+      //
+      // The handlers changed since GetInfo, dump what we have.
+      //
+      EntryCount = Offset;
+      break;
+    }
+    CopyMem (&Entries[Offset], GetData + 1, (UINTN) GetData->EntryCount * sizeof (PCH_SMI_STATISTICS_ENTRY));
+  }
+
+  //
+  // Sort the entries by their longest duration
+  //
+  for (Index = 1; Index < EntryCount; Index++) {
+    CopyMem (&Temp, &Entries[Index], sizeof (Temp));
+    for (Index2 = Index; (Index2 > 0) && (Entries[Index2 - 1].Counter.MaxTicks < Temp.Counter.MaxTicks); Index2--) {
+      CopyMem (&Entries[Index2], &Entries[Index2 - 1], sizeof (Temp));
+    }
+    CopyMem (&Entries[Index2], &Temp, sizeof (Temp));
+  }
+
+  //
+  // Measure the TSC frequency
+  //
+  StartTsc = AsmReadTsc ();
+  gBS->Stall (TSC_CALIBRATION_STALL_US);
+  TicksPerUs = DivU64x32 (AsmReadTsc () - StartTsc, TSC_CALIBRATION_STALL_US);
+  if (TicksPerUs == 0) {
+    TicksPerUs = 1;
+  }
+
+  Print (L"PCH SMI latency statistics, TSC %ld MHz\n", TicksPerUs);
+  Print (L"Type        SubType   Handler             Count       Min(us)   Max(us)   Avg(us)   LastEntryTsc\n");
+  for (Index = 0; Index < EntryCount; Index++) {
+    if (Entries[Index].Type < PchSmiStatisticsTypeMax) {
+      TypeName = mPchSmiStatisticsTypeName[Entries[Index].Type];
+    } else {
+      TypeName = "Unknown";
+    }
+    AverageTicks = 0;
+    if (Entries[Index].Counter.Count != 0) {
+      AverageTicks = DivU64x64Remainder (Entries[Index].Counter.TotalTicks, Entries[Index].Counter.Count, NULL);
+    }
+    Print (
+      L"%-10a  %08x  %016lx  %10ld  %8ld  %8ld  %8ld  %016lx\n",
+      TypeName,
+      Entries[Index].SubType,
+      Entries[Index].Handler,
+      Entries[Index].Counter.Count,
+      TicksToUs (Entries[Index].Counter.MinTicks, TicksPerUs),
+      TicksToUs (Entries[Index].Counter.MaxTicks, TicksPerUs),
+      TicksToUs (AverageTicks, TicksPerUs),
+      Entries[Index].Counter.LastEntryTsc
+      );
+  }
+
+  FreePool (Entries);
+
+  if (IsResetRequested (ImageHandle)) {
+    Reset = (PCH_SMI_STATISTICS_PARAMETER_HEADER *) ((EFI_SMM_COMMUNICATE_HEADER *) CommBuffer)->Data;
+    Reset->Command = PCH_SMI_STATISTICS_COMMAND_RESET;
+    Status = SendCommand (SmmCommunication, CommBuffer, sizeof (*Reset));
+    Print (L"PchSmiStatisticsDump: Reset - %r\n", Status);
+  }
+
+  return EFI_SUCCESS;
+}
@@ -2197,9 +2197,13 @@ PchSmiTypeCallbackDispatcher (
   PCH_SMI_TYPES                         PchSmiType;
   UINTN                                 RpIndex;
   PCH_PCIE_SMI_RP_CONTEXT               RpContext;
+  UINT64                                StartTsc;
+  UINTN                                 RemoveCount;
 
-  PchSmiType = Record->PchSmiType;
-  Status     = EFI_SUCCESS;
+  PchSmiType  = Record->PchSmiType;
+  Status      = EFI_SUCCESS;
+  StartTsc    = PCH_SMI_STATISTICS_START ();
+  RemoveCount = mRecordRemoveCount;
 
   switch (PchSmiType) {
     case PchTcoSmiMchType:
@@ -2243,6 +2247,13 @@ PchSmiTypeCallbackDispatcher (
       break;
   }
 
+  //
+  // Skip the sample if the callback unregistered a child, Record may be freed.
+  //
+  if (!EFI_ERROR (Status) && (RemoveCount == mRecordRemoveCount)) {
+    PchSmmStatisticsUpdate (&Record->Statistics, StartTsc);
+  }
+
   return Status;
 }
 
@@ -29,6 +29,7 @@
 #include <Library/SmmServicesTableLib.h>
 #include <Library/ReportStatusCodeLib.h>
 #include <Library/PerformanceLib.h>
+#include <Library/PcdLib.h>
 #include <Protocol/SmmReadyToLock.h>
 #include <IndustryStandard/Pci30.h>
 #include <Library/PchCycleDecodingLib.h>
@@ -46,6 +47,7 @@
 #include <Protocol/PchEspiSmiDispatch.h>
 #include <Protocol/IoTrapExDispatch.h>
 #include <Library/PmcLib.h>
+#include <PchSmiStatistics.h>
 #include "IoTrap.h"
 
 #define EFI_BAD_POINTER          0xAFAFAFAFAFAFAFAFULL
@@ -404,6 +406,24 @@ VOID
   CONST PCH_SMM_SOURCE_DESC * SrcDesc
   );
 
+///
+/// "SOURCE" RECORD
+/// One record for every unique SMI source in the callback database. The database
+/// records of the same source are linked to it, so the dispatcher tests every
+/// source once per pass and only walks the records of the source that fired.
+///
+#define SOURCE_RECORD_SIGNATURE SIGNATURE_32 ('S', 'R', 'C', 'R')
+
+typedef struct {
+  UINT32                        Signature;
+  LIST_ENTRY                    Link;
+  PCH_SMM_SOURCE_DESC           SrcDesc;
+  LIST_ENTRY                    RecordList;
+  PCH_SMI_STATISTICS_COUNTER    Statistics;
+} SOURCE_RECORD;
+
+#define SOURCE_RECORD_FROM_LINK(_record)  CR (_record, SOURCE_RECORD, Link, SOURCE_RECORD_SIGNATURE)
+
 ///
 /// "DATABASE" RECORD
 /// Linked list data structures
@@ -418,6 +438,11 @@ struct _DATABASE_RECORD {
   /// Status and Enable bit description
   ///
   PCH_SMM_SOURCE_DESC           SrcDesc;
+  ///
+  /// Source record of SrcDesc and the link in its record list
+  ///
+  SOURCE_RECORD                 *Source;
+  LIST_ENTRY                    SourceLink;
 
   ///
   /// Callback function
@@ -454,9 +479,14 @@ struct _DATABASE_RECORD {
   /// Indicate the PCH SMI types.
   ///
   PCH_SMI_TYPES                 PchSmiType;
+  ///
+  /// Latency counter of the dispatch function
+  ///
+  PCH_SMI_STATISTICS_COUNTER    Statistics;
 };
 
 #define DATABASE_RECORD_FROM_LINK(_record)  CR (_record, DATABASE_RECORD, Link, DATABASE_RECORD_SIGNATURE)
+#define DATABASE_RECORD_FROM_SOURCE_LINK(_record)  CR (_record, DATABASE_RECORD, SourceLink, DATABASE_RECORD_SIGNATURE)
 #define DATABASE_RECORD_FROM_CHILDCONTEXT(_record)  CR (_record, DATABASE_RECORD, ChildContext, DATABASE_RECORD_SIGNATURE)
 
 ///
@@ -586,6 +616,7 @@ typedef struct {
 ///
 typedef struct {
   LIST_ENTRY                  CallbackDataBase;
+  LIST_ENTRY                  SourceDataBase;
   EFI_HANDLE                  SmiHandle;
   EFI_HANDLE                  InstallMultProtHandle;
   PCH_SMM_QUALIFIED_PROTOCOL  Protocols[PCH_SMM_PROTOCOL_TYPE_MAX];
@@ -595,6 +626,36 @@ extern PRIVATE_DATA           mPrivateData;
 extern UINT16                 mAcpiBaseAddr;
 extern UINT16                 mTcoBaseAddr;
 
+///
+/// SMI latency statistics, collected when PcdPchSmiStatisticsEnable is TRUE
+///
+extern PCH_SMI_STATISTICS_COUNTER  mDispatcherStatistics;
+extern UINTN                       mRecordRemoveCount;
+
+#define PCH_SMI_STATISTICS_START()  (PcdGetBool (PcdPchSmiStatisticsEnable) ? AsmReadTsc () : 0)
+
+/**
+  Add the time elapsed since StartTsc to a latency counter.
+  Nothing is done if PcdPchSmiStatisticsEnable is FALSE.
+
+  @param[in, out] Counter         Latency counter to update
+  @param[in]      StartTsc        TSC value read by PCH_SMI_STATISTICS_START when the measured code was entered
+**/
+VOID
+PchSmmStatisticsUpdate (
+  IN OUT PCH_SMI_STATISTICS_COUNTER  *Counter,
+  IN     UINT64                      StartTsc
+  );
+
+/**
+  Register the SMM communication handler that reports the SMI latency statistics.
+  Nothing is done if PcdPchSmiStatisticsEnable is FALSE.
+**/
+VOID
+PchSmmStatisticsInit (
+  VOID
+  );
+
 /**
   The internal function used to create and insert a database record
 
@@ -611,6 +672,17 @@ SmmCoreInsertRecord (
   OUT EFI_HANDLE                        *DispatchHandle
   );
 
+/**
+  The internal function used to take a database record out of the database.
+  The source record of the database record is freed with its last database record.
+
+  @param[in]  Record                    Record to remove from database.
+**/
+VOID
+SmmCoreRemoveRecord (
+  IN  DATABASE_RECORD                   *Record
+  );
+
 /**
   Get the Sleep type
 
@@ -689,6 +761,21 @@ PchSwDispatchInit (
   VOID
   );
 
+/**
+  Get the latency counter of the software SMI callback registered for a SwSmiInputValue.
+
+  @param[in]  SwSmiInputValue     Software SMI input value
+  @param[out] Callback            Callback function registered for the value
+
+  @retval NULL                    No callback is registered for the value
+  @retval Others                  Pointer to the latency counter of the callback
+**/
+PCH_SMI_STATISTICS_COUNTER *
+PchSwSmiGetStatistics (
+  IN  UINTN                         SwSmiInputValue,
+  OUT EFI_SMM_HANDLER_ENTRY_POINT2  *Callback
+  );
+
 /**
   Check whether sleep type of two contexts match
 
@@ -0,0 +1,298 @@
+/** @file
+  SMI latency statistics of the PCH SMI dispatcher and the SMM communication
+  handler that reports them.
+
+  Copyright (c) 2021, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+#include "PchSmmHelpers.h"
+#include <Library/SmmMemLib.h>
+
+typedef
+VOID
+(*PCH_SMI_STATISTICS_VISIT) (
+  IN OUT VOID                        *Context,
+  IN     UINT32                      Type,
+  IN     UINT32                      SubType,
+  IN     UINT64                      Handler,
+  IN OUT PCH_SMI_STATISTICS_COUNTER  *Counter
+  );
+
+typedef struct {
+  UINT64                    Index;
+  UINT64                    EntryOffset;
+  UINT64                    EntryCount;
+  UINT64                    Returned;
+  PCH_SMI_STATISTICS_ENTRY  *Entry;
+} PCH_SMI_STATISTICS_WALK_CONTEXT;
+
+/**
+  Add the time elapsed since StartTsc to a latency counter.
+  Nothing is done if PcdPchSmiStatisticsEnable is FALSE.
+
+  @param[in, out] Counter         Latency counter to update
+  @param[in]      StartTsc        TSC value read by PCH_SMI_STATISTICS_START when the measured code was entered
+**/
+VOID
+PchSmmStatisticsUpdate (
+  IN OUT PCH_SMI_STATISTICS_COUNTER  *Counter,
+  IN     UINT64                      StartTsc
+  )
+{
+  UINT64  Ticks;
+
+  if (!PcdGetBool (PcdPchSmiStatisticsEnable)) {
+    return;
+  }
+
+  Ticks = AsmReadTsc () - StartTsc;
+  if ((Counter->Count == 0) || (Ticks < Counter->MinTicks)) {
+    Counter->MinTicks = Ticks;
+  }
+  if (Ticks > Counter->MaxTicks) {
+    Counter->MaxTicks = Ticks;
+  }
+  Counter->TotalTicks  += Ticks;
+  Counter->LastEntryTsc = StartTsc;
+  Counter->Count++;
+}
+
+/**
+  Call Visit for every latency counter of the PCH SMI dispatcher.
+
+  @param[in]      Visit           Function to call for every counter
+  @param[in, out] Context         Context passed to Visit
+**/
+STATIC
+VOID
+PchSmmStatisticsWalk (
+  IN     PCH_SMI_STATISTICS_VISIT  Visit,
+  IN OUT VOID                      *Context
+  )
+{
+  LIST_ENTRY                    *Link;
+  SOURCE_RECORD                 *Source;
+  DATABASE_RECORD               *Record;
+  PCH_SMI_STATISTICS_COUNTER    *Counter;
+  EFI_SMM_HANDLER_ENTRY_POINT2  Callback;
+  UINTN                         SwSmiInputValue;
+
+  Visit (Context, PchSmiStatisticsDispatcher, 0, 0, &mDispatcherStatistics);
+
+  for (Link = GetFirstNode (&mPrivateData.SourceDataBase);
+       !IsNull (&mPrivateData.SourceDataBase, Link);
+       Link = GetNextNode (&mPrivateData.SourceDataBase, Link)) {
+    Source = SOURCE_RECORD_FROM_LINK (Link);
+    Visit (
+      Context,
+      PchSmiStatisticsSource,
+      Source->SrcDesc.Sts[0].Reg.Data.raw,
+      Source->SrcDesc.Sts[0].Bit,
+      &Source->Statistics
+      );
+  }
+
+  for (Link = GetFirstNode (&mPrivateData.CallbackDataBase);
+       !IsNull (&mPrivateData.CallbackDataBase, Link);
+       Link = GetNextNode (&mPrivateData.CallbackDataBase, Link)) {
+    Record = DATABASE_RECORD_FROM_LINK (Link);
+    if (Record->ProtocolType == PchSmiDispatchType) {
+      Visit (
+        Context,
+        PchSmiStatisticsChild,
+        (UINT32) Record->ProtocolType | ((UINT32) Record->PchSmiType << 16),
+        (UINT64) (UINTN) Record->PchSmiCallback,
+        &Record->Statistics
+        );
+    } else {
+      Visit (
+        Context,
+        PchSmiStatisticsChild,
+        (UINT32) Record->ProtocolType,
+        (UINT64) (UINTN) Record->Callback,
+        &Record->Statistics
+        );
+    }
+  }
+
+  for (SwSmiInputValue = 0; SwSmiInputValue < MAXIMUM_SWI_VALUE; SwSmiInputValue++) {
+    Counter = PchSwSmiGetStatistics (SwSmiInputValue, &Callback);
+    if (Counter != NULL) {
+      Visit (Context, PchSmiStatisticsSwCallback, (UINT32) SwSmiInputValue, (UINT64) (UINTN) Callback, Counter);
+    }
+  }
+}
+
+/**
+  Count the latency counters.
+**/
+STATIC
+VOID
+PchSmmStatisticsCount (
+  IN OUT VOID                        *Context,
+  IN     UINT32                      Type,
+  IN     UINT32                      SubType,
+  IN     UINT64                      Handler,
+  IN OUT PCH_SMI_STATISTICS_COUNTER  *Counter
+  )
+{
+  ((PCH_SMI_STATISTICS_WALK_CONTEXT *) Context)->Index++;
+}
+
+/**
+  Copy the latency counters in the range requested by the caller.
+**/
+STATIC
+VOID
+PchSmmStatisticsCopy (
+  IN OUT VOID                        *Context,
+  IN     UINT32                      Type,
+  IN     UINT32                      SubType,
+  IN     UINT64                      Handler,
+  IN OUT PCH_SMI_STATISTICS_COUNTER  *Counter
+  )
+{
+  PCH_SMI_STATISTICS_WALK_CONTEXT  *Walk;
+  PCH_SMI_STATISTICS_ENTRY         *Entry;
+
+  Walk = Context;
+  if ((Walk->Index >= Walk->EntryOffset) && (Walk->Returned < Walk->EntryCount)) {
+    Entry          = &Walk->Entry[Walk->Returned];
+    Entry->Type    = Type;
+    Entry->SubType = SubType;
+    Entry->Handler = Handler;
+    CopyMem (&Entry->Counter, Counter, sizeof (PCH_SMI_STATISTICS_COUNTER));
+    Walk->Returned++;
+  }
+  Walk->Index++;
+}
+
+/**
+  Reset the latency counters.
+**/
+STATIC
+VOID
+PchSmmStatisticsReset (
+  IN OUT VOID                        *Context,
+  IN     UINT32                      Type,
+  IN     UINT32                      SubType,
+  IN     UINT64                      Handler,
+  IN OUT PCH_SMI_STATISTICS_COUNTER  *Counter
+  )
+{
+  ZeroMem (Counter, sizeof (PCH_SMI_STATISTICS_COUNTER));
+}
+
+/**
+  SMM communication handler that reports the SMI latency statistics.
+
+  @param[in]     DispatchHandle  The unique handle assigned to this handler by SmiHandlerRegister().
+  @param[in]     Context         Points to an optional handler context which was specified when the
+                                 handler was registered.
+  @param[in,out] CommBuffer      A pointer to a collection of data in memory that will
+                                 be conveyed from a non-SMM environment into an SMM environment.
+  @param[in,out] CommBufferSize  The size of the CommBuffer.
+
+  @retval EFI_SUCCESS            The command is handled or ignored.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+PchSmiStatisticsHandler (
+  IN     EFI_HANDLE                   DispatchHandle,
+  IN     CONST VOID                   *Context         OPTIONAL,
+  IN OUT VOID                         *CommBuffer      OPTIONAL,
+  IN OUT UINTN                        *CommBufferSize  OPTIONAL
+  )
+{
+  UINTN                                   TempCommBufferSize;
+  PCH_SMI_STATISTICS_PARAMETER_HEADER     *Header;
+  PCH_SMI_STATISTICS_PARAMETER_GET_INFO   *GetInfo;
+  PCH_SMI_STATISTICS_PARAMETER_GET_DATA   *GetData;
+  PCH_SMI_STATISTICS_PARAMETER_GET_DATA   GetDataIn;
+  PCH_SMI_STATISTICS_WALK_CONTEXT         Walk;
+
+  if ((CommBuffer == NULL) || (CommBufferSize == NULL)) {
+    return EFI_SUCCESS;
+  }
+
+  TempCommBufferSize = *CommBufferSize;
+  if (TempCommBufferSize < sizeof (PCH_SMI_STATISTICS_PARAMETER_HEADER)) {
+    DEBUG ((DEBUG_ERROR, "PchSmiStatisticsHandler: SMM communication buffer size invalid!\n"));
+    return EFI_SUCCESS;
+  }
+  if (!SmmIsBufferOutsideSmmValid ((UINTN) CommBuffer, TempCommBufferSize)) {
+    DEBUG ((DEBUG_ERROR, "PchSmiStatisticsHandler: SMM communication buffer in SMRAM or overflow!\n"));
+    return EFI_SUCCESS;
+  }
+
+  ZeroMem (&Walk, sizeof (Walk));
+  Header               = (PCH_SMI_STATISTICS_PARAMETER_HEADER *) CommBuffer;
+  Header->ReturnStatus = (UINT64) -1;
+
+  switch (Header->Command) {
+    case PCH_SMI_STATISTICS_COMMAND_GET_INFO:
+      if (TempCommBufferSize != sizeof (PCH_SMI_STATISTICS_PARAMETER_GET_INFO)) {
+        DEBUG ((DEBUG_ERROR, "PchSmiStatisticsHandler: SMM communication buffer size invalid!\n"));
+        return EFI_SUCCESS;
+      }
+      GetInfo = (PCH_SMI_STATISTICS_PARAMETER_GET_INFO *) CommBuffer;
+      PchSmmStatisticsWalk (PchSmmStatisticsCount, &Walk);
+      GetInfo->EntryCount   = Walk.Index;
+      Header->ReturnStatus  = 0;
+      break;
+
+    case PCH_SMI_STATISTICS_COMMAND_GET_DATA:
+      if (TempCommBufferSize < sizeof (PCH_SMI_STATISTICS_PARAMETER_GET_DATA)) {
+        DEBUG ((DEBUG_ERROR, "PchSmiStatisticsHandler: SMM communication buffer size invalid!\n"));
+        return EFI_SUCCESS;
+      }
+      //
+      // Copy the parameters to SMRAM before using them
+      //
+      GetData = (PCH_SMI_STATISTICS_PARAMETER_GET_DATA *) CommBuffer;
+      CopyMem (&GetDataIn, GetData, sizeof (GetDataIn));
+      if (GetDataIn.EntryCount > (TempCommBufferSize - sizeof (GetDataIn)) / sizeof (PCH_SMI_STATISTICS_ENTRY)) {
+        DEBUG ((DEBUG_ERROR, "PchSmiStatisticsHandler: SMM communication buffer size invalid!\n"));
+        return EFI_SUCCESS;
+      }
+      Walk.EntryOffset = GetDataIn.EntryOffset;
+      Walk.EntryCount  = GetDataIn.EntryCount;
+      Walk.Entry       = (PCH_SMI_STATISTICS_ENTRY *) (GetData + 1);
+      PchSmmStatisticsWalk (PchSmmStatisticsCopy, &Walk);
+      GetData->EntryCount   = Walk.Returned;
+      Header->ReturnStatus  = 0;
+      break;
+
+    case PCH_SMI_STATISTICS_COMMAND_RESET:
+      PchSmmStatisticsWalk (PchSmmStatisticsReset, &Walk);
+      Header->ReturnStatus  = 0;
+      break;
+
+    default:
+      break;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Register the SMM communication handler that reports the SMI latency statistics.
+  Nothing is done if PcdPchSmiStatisticsEnable is FALSE.
+**/
+VOID
+PchSmmStatisticsInit (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+  EFI_HANDLE  DispatchHandle;
+
+  if (!PcdGetBool (PcdPchSmiStatisticsEnable)) {
+    return;
+  }
+
+  DispatchHandle = NULL;
+  Status = gSmst->SmiHandlerRegister (PchSmiStatisticsHandler, &gPchSmiStatisticsGuid, &DispatchHandle);
+  ASSERT_EFI_ERROR (Status);
+}
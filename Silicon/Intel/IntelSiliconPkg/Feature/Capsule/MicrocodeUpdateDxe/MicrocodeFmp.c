@@ -558,20 +558,15 @@ InitializeFitMicrocodeInfo (
     }
   }
 
+  SortFitMicrocodeInfo (MicrocodeFmpPrivate);
+
   //
   // Every microcode should have a FIT microcode entry.
   //
   for (MicrocodeIndex = 0; MicrocodeIndex < MicrocodeFmpPrivate->DescriptorCount; MicrocodeIndex++) {
     MicrocodeInfo = &MicrocodeFmpPrivate->MicrocodeInfo[MicrocodeIndex];
-    for (FitMicrocodeIndex = 0; FitMicrocodeIndex < MicrocodeFmpPrivate->FitMicrocodeEntryCount; FitMicrocodeIndex++) {
-      FitMicrocodeInfo = &MicrocodeFmpPrivate->FitMicrocodeInfo[FitMicrocodeIndex];
-      if (MicrocodeInfo->MicrocodeEntryPoint == FitMicrocodeInfo->MicrocodeEntryPoint) {
-        FitMicrocodeInfo->TotalSize = MicrocodeInfo->TotalSize;
-        FitMicrocodeInfo->InUse = MicrocodeInfo->InUse;
-        break;
-      }
-    }
-    if (FitMicrocodeIndex >= MicrocodeFmpPrivate->FitMicrocodeEntryCount) {
+    FitMicrocodeIndex = GetFitMicrocodeIndex (MicrocodeFmpPrivate, MicrocodeInfo->MicrocodeEntryPoint);
+    if (FitMicrocodeIndex == (UINTN)-1) {
       DEBUG ((
         DEBUG_ERROR,
         "InitializeFitMicrocodeInfo - There is no FIT microcode entry for Microcode (0x%x)\n",
@@ -579,10 +574,11 @@ InitializeFitMicrocodeInfo (
         ));
       goto ErrorExit;
     }
+    FitMicrocodeInfo = &MicrocodeFmpPrivate->FitMicrocodeInfo[FitMicrocodeIndex];
+    FitMicrocodeInfo->TotalSize = MicrocodeInfo->TotalSize;
+    FitMicrocodeInfo->InUse = MicrocodeInfo->InUse;
   }
 
-  SortFitMicrocodeInfo (MicrocodeFmpPrivate);
-
   //
   // Check overlap.
   //
@@ -603,8 +599,15 @@ InitializeFitMicrocodeInfo (
         ));
       goto ErrorExit;
     }
+    FitMicrocodeInfo->AvailableSize = (UINTN) MicrocodeEntryPointNext - (UINTN) MicrocodeEntryPoint;
   }
 
+  //
+  // The last FIT microcode entry can use the rest of the Microcode region.
+  //
+  FitMicrocodeInfo = &MicrocodeFmpPrivate->FitMicrocodeInfo[MicrocodeFmpPrivate->FitMicrocodeEntryCount - 1];
+  FitMicrocodeInfo->AvailableSize = (UINTN) MicrocodePatchAddress + MicrocodePatchRegionSize - (UINTN) FitMicrocodeInfo->MicrocodeEntryPoint;
+
   return EFI_SUCCESS;
 
 ErrorExit:
@@ -759,25 +762,25 @@ InitializeProcessorInfo (
     return EFI_OUT_OF_RESOURCES;
   }
 
+  MicrocodeFmpPrivate->LoadBuffer = AllocateZeroPool (sizeof(MICROCODE_LOAD_BUFFER) * MicrocodeFmpPrivate->ProcessorCount);
+  if (MicrocodeFmpPrivate->LoadBuffer == NULL) {
+    FreePool (MicrocodeFmpPrivate->ProcessorInfo);
+    MicrocodeFmpPrivate->ProcessorInfo = NULL;
+    return EFI_OUT_OF_RESOURCES;
+  }
+
   for (Index = 0; Index < NumberOfProcessors; Index++) {
     MicrocodeFmpPrivate->ProcessorInfo[Index].CpuIndex = Index;
     MicrocodeFmpPrivate->ProcessorInfo[Index].MicrocodeIndex = (UINTN)-1;
-    if (Index == BspIndex) {
-      CollectProcessorInfo (&MicrocodeFmpPrivate->ProcessorInfo[Index]);
-    } else {
-      Status = MpService->StartupThisAP (
-                            MpService,
-                            CollectProcessorInfo,
-                            Index,
-                            NULL,
-                            0,
-                            &MicrocodeFmpPrivate->ProcessorInfo[Index],
-                            NULL
-                            );
-      ASSERT_EFI_ERROR(Status);
-    }
   }
 
+  //
+  // Collect the information of all processors in parallel, each one
+  // into its own slot.
+  //
+  Status = StartupAllProcessors (MicrocodeFmpPrivate, CollectProcessorInfoAp);
+  ASSERT_EFI_ERROR(Status);
+
   return EFI_SUCCESS;
 }
 
@@ -919,6 +922,7 @@ InitializePrivateData (
   Status = InitializeMicrocodeDescriptor(MicrocodeFmpPrivate);
   if (EFI_ERROR(Status)) {
     FreePool (MicrocodeFmpPrivate->ProcessorInfo);
+    FreePool (MicrocodeFmpPrivate->LoadBuffer);
     DEBUG((DEBUG_ERROR, "InitializeMicrocodeDescriptor - %r\n", Status));
     return Status;
   }
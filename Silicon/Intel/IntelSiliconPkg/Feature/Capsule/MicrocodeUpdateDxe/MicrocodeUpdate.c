@@ -108,10 +108,57 @@ LoadMicrocode (
 }
 
 /**
-  Load Microcode on an Application Processor.
-  The function prototype for invoking a function on an Application Processor.
+  Run a procedure on all enabled processors.
 
-  @param[in,out] Buffer  The pointer to private data buffer.
+  The procedure is dispatched to all APs at once with a blocking StartupAllAPs()
+  and then run on the BSP. The procedure gets the Microcode driver private data
+  and must only write to the per-CPU slot of the processor it runs on, so no
+  locking is needed to aggregate the results.
+
+  @param[in]  MicrocodeFmpPrivate        The Microcode driver private data
+  @param[in]  Procedure                  The procedure to run.
+
+  @retval EFI_SUCCESS  The procedure has run on all enabled processors.
+  @retval others       The procedure could not be dispatched to the APs.
+**/
+EFI_STATUS
+StartupAllProcessors (
+  IN MICROCODE_FMP_PRIVATE_DATA  *MicrocodeFmpPrivate,
+  IN EFI_AP_PROCEDURE            Procedure
+  )
+{
+  EFI_STATUS                           Status;
+  EFI_MP_SERVICES_PROTOCOL             *MpService;
+
+  MpService = MicrocodeFmpPrivate->MpService;
+
+  Status = MpService->StartupAllAPs (
+                        MpService,
+                        Procedure,
+                        FALSE,
+                        NULL,
+                        0,
+                        MicrocodeFmpPrivate,
+                        NULL
+                        );
+  //
+  // EFI_NOT_STARTED means there is no enabled AP.
+  //
+  if (EFI_ERROR(Status) && (Status != EFI_NOT_STARTED)) {
+    DEBUG((DEBUG_ERROR, "StartupAllAPs - %r\n", Status));
+    return Status;
+  }
+
+  Procedure (MicrocodeFmpPrivate);
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Load Microcode on all processors which have a per-CPU load address.
+  The function prototype for invoking a function on all processors.
+
+  @param[in,out] Buffer  The pointer to the Microcode driver private data.
 **/
 VOID
 EFIAPI
@@ -119,51 +166,70 @@ MicrocodeLoadAp (
   IN OUT VOID  *Buffer
   )
 {
+  EFI_STATUS                           Status;
+  MICROCODE_FMP_PRIVATE_DATA           *MicrocodeFmpPrivate;
   MICROCODE_LOAD_BUFFER                *MicrocodeLoadBuffer;
+  UINTN                                CpuIndex;
+
+  MicrocodeFmpPrivate = Buffer;
+  Status = MicrocodeFmpPrivate->MpService->WhoAmI (MicrocodeFmpPrivate->MpService, &CpuIndex);
+  if (EFI_ERROR(Status) || (CpuIndex >= MicrocodeFmpPrivate->ProcessorCount)) {
+    return;
+  }
 
-  MicrocodeLoadBuffer = Buffer;
-  MicrocodeLoadBuffer->Revision = LoadMicrocode (MicrocodeLoadBuffer->Address);
+  MicrocodeLoadBuffer = &MicrocodeFmpPrivate->LoadBuffer[CpuIndex];
+  if (MicrocodeLoadBuffer->Address != 0) {
+    MicrocodeLoadBuffer->Revision = LoadMicrocode (MicrocodeLoadBuffer->Address);
+  }
 }
 
 /**
-  Load new Microcode on this processor
+  Load new Microcode on the target processor and on all other processors
+  with the same processor signature and platform ID.
 
   @param[in]  MicrocodeFmpPrivate        The Microcode driver private data
-  @param[in]  CpuIndex                   The index of the processor.
+  @param[in]  CpuIndex                   The index of the target processor.
   @param[in]  Address                    The address of new Microcode.
 
-  @return  Loaded Microcode signature.
+  @return  Loaded Microcode signature of the target processor.
 
 **/
 UINT32
-LoadMicrocodeOnThis (
+LoadMicrocodeOnAll (
   IN  MICROCODE_FMP_PRIVATE_DATA  *MicrocodeFmpPrivate,
   IN  UINTN                       CpuIndex,
   IN  UINT64                      Address
   )
 {
   EFI_STATUS                           Status;
-  EFI_MP_SERVICES_PROTOCOL             *MpService;
-  MICROCODE_LOAD_BUFFER                MicrocodeLoadBuffer;
+  PROCESSOR_INFO                       *ProcessorInfo;
+  MICROCODE_LOAD_BUFFER                *MicrocodeLoadBuffer;
+  UINTN                                Index;
 
-  if (CpuIndex == MicrocodeFmpPrivate->BspIndex) {
-    return LoadMicrocode (Address);
-  } else {
-    MpService = MicrocodeFmpPrivate->MpService;
-    MicrocodeLoadBuffer.Address = Address;
-    MicrocodeLoadBuffer.Revision = 0;
-    Status = MpService->StartupThisAP (
-                          MpService,
-                          MicrocodeLoadAp,
-                          CpuIndex,
-                          NULL,
-                          0,
-                          &MicrocodeLoadBuffer,
-                          NULL
-                          );
-    ASSERT_EFI_ERROR(Status);
-    return MicrocodeLoadBuffer.Revision;
+  ProcessorInfo = MicrocodeFmpPrivate->ProcessorInfo;
+  MicrocodeLoadBuffer = MicrocodeFmpPrivate->LoadBuffer;
+  for (Index = 0; Index < MicrocodeFmpPrivate->ProcessorCount; Index++) {
+    MicrocodeLoadBuffer[Index].Revision = 0;
+    if ((ProcessorInfo[Index].ProcessorSignature == ProcessorInfo[CpuIndex].ProcessorSignature) &&
+        (ProcessorInfo[Index].PlatformId == ProcessorInfo[CpuIndex].PlatformId)) {
+      MicrocodeLoadBuffer[Index].Address = Address;
+    } else {
+      MicrocodeLoadBuffer[Index].Address = 0;
+    }
+  }
+
+  Status = StartupAllProcessors (MicrocodeFmpPrivate, MicrocodeLoadAp);
+  ASSERT_EFI_ERROR(Status);
+
+  for (Index = 0; Index < MicrocodeFmpPrivate->ProcessorCount; Index++) {
+    if ((MicrocodeLoadBuffer[Index].Address != 0) &&
+        (MicrocodeLoadBuffer[Index].Revision != MicrocodeLoadBuffer[CpuIndex].Revision)) {
+      DEBUG((DEBUG_ERROR, "LoadMicrocodeOnAll - CPU 0x%x Revision 0x%x\n", Index, MicrocodeLoadBuffer[Index].Revision));
+    }
+    MicrocodeLoadBuffer[Index].Address = 0;
   }
+
+  return MicrocodeLoadBuffer[CpuIndex].Revision;
 }
 
 /**
@@ -186,6 +252,31 @@ CollectProcessorInfo (
   ProcessorInfo->MicrocodeRevision = GetCurrentMicrocodeSignature();
 }
 
+/**
+  Collect processor information into the per-CPU slot of the calling processor.
+  The function prototype for invoking a function on all processors.
+
+  @param[in,out] Buffer  The pointer to the Microcode driver private data.
+**/
+VOID
+EFIAPI
+CollectProcessorInfoAp (
+  IN OUT VOID  *Buffer
+  )
+{
+  EFI_STATUS                  Status;
+  MICROCODE_FMP_PRIVATE_DATA  *MicrocodeFmpPrivate;
+  UINTN                       CpuIndex;
+
+  MicrocodeFmpPrivate = Buffer;
+  Status = MicrocodeFmpPrivate->MpService->WhoAmI (MicrocodeFmpPrivate->MpService, &CpuIndex);
+  if (EFI_ERROR(Status) || (CpuIndex >= MicrocodeFmpPrivate->ProcessorCount)) {
+    return;
+  }
+
+  CollectProcessorInfo (&MicrocodeFmpPrivate->ProcessorInfo[CpuIndex]);
+}
+
 /**
   Get current Microcode information.
 
@@ -578,7 +669,7 @@ VerifyMicrocode (
   // try load MCU
   //
   if (TryLoad) {
-    CurrentRevision = LoadMicrocodeOnThis(MicrocodeFmpPrivate, ProcessorInfo->CpuIndex, (UINTN)MicrocodeEntryPoint + sizeof(CPU_MICROCODE_HEADER));
+    CurrentRevision = LoadMicrocodeOnAll(MicrocodeFmpPrivate, ProcessorInfo->CpuIndex, (UINTN)MicrocodeEntryPoint + sizeof(CPU_MICROCODE_HEADER));
     if (MicrocodeEntryPoint->UpdateRevision != CurrentRevision) {
       DEBUG((DEBUG_ERROR, "VerifyMicrocode - fail on LoadMicrocode\n"));
       *LastAttemptStatus = LAST_ATTEMPT_STATUS_ERROR_AUTH_ERROR;
@@ -592,6 +683,83 @@ VerifyMicrocode (
   return EFI_SUCCESS;
 }
 
+/**
+  Get the index of a Microcode entrypoint in MicrocodeInfo.
+
+  MicrocodeInfo is collected by walking the Microcode region, so it is sorted
+  by MicrocodeEntryPoint and can be binary searched.
+
+  @param[in]  MicrocodeFmpPrivate        The Microcode driver private data
+  @param[in]  MicrocodeEntryPoint        Microcode entrypoint
+
+  @return The index of the Microcode entrypoint, or (UINTN)-1 if it is not found.
+**/
+UINTN
+GetMicrocodeIndex (
+  IN MICROCODE_FMP_PRIVATE_DATA              *MicrocodeFmpPrivate,
+  IN CPU_MICROCODE_HEADER                    *MicrocodeEntryPoint
+  )
+{
+  UINTN                                   Low;
+  UINTN                                   High;
+  UINTN                                   Middle;
+  CPU_MICROCODE_HEADER                    *MiddleEntryPoint;
+
+  Low = 0;
+  High = MicrocodeFmpPrivate->DescriptorCount;
+  while (Low < High) {
+    Middle = Low + (High - Low) / 2;
+    MiddleEntryPoint = MicrocodeFmpPrivate->MicrocodeInfo[Middle].MicrocodeEntryPoint;
+    if (MiddleEntryPoint == MicrocodeEntryPoint) {
+      return Middle;
+    } else if (MiddleEntryPoint < MicrocodeEntryPoint) {
+      Low = Middle + 1;
+    } else {
+      High = Middle;
+    }
+  }
+
+  return (UINTN)-1;
+}
+
+/**
+  Get the index of a Microcode entrypoint in FitMicrocodeInfo.
+
+  FitMicrocodeInfo must be sorted by MicrocodeEntryPoint.
+
+  @param[in]  MicrocodeFmpPrivate        The Microcode driver private data
+  @param[in]  MicrocodeEntryPoint        Microcode entrypoint
+
+  @return The index of the FIT Microcode entrypoint, or (UINTN)-1 if it is not found.
+**/
+UINTN
+GetFitMicrocodeIndex (
+  IN MICROCODE_FMP_PRIVATE_DATA              *MicrocodeFmpPrivate,
+  IN CPU_MICROCODE_HEADER                    *MicrocodeEntryPoint
+  )
+{
+  UINTN                                   Low;
+  UINTN                                   High;
+  UINTN                                   Middle;
+  CPU_MICROCODE_HEADER                    *MiddleEntryPoint;
+
+  Low = 0;
+  High = MicrocodeFmpPrivate->FitMicrocodeEntryCount;
+  while (Low < High) {
+    Middle = Low + (High - Low) / 2;
+    MiddleEntryPoint = MicrocodeFmpPrivate->FitMicrocodeInfo[Middle].MicrocodeEntryPoint;
+    if (MiddleEntryPoint == MicrocodeEntryPoint) {
+      return Middle;
+    } else if (MiddleEntryPoint < MicrocodeEntryPoint) {
+      Low = Middle + 1;
+    } else {
+      High = Middle;
+    }
+  }
+
+  return (UINTN)-1;
+}
+
 /**
   Get next Microcode entrypoint.
 
@@ -608,20 +776,19 @@ GetNextMicrocode (
 {
   UINTN                                   Index;
 
-  for (Index = 0; Index < MicrocodeFmpPrivate->DescriptorCount; Index++) {
-    if (MicrocodeEntryPoint == MicrocodeFmpPrivate->MicrocodeInfo[Index].MicrocodeEntryPoint) {
-      if (Index == (UINTN)MicrocodeFmpPrivate->DescriptorCount - 1) {
-        // it is last one
-        return NULL;
-      } else {
-        // return next one
-        return MicrocodeFmpPrivate->MicrocodeInfo[Index + 1].MicrocodeEntryPoint;
-      }
-    }
+  Index = GetMicrocodeIndex (MicrocodeFmpPrivate, MicrocodeEntryPoint);
+  if (Index == (UINTN)-1) {
+    ASSERT(FALSE);
+    return NULL;
   }
 
-  ASSERT(FALSE);
-  return NULL;
+  if (Index == (UINTN)MicrocodeFmpPrivate->DescriptorCount - 1) {
+    // it is last one
+    return NULL;
+  }
+
+  // return next one
+  return MicrocodeFmpPrivate->MicrocodeInfo[Index + 1].MicrocodeEntryPoint;
 }
 
 /**
@@ -640,20 +807,19 @@ GetNextFitMicrocode (
 {
   UINTN                                   Index;
 
-  for (Index = 0; Index < MicrocodeFmpPrivate->FitMicrocodeEntryCount; Index++) {
-    if (MicrocodeEntryPoint == MicrocodeFmpPrivate->FitMicrocodeInfo[Index].MicrocodeEntryPoint) {
-      if (Index == (UINTN) MicrocodeFmpPrivate->FitMicrocodeEntryCount - 1) {
-        // it is last one
-        return NULL;
-      } else {
-        // return next one
-        return MicrocodeFmpPrivate->FitMicrocodeInfo[Index + 1].MicrocodeEntryPoint;
-      }
-    }
+  Index = GetFitMicrocodeIndex (MicrocodeFmpPrivate, MicrocodeEntryPoint);
+  if (Index == (UINTN)-1) {
+    ASSERT(FALSE);
+    return NULL;
   }
 
-  ASSERT(FALSE);
-  return NULL;
+  if (Index == (UINTN)MicrocodeFmpPrivate->FitMicrocodeEntryCount - 1) {
+    // it is last one
+    return NULL;
+  }
+
+  // return next one
+  return MicrocodeFmpPrivate->FitMicrocodeInfo[Index + 1].MicrocodeEntryPoint;
 }
 
 /**
@@ -673,26 +839,13 @@ FindEmptyFitMicrocode (
   )
 {
   UINTN                                   Index;
-  CPU_MICROCODE_HEADER                    *MicrocodeEntryPoint;
-  CPU_MICROCODE_HEADER                    *NextMicrocodeEntryPoint;
-  VOID                                    *MicrocodePatchAddress;
-  UINTN                                   MicrocodePatchRegionSize;
-
-  MicrocodePatchAddress = MicrocodeFmpPrivate->MicrocodePatchAddress;
-  MicrocodePatchRegionSize = MicrocodeFmpPrivate->MicrocodePatchRegionSize;
+  FIT_MICROCODE_INFO                      *FitMicrocodeInfo;
 
   for (Index = 0; Index < MicrocodeFmpPrivate->FitMicrocodeEntryCount; Index++) {
-    if (MicrocodeFmpPrivate->FitMicrocodeInfo[Index].Empty) {
-      MicrocodeEntryPoint = MicrocodeFmpPrivate->FitMicrocodeInfo[Index].MicrocodeEntryPoint;
-      NextMicrocodeEntryPoint = GetNextFitMicrocode (MicrocodeFmpPrivate, MicrocodeEntryPoint);
-      if (NextMicrocodeEntryPoint != NULL) {
-        *AvailableSize = (UINTN) NextMicrocodeEntryPoint - (UINTN) MicrocodeEntryPoint;
-      } else {
-        *AvailableSize = (UINTN) MicrocodePatchAddress + MicrocodePatchRegionSize - (UINTN) MicrocodeEntryPoint;
-      }
-      if (*AvailableSize >= ImageSize) {
-        return MicrocodeEntryPoint;
-      }
+    FitMicrocodeInfo = &MicrocodeFmpPrivate->FitMicrocodeInfo[Index];
+    if (FitMicrocodeInfo->Empty && (FitMicrocodeInfo->AvailableSize >= ImageSize)) {
+      *AvailableSize = FitMicrocodeInfo->AvailableSize;
+      return FitMicrocodeInfo->MicrocodeEntryPoint;
     }
   }
 
@@ -716,26 +869,13 @@ FindUnusedFitMicrocode (
   )
 {
   UINTN                                   Index;
-  CPU_MICROCODE_HEADER                    *MicrocodeEntryPoint;
-  CPU_MICROCODE_HEADER                    *NextMicrocodeEntryPoint;
-  VOID                                    *MicrocodePatchAddress;
-  UINTN                                   MicrocodePatchRegionSize;
-
-  MicrocodePatchAddress = MicrocodeFmpPrivate->MicrocodePatchAddress;
-  MicrocodePatchRegionSize = MicrocodeFmpPrivate->MicrocodePatchRegionSize;
+  FIT_MICROCODE_INFO                      *FitMicrocodeInfo;
 
   for (Index = 0; Index < MicrocodeFmpPrivate->FitMicrocodeEntryCount; Index++) {
-    if (!MicrocodeFmpPrivate->FitMicrocodeInfo[Index].InUse) {
-      MicrocodeEntryPoint = MicrocodeFmpPrivate->FitMicrocodeInfo[Index].MicrocodeEntryPoint;
-      NextMicrocodeEntryPoint = GetNextFitMicrocode (MicrocodeFmpPrivate, MicrocodeEntryPoint);
-      if (NextMicrocodeEntryPoint != NULL) {
-        *AvailableSize = (UINTN) NextMicrocodeEntryPoint - (UINTN) MicrocodeEntryPoint;
-      } else {
-        *AvailableSize = (UINTN) MicrocodePatchAddress + MicrocodePatchRegionSize - (UINTN) MicrocodeEntryPoint;
-      }
-      if (*AvailableSize >= ImageSize) {
-        return MicrocodeEntryPoint;
-      }
+    FitMicrocodeInfo = &MicrocodeFmpPrivate->FitMicrocodeInfo[Index];
+    if (!FitMicrocodeInfo->InUse && (FitMicrocodeInfo->AvailableSize >= ImageSize)) {
+      *AvailableSize = FitMicrocodeInfo->AvailableSize;
+      return FitMicrocodeInfo->MicrocodeEntryPoint;
     }
   }
 
@@ -801,6 +941,52 @@ UpdateMicrocode (
   return Status;
 }
 
+/**
+  Update Microcode with an image followed by 0xFF padding.
+
+  @param[in]   Address            The flash address of Microcode.
+  @param[in]   Image              The Microcode image buffer.
+  @param[in]   ImageSize          The size of Microcode image buffer in bytes.
+  @param[in]   TotalSize          The size of the flash range to be written in bytes, including the padding.
+  @param[out]  LastAttemptStatus  The last attempt status, which will be recorded in ESRT and FMP EFI_FIRMWARE_IMAGE_DESCRIPTOR.
+
+  @retval EFI_SUCCESS           The Microcode image is updated.
+  @retval EFI_OUT_OF_RESOURCES  No enough resource for the padded image.
+  @retval EFI_WRITE_PROTECTED   The flash device is read only.
+**/
+EFI_STATUS
+UpdateMicrocodeWithPad (
+  IN UINT64   Address,
+  IN VOID     *Image,
+  IN UINTN    ImageSize,
+  IN UINTN    TotalSize,
+  OUT UINT32  *LastAttemptStatus
+  )
+{
+  EFI_STATUS  Status;
+  UINT8       *Buffer;
+
+  ASSERT (TotalSize >= ImageSize);
+  if (TotalSize == ImageSize) {
+    return UpdateMicrocode (Address, Image, ImageSize, LastAttemptStatus);
+  }
+
+  Buffer = AllocatePool (TotalSize);
+  if (Buffer == NULL) {
+    DEBUG((DEBUG_ERROR, "Fail to allocate Microcode Scratch buffer\n"));
+    *LastAttemptStatus = LAST_ATTEMPT_STATUS_ERROR_INSUFFICIENT_RESOURCES;
+    return EFI_OUT_OF_RESOURCES;
+  }
+  if (ImageSize > 0) {
+    CopyMem (Buffer, Image, ImageSize);
+  }
+  SetMem (Buffer + ImageSize, TotalSize - ImageSize, 0xFF);
+
+  Status = UpdateMicrocode (Address, Buffer, TotalSize, LastAttemptStatus);
+  FreePool (Buffer);
+  return Status;
+}
+
 /**
   Update Microcode flash region with FIT.
 
@@ -826,10 +1012,6 @@ UpdateMicrocodeFlashRegionWithFit (
   UINTN                                   MicrocodePatchRegionSize;
   UINTN                                   TargetTotalSize;
   EFI_STATUS                              Status;
-  VOID                                    *MicrocodePatchScratchBuffer;
-  UINT8                                   *ScratchBufferPtr;
-  UINTN                                   ScratchBufferSize;
-  UINTN                                   RestSize;
   UINTN                                   AvailableSize;
   VOID                                    *NextMicrocodeEntryPoint;
   VOID                                    *EmptyFitMicrocodeEntry;
@@ -840,15 +1022,6 @@ UpdateMicrocodeFlashRegionWithFit (
   MicrocodePatchAddress = MicrocodeFmpPrivate->MicrocodePatchAddress;
   MicrocodePatchRegionSize = MicrocodeFmpPrivate->MicrocodePatchRegionSize;
 
-  MicrocodePatchScratchBuffer = AllocateZeroPool (MicrocodePatchRegionSize);
-  if (MicrocodePatchScratchBuffer == NULL) {
-    DEBUG((DEBUG_ERROR, "Fail to allocate Microcode Scratch buffer\n"));
-    *LastAttemptStatus = LAST_ATTEMPT_STATUS_ERROR_INSUFFICIENT_RESOURCES;
-    return EFI_OUT_OF_RESOURCES;
-  }
-  ScratchBufferPtr = MicrocodePatchScratchBuffer;
-  ScratchBufferSize = 0;
-
   //
   // Target data collection
   //
@@ -892,7 +1065,7 @@ UpdateMicrocodeFlashRegionWithFit (
   //
 
   //
-  // Update based on policy
+  // Update based on policy. Only the FIT slot(s) involved are written.
   //
 
   //
@@ -909,18 +1082,7 @@ UpdateMicrocodeFlashRegionWithFit (
     // |Other |New Image|FF| ...  |      Empty        |
     // +------+---------+--+------+===================+
     //
-    // 1.1. Copy new image
-    CopyMem (ScratchBufferPtr, Image, ImageSize);
-    ScratchBufferSize += ImageSize;
-    ScratchBufferPtr = (UINT8 *)MicrocodePatchScratchBuffer + ScratchBufferSize;
-    // 1.2. Pad 0xFF
-    RestSize = AvailableSize - ImageSize;
-    if (RestSize > 0) {
-      SetMem (ScratchBufferPtr, RestSize, 0xFF);
-      ScratchBufferSize += RestSize;
-      ScratchBufferPtr = (UINT8 *)MicrocodePatchScratchBuffer + ScratchBufferSize;
-    }
-    Status = UpdateMicrocode((UINTN)TargetMicrocodeEntryPoint, MicrocodePatchScratchBuffer, ScratchBufferSize, LastAttemptStatus);
+    Status = UpdateMicrocodeWithPad ((UINTN)TargetMicrocodeEntryPoint, Image, ImageSize, AvailableSize, LastAttemptStatus);
     return Status;
   }
 
@@ -930,27 +1092,12 @@ UpdateMicrocodeFlashRegionWithFit (
   EmptyFitMicrocodeEntry = FindEmptyFitMicrocode (MicrocodeFmpPrivate, ImageSize, &AvailableSize);
   if (EmptyFitMicrocodeEntry != NULL) {
     DEBUG((DEBUG_INFO, "Use empty FIT microcode entry\n"));
-    // 2.1. Copy new image
-    CopyMem (ScratchBufferPtr, Image, ImageSize);
-    ScratchBufferSize += ImageSize;
-    ScratchBufferPtr = (UINT8 *)MicrocodePatchScratchBuffer + ScratchBufferSize;
-    // 2.2. Pad 0xFF
-    RestSize = AvailableSize - ImageSize;
-    if (RestSize > 0) {
-      SetMem (ScratchBufferPtr, RestSize, 0xFF);
-      ScratchBufferSize += RestSize;
-      ScratchBufferPtr = (UINT8 *)MicrocodePatchScratchBuffer + ScratchBufferSize;
-    }
-    Status = UpdateMicrocode ((UINTN) EmptyFitMicrocodeEntry, MicrocodePatchScratchBuffer, ScratchBufferSize, LastAttemptStatus);
+    Status = UpdateMicrocodeWithPad ((UINTN) EmptyFitMicrocodeEntry, Image, ImageSize, AvailableSize, LastAttemptStatus);
     if (!EFI_ERROR (Status) && (TargetMicrocodeEntryPoint != NULL)) {
       //
       // Empty old microcode.
       //
-      ScratchBufferPtr = MicrocodePatchScratchBuffer;
-      SetMem (ScratchBufferPtr, TargetTotalSize, 0xFF);
-      ScratchBufferSize = TargetTotalSize;
-      ScratchBufferPtr = (UINT8 *) MicrocodePatchScratchBuffer + ScratchBufferSize;
-      UpdateMicrocode ((UINTN) TargetMicrocodeEntryPoint, MicrocodePatchScratchBuffer, ScratchBufferSize, LastAttemptStatus);
+      UpdateMicrocodeWithPad ((UINTN) TargetMicrocodeEntryPoint, NULL, 0, TargetTotalSize, LastAttemptStatus);
     }
     return Status;
   }
@@ -961,27 +1108,12 @@ UpdateMicrocodeFlashRegionWithFit (
   UnusedFitMicrocodeEntry = FindUnusedFitMicrocode (MicrocodeFmpPrivate, ImageSize, &AvailableSize);
   if (UnusedFitMicrocodeEntry != NULL) {
     DEBUG((DEBUG_INFO, "Use unused FIT microcode entry\n"));
-    // 3.1. Copy new image
-    CopyMem (ScratchBufferPtr, Image, ImageSize);
-    ScratchBufferSize += ImageSize;
-    ScratchBufferPtr = (UINT8 *)MicrocodePatchScratchBuffer + ScratchBufferSize;
-    // 3.2. Pad 0xFF
-    RestSize = AvailableSize - ImageSize;
-    if (RestSize > 0) {
-      SetMem (ScratchBufferPtr, RestSize, 0xFF);
-      ScratchBufferSize += RestSize;
-      ScratchBufferPtr = (UINT8 *)MicrocodePatchScratchBuffer + ScratchBufferSize;
-    }
-    Status = UpdateMicrocode ((UINTN) UnusedFitMicrocodeEntry, MicrocodePatchScratchBuffer, ScratchBufferSize, LastAttemptStatus);
+    Status = UpdateMicrocodeWithPad ((UINTN) UnusedFitMicrocodeEntry, Image, ImageSize, AvailableSize, LastAttemptStatus);
     if (!EFI_ERROR (Status) && (TargetMicrocodeEntryPoint != NULL)) {
       //
       // Empty old microcode.
       //
-      ScratchBufferPtr = MicrocodePatchScratchBuffer;
-      SetMem (ScratchBufferPtr, TargetTotalSize, 0xFF);
-      ScratchBufferSize = TargetTotalSize;
-      ScratchBufferPtr = (UINT8 *) MicrocodePatchScratchBuffer + ScratchBufferSize;
-      UpdateMicrocode ((UINTN) TargetMicrocodeEntryPoint, MicrocodePatchScratchBuffer, ScratchBufferSize, LastAttemptStatus);
+      UpdateMicrocodeWithPad ((UINTN) TargetMicrocodeEntryPoint, NULL, 0, TargetTotalSize, LastAttemptStatus);
     }
     return Status;
   }
@@ -1037,15 +1169,6 @@ UpdateMicrocodeFlashRegion (
   MicrocodePatchAddress = MicrocodeFmpPrivate->MicrocodePatchAddress;
   MicrocodePatchRegionSize = MicrocodeFmpPrivate->MicrocodePatchRegionSize;
 
-  MicrocodePatchScratchBuffer = AllocateZeroPool (MicrocodePatchRegionSize);
-  if (MicrocodePatchScratchBuffer == NULL) {
-    DEBUG((DEBUG_ERROR, "Fail to allocate Microcode Scratch buffer\n"));
-    *LastAttemptStatus = LAST_ATTEMPT_STATUS_ERROR_INSUFFICIENT_RESOURCES;
-    return EFI_OUT_OF_RESOURCES;
-  }
-  ScratchBufferPtr = MicrocodePatchScratchBuffer;
-  ScratchBufferSize = 0;
-
   //
   // Target data collection
   //
@@ -1096,6 +1219,8 @@ UpdateMicrocodeFlashRegion (
   //        |<-      AvailableSize        ->|
   // |<-UsedRegionSize->|
   //
+  // Everything past UsedRegionSize is already empty, so it is never rewritten.
+  //
 
   //
   // Update based on policy
@@ -1115,18 +1240,13 @@ UpdateMicrocodeFlashRegion (
     // |Other |New Image|FF| ...  |      Empty        |
     // +------+---------+--+------+===================+
     //
-    // 1.1. Copy new image
-    CopyMem (ScratchBufferPtr, Image, ImageSize);
-    ScratchBufferSize += ImageSize;
-    ScratchBufferPtr = (UINT8 *)MicrocodePatchScratchBuffer + ScratchBufferSize;
-    // 1.2. Pad 0xFF
-    RestSize = AvailableSize - ImageSize;
-    if (RestSize > 0) {
-      SetMem (ScratchBufferPtr, RestSize, 0xFF);
-      ScratchBufferSize += RestSize;
-      ScratchBufferPtr = (UINT8 *)MicrocodePatchScratchBuffer + ScratchBufferSize;
+    if (NextMicrocodeEntryPoint == NULL) {
+      //
+      // Only pad till the end of the old image, the rest is empty.
+      //
+      AvailableSize = MAX (ImageSize, TargetTotalSize);
     }
-    Status = UpdateMicrocode((UINTN)TargetMicrocodeEntryPoint, MicrocodePatchScratchBuffer, ScratchBufferSize, LastAttemptStatus);
+    Status = UpdateMicrocodeWithPad ((UINTN)TargetMicrocodeEntryPoint, Image, ImageSize, AvailableSize, LastAttemptStatus);
     return Status;
   }
 
@@ -1157,18 +1277,26 @@ UpdateMicrocodeFlashRegion (
       // |Other |   New Image   | ...  |      Empty     |
       // +------+---------------+------+================+
       //
-      // 2.1. Copy new image
-      CopyMem (ScratchBufferPtr, Image, ImageSize);
-      ScratchBufferSize += ImageSize;
-      ScratchBufferPtr = (UINT8 *)MicrocodePatchScratchBuffer + ScratchBufferSize;
-      // 2.2. Copy rest images after the old image.
+      // Only the old image and the images after it are rewritten.
+      //
+      RestSize = 0;
       if (NextMicrocodeEntryPoint != 0) {
         RestSize = (UINTN)MicrocodePatchAddress + UsedRegionSize - ((UINTN)NextMicrocodeEntryPoint);
-        CopyMem (ScratchBufferPtr, NextMicrocodeEntryPoint, RestSize);
-        ScratchBufferSize += RestSize;
-        ScratchBufferPtr = (UINT8 *)MicrocodePatchScratchBuffer + ScratchBufferSize;
       }
-      Status = UpdateMicrocode((UINTN)TargetMicrocodeEntryPoint, MicrocodePatchScratchBuffer, ScratchBufferSize, LastAttemptStatus);
+      MicrocodePatchScratchBuffer = AllocatePool (ImageSize + RestSize);
+      if (MicrocodePatchScratchBuffer == NULL) {
+        DEBUG((DEBUG_ERROR, "Fail to allocate Microcode Scratch buffer\n"));
+        *LastAttemptStatus = LAST_ATTEMPT_STATUS_ERROR_INSUFFICIENT_RESOURCES;
+        return EFI_OUT_OF_RESOURCES;
+      }
+      // 2.1. Copy new image
+      CopyMem (MicrocodePatchScratchBuffer, Image, ImageSize);
+      // 2.2. Copy rest images after the old image.
+      if (RestSize > 0) {
+        CopyMem ((UINT8 *)MicrocodePatchScratchBuffer + ImageSize, NextMicrocodeEntryPoint, RestSize);
+      }
+      Status = UpdateMicrocode((UINTN)TargetMicrocodeEntryPoint, MicrocodePatchScratchBuffer, ImageSize + RestSize, LastAttemptStatus);
+      FreePool (MicrocodePatchScratchBuffer);
     }
     return Status;
   }
@@ -1189,6 +1317,15 @@ UpdateMicrocodeFlashRegion (
     //
     DEBUG((DEBUG_INFO, "Add new microcode from beginning\n"));
 
+    MicrocodePatchScratchBuffer = AllocatePool (MicrocodePatchRegionSize);
+    if (MicrocodePatchScratchBuffer == NULL) {
+      DEBUG((DEBUG_ERROR, "Fail to allocate Microcode Scratch buffer\n"));
+      *LastAttemptStatus = LAST_ATTEMPT_STATUS_ERROR_INSUFFICIENT_RESOURCES;
+      return EFI_OUT_OF_RESOURCES;
+    }
+    ScratchBufferPtr = MicrocodePatchScratchBuffer;
+    ScratchBufferSize = 0;
+
     MicrocodeCount = MicrocodeFmpPrivate->DescriptorCount;
     MicrocodeInfo = MicrocodeFmpPrivate->MicrocodeInfo;
 
@@ -1210,14 +1347,15 @@ UpdateMicrocodeFlashRegion (
         ScratchBufferPtr = (UINT8 *)MicrocodePatchScratchBuffer + ScratchBufferSize;
       }
     }
-    // 3.3. Pad 0xFF
-    RestSize = MicrocodePatchRegionSize - ScratchBufferSize;
-    if (RestSize > 0) {
+    // 3.3. Pad 0xFF till the end of the old used region
+    if (UsedRegionSize > ScratchBufferSize) {
+      RestSize = UsedRegionSize - ScratchBufferSize;
       SetMem (ScratchBufferPtr, RestSize, 0xFF);
       ScratchBufferSize += RestSize;
       ScratchBufferPtr = (UINT8 *)MicrocodePatchScratchBuffer + ScratchBufferSize;
     }
     Status = UpdateMicrocode((UINTN)MicrocodePatchAddress, MicrocodePatchScratchBuffer, ScratchBufferSize, LastAttemptStatus);
+    FreePool (MicrocodePatchScratchBuffer);
     return Status;
   }
 
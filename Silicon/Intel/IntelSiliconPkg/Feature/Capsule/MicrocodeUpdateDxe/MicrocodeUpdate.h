@@ -58,6 +58,7 @@ typedef struct {
   UINTN                  TotalSize;
   BOOLEAN                InUse;
   BOOLEAN                Empty;
+  UINTN                  AvailableSize;
 } FIT_MICROCODE_INFO;
 
 typedef struct {
@@ -89,6 +90,7 @@ struct _MICROCODE_FMP_PRIVATE_DATA {
   UINTN                                BspIndex;
   UINTN                                ProcessorCount;
   PROCESSOR_INFO                       *ProcessorInfo;
+  MICROCODE_LOAD_BUFFER                *LoadBuffer;
   UINT32                               FitMicrocodeEntryCount;
   FIT_MICROCODE_INFO                   *FitMicrocodeInfo;
 };
@@ -142,6 +144,38 @@ CollectProcessorInfo (
   IN OUT VOID  *Buffer
   );
 
+/**
+  Collect processor information into the per-CPU slot of the calling processor.
+  The function prototype for invoking a function on all processors.
+
+  @param[in,out] Buffer  The pointer to the Microcode driver private data.
+**/
+VOID
+EFIAPI
+CollectProcessorInfoAp (
+  IN OUT VOID  *Buffer
+  );
+
+/**
+  Run a procedure on all enabled processors.
+
+  The procedure is dispatched to all APs at once with a blocking StartupAllAPs()
+  and then run on the BSP. The procedure gets the Microcode driver private data
+  and must only write to the per-CPU slot of the processor it runs on, so no
+  locking is needed to aggregate the results.
+
+  @param[in]  MicrocodeFmpPrivate        The Microcode driver private data
+  @param[in]  Procedure                  The procedure to run.
+
+  @retval EFI_SUCCESS  The procedure has run on all enabled processors.
+  @retval others       The procedure could not be dispatched to the APs.
+**/
+EFI_STATUS
+StartupAllProcessors (
+  IN MICROCODE_FMP_PRIVATE_DATA  *MicrocodeFmpPrivate,
+  IN EFI_AP_PROCEDURE            Procedure
+  );
+
 /**
   Get current Microcode information.
 
@@ -166,6 +200,22 @@ GetMicrocodeInfo (
   OUT MICROCODE_INFO                 *MicrocodeInfo    OPTIONAL
   );
 
+/**
+  Get the index of a Microcode entrypoint in FitMicrocodeInfo.
+
+  FitMicrocodeInfo must be sorted by MicrocodeEntryPoint.
+
+  @param[in]  MicrocodeFmpPrivate        The Microcode driver private data
+  @param[in]  MicrocodeEntryPoint        Microcode entrypoint
+
+  @return The index of the FIT Microcode entrypoint, or (UINTN)-1 if it is not found.
+**/
+UINTN
+GetFitMicrocodeIndex (
+  IN MICROCODE_FMP_PRIVATE_DATA              *MicrocodeFmpPrivate,
+  IN CPU_MICROCODE_HEADER                    *MicrocodeEntryPoint
+  );
+
 /**
   Verify Microcode.
 
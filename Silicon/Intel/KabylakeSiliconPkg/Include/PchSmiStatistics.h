@@ -0,0 +1,72 @@
+/** @file
+  The GUID definition and the SMM communication data structures used to read the
+  SMI latency counters collected by the PCH SMI dispatcher.
+
+  Copyright (c) 2021, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+#ifndef _PCH_SMI_STATISTICS_H_
+#define _PCH_SMI_STATISTICS_H_
+
+#define PCH_SMI_STATISTICS_GUID \
+  { \
+    0x5b339209, 0xa7da, 0x4878, { 0xb2, 0x8c, 0xea, 0x46, 0x30, 0xe1, 0x25, 0xc3 } \
+  }
+
+extern EFI_GUID gPchSmiStatisticsGuid;
+
+///
+/// Counter of one SMI source, child or callback. All times are in TSC ticks.
+///
+typedef struct {
+  UINT64                        Count;          ///< Number of measured invocations
+  UINT64                        TotalTicks;     ///< Sum of the measured durations
+  UINT64                        MinTicks;       ///< Shortest measured duration
+  UINT64                        MaxTicks;       ///< Longest measured duration
+  UINT64                        LastEntryTsc;   ///< TSC value at the start of the last invocation
+} PCH_SMI_STATISTICS_COUNTER;
+
+///
+/// Kinds of counters. Each SMI handled by the PCH SMI dispatcher is counted once by the
+/// dispatcher counter, once by the counter of the active source and once by the counter
+/// of every child dispatched for that source.
+///
+typedef enum {
+  PchSmiStatisticsDispatcher,   ///< Whole PCH SMI dispatcher invocation. SubType and Handler are 0.
+  PchSmiStatisticsSource,       ///< SMI source. SubType is the raw address of its status register, Handler is the status bit.
+  PchSmiStatisticsChild,        ///< Child dispatch function. SubType bits 15:0 are the PCH_SMM_PROTOCOL_TYPE,
+                                ///< bits 31:16 are the PCH_SMI_TYPES of PCH SMI dispatch protocol children.
+  PchSmiStatisticsSwCallback,   ///< Software SMI callback. SubType is the SwSmiInputValue.
+  PchSmiStatisticsTypeMax
+} PCH_SMI_STATISTICS_TYPE;
+
+typedef struct {
+  UINT32                        Type;           ///< PCH_SMI_STATISTICS_TYPE
+  UINT32                        SubType;        ///< Type specific identifier
+  UINT64                        Handler;        ///< Address of the dispatch function, see PCH_SMI_STATISTICS_TYPE
+  PCH_SMI_STATISTICS_COUNTER    Counter;
+} PCH_SMI_STATISTICS_ENTRY;
+
+#define PCH_SMI_STATISTICS_COMMAND_GET_INFO   0x1
+#define PCH_SMI_STATISTICS_COMMAND_GET_DATA   0x2
+#define PCH_SMI_STATISTICS_COMMAND_RESET      0x3
+
+typedef struct {
+  UINT32                        Command;
+  UINT32                        DataLength;     ///< Size of the whole command structure including the entries
+  UINT64                        ReturnStatus;
+} PCH_SMI_STATISTICS_PARAMETER_HEADER;
+
+typedef struct {
+  PCH_SMI_STATISTICS_PARAMETER_HEADER   Header;
+  UINT64                                EntryCount;     ///< Number of entries available
+} PCH_SMI_STATISTICS_PARAMETER_GET_INFO;
+
+typedef struct {
+  PCH_SMI_STATISTICS_PARAMETER_HEADER   Header;
+  UINT64                                EntryOffset;    ///< Index of the first entry to return
+  UINT64                                EntryCount;     ///< In: number of entries that fit, out: number of entries returned
+//PCH_SMI_STATISTICS_ENTRY              Entry[EntryCount];
+} PCH_SMI_STATISTICS_PARAMETER_GET_DATA;
+
+#endif
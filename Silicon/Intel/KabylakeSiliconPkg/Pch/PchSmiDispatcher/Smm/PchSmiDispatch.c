@@ -64,6 +64,13 @@ PchSmiRecordInsert (
 
   CopyMem ((VOID *) &(Record->SrcDesc), (VOID *) (SrcDesc), sizeof (PCH_SMM_SOURCE_DESC));
 
+  Status = SmmCoreAttachSource (Record);
+  if (EFI_ERROR (Status)) {
+    ASSERT (FALSE);
+    gSmst->SmmFreePool (Record);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
   //
   // After ensuring the source of event is not null, we will insert the record into the database
   //
@@ -2276,9 +2283,13 @@ PchSmiTypeCallbackDispatcher (
   PCH_SMI_TYPES                         PchSmiType;
   UINTN                                 RpIndex;
   PCH_PCIE_SMI_RP_CONTEXT               RpContext;
+  UINT64                                StartTsc;
+  UINTN                                 RemoveCount;
 
-  PchSmiType = Record->PchSmiType;
-  Status     = EFI_SUCCESS;
+  PchSmiType  = Record->PchSmiType;
+  Status      = EFI_SUCCESS;
+  StartTsc    = PCH_SMI_STATISTICS_START ();
+  RemoveCount = mRecordRemoveCount;
 
   switch (PchSmiType) {
     case PchTcoSmiMchType:
@@ -2325,6 +2336,13 @@ PchSmiTypeCallbackDispatcher (
       break;
   }
 
+  //
+  // Skip the sample if the callback unregistered a child, Record may be freed.
+  //
+  if (!EFI_ERROR (Status) && (RemoveCount == mRecordRemoveCount)) {
+    PchSmmStatisticsUpdate (&Record->Statistics, StartTsc);
+  }
+
   return Status;
 }
 
@@ -28,6 +28,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/SmmServicesTableLib.h>
 #include <Library/ReportStatusCodeLib.h>
 #include <Library/PerformanceLib.h>
+#include <Library/PcdLib.h>
 #include <Protocol/SmmReadyToLock.h>
 #include <IndustryStandard/Pci30.h>
 #include <PchAccess.h>
@@ -45,6 +46,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Protocol/PchGpioUnlockSmiDispatch.h>
 #include <Protocol/PchSmiDispatch.h>
 #include <Protocol/PchEspiSmiDispatch.h>
+#include <PchSmiStatistics.h>
 #include "IoTrap.h"
 
 #include <Library/SmiHandlerProfileLib.h>
@@ -411,6 +413,24 @@ VOID
   PCH_SMM_SOURCE_DESC * SrcDesc
   );
 
+///
+/// "SOURCE" RECORD
+/// One record for every unique SMI source in the callback database. The database
+/// records of the same source are linked to it, so the dispatcher tests every
+/// source once per pass and only walks the records of the source that fired.
+///
+#define SOURCE_RECORD_SIGNATURE SIGNATURE_32 ('S', 'R', 'C', 'R')
+
+typedef struct {
+  UINT32                        Signature;
+  LIST_ENTRY                    Link;
+  PCH_SMM_SOURCE_DESC           SrcDesc;
+  LIST_ENTRY                    RecordList;
+  PCH_SMI_STATISTICS_COUNTER    Statistics;
+} SOURCE_RECORD;
+
+#define SOURCE_RECORD_FROM_LINK(_record)  CR (_record, SOURCE_RECORD, Link, SOURCE_RECORD_SIGNATURE)
+
 ///
 /// "DATABASE" RECORD
 /// Linked list data structures
@@ -425,6 +445,11 @@ struct _DATABASE_RECORD {
   /// Status and Enable bit description
   ///
   PCH_SMM_SOURCE_DESC           SrcDesc;
+  ///
+  /// Source record of SrcDesc and the link in its record list
+  ///
+  SOURCE_RECORD                 *Source;
+  LIST_ENTRY                    SourceLink;
 
   ///
   /// Callback function
@@ -461,9 +486,14 @@ struct _DATABASE_RECORD {
   /// Indicate the PCH SMI types.
   ///
   PCH_SMI_TYPES                 PchSmiType;
+  ///
+  /// Latency counter of the dispatch function
+  ///
+  PCH_SMI_STATISTICS_COUNTER    Statistics;
 };
 
 #define DATABASE_RECORD_FROM_LINK(_record)  CR (_record, DATABASE_RECORD, Link, DATABASE_RECORD_SIGNATURE)
+#define DATABASE_RECORD_FROM_SOURCE_LINK(_record)  CR (_record, DATABASE_RECORD, SourceLink, DATABASE_RECORD_SIGNATURE)
 #define DATABASE_RECORD_FROM_CHILDCONTEXT(_record)  CR (_record, DATABASE_RECORD, ChildContext, DATABASE_RECORD_SIGNATURE)
 
 ///
@@ -537,6 +567,32 @@ PchSmmCoreUnRegister (
   IN  EFI_HANDLE                                       *DispatchHandle
   );
 
+/**
+  Link a database record to the source record of its SMI source description.
+  A new source record is created if no record with the same source exists yet.
+  It must be called before the record is inserted into the callback database.
+
+  @param[in]  Record              Record to link to a source record.
+
+  @retval EFI_OUT_OF_RESOURCES    Fail to allocate pool for source record
+  @retval EFI_SUCCESS             The database record is linked to its source record.
+**/
+EFI_STATUS
+SmmCoreAttachSource (
+  IN  DATABASE_RECORD                                  *Record
+  );
+
+/**
+  The internal function used to take a database record out of the database.
+  The source record of the database record is freed with its last database record.
+
+  @param[in]  Record              Record to remove from database.
+**/
+VOID
+SmmCoreRemoveRecord (
+  IN  DATABASE_RECORD                                  *Record
+  );
+
 typedef union {
   PCH_SMM_GENERIC_PROTOCOL                    Generic;
   EFI_SMM_USB_DISPATCH2_PROTOCOL              Usb;
@@ -573,6 +629,7 @@ typedef struct {
 ///
 typedef struct {
   LIST_ENTRY                  CallbackDataBase;
+  LIST_ENTRY                  SourceDataBase;
   EFI_HANDLE                  SmiHandle;
   EFI_HANDLE                  InstallMultProtHandle;
   PCH_SMM_QUALIFIED_PROTOCOL  Protocols[PCH_SMM_PROTOCOL_TYPE_MAX];
@@ -581,6 +638,36 @@ typedef struct {
 extern PRIVATE_DATA           mPrivateData;
 extern UINT16                 mAcpiBaseAddr;
 extern UINT16                 mTcoBaseAddr;
+
+///
+/// SMI latency statistics, collected when PcdPchSmiStatisticsEnable is TRUE
+///
+extern PCH_SMI_STATISTICS_COUNTER  mDispatcherStatistics;
+extern UINTN                       mRecordRemoveCount;
+
+#define PCH_SMI_STATISTICS_START()  (PcdGetBool (PcdPchSmiStatisticsEnable) ? AsmReadTsc () : 0)
+
+/**
+  Add the time elapsed since StartTsc to a latency counter.
+  Nothing is done if PcdPchSmiStatisticsEnable is FALSE.
+
+  @param[in, out] Counter         Latency counter to update
+  @param[in]      StartTsc        TSC value read by PCH_SMI_STATISTICS_START when the measured code was entered
+**/
+VOID
+PchSmmStatisticsUpdate (
+  IN OUT PCH_SMI_STATISTICS_COUNTER  *Counter,
+  IN     UINT64                      StartTsc
+  );
+
+/**
+  Register the SMM communication handler that reports the SMI latency statistics.
+  Nothing is done if PcdPchSmiStatisticsEnable is FALSE.
+**/
+VOID
+PchSmmStatisticsInit (
+  VOID
+  );
 /**
   Get the Software Smi value
 
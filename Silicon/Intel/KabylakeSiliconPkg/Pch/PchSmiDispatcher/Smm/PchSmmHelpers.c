@@ -7,6 +7,20 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 **/
 #include "PchSmmHelpers.h"
 
+///
+/// Number of ACPI/TCO IO registers cached for one pass over the SMI sources
+///
+#define PCH_SMM_REGISTER_CACHE_SIZE  16
+
+typedef struct {
+  UINT16  Address;
+  UINT8   Width;
+  UINT32  Value;
+} PCH_SMM_REGISTER_CACHE_ENTRY;
+
+GLOBAL_REMOVE_IF_UNREFERENCED PCH_SMM_REGISTER_CACHE_ENTRY  mRegisterCache[PCH_SMM_REGISTER_CACHE_SIZE];
+GLOBAL_REMOVE_IF_UNREFERENCED UINTN                         mRegisterCacheCount;
+
 ///
 /// SUPPORT / HELPER FUNCTIONS (PCH version-independent)
 ///
@@ -139,6 +153,87 @@ CompareSources (
   return (BOOLEAN) (CompareEnables (Src1, Src2) && CompareStatuses (Src1, Src2));
 }
 
+/**
+  Invalidate the status register values cached by SourceIsActive.
+  It must be called before every pass over the SMI sources.
+**/
+VOID
+PchSmmInvalidateRegisterCache (
+  VOID
+  )
+{
+  mRegisterCacheCount = 0;
+}
+
+/**
+  Read a bit like ReadBitDesc, but read every ACPI/TCO IO register only once
+  until the register cache is invalidated.
+
+  @param[in] BitDesc              The struct that includes register address, size in byte and bit number
+
+  @retval TRUE                    The bit is enabled
+  @retval FALSE                   The bit is disabled
+**/
+STATIC
+BOOLEAN
+ReadBitDescCached (
+  CONST PCH_SMM_BIT_DESC  *BitDesc
+  )
+{
+  UINT16  Address;
+  UINT8   Width;
+  UINT8   Bit;
+  UINT32  Value;
+  UINTN   Index;
+
+  if (BitDesc->Reg.Type == ACPI_ADDR_TYPE) {
+    Address = (UINT16) (mAcpiBaseAddr + BitDesc->Reg.Data.acpi);
+  } else if (BitDesc->Reg.Type == TCO_ADDR_TYPE) {
+    Address = (UINT16) (mTcoBaseAddr + BitDesc->Reg.Data.tco);
+  } else {
+    return ReadBitDesc (BitDesc);
+  }
+
+  Width = BitDesc->SizeInBytes;
+  Bit   = BitDesc->Bit;
+  if (Width == 8) {
+    //
+    // 64-bit registers are accessed as two 32-bit halves, like ReadBitDesc does.
+    //
+    Width = 4;
+    if (Bit >= 32) {
+      Address += 4;
+      Bit     -= 32;
+    }
+  }
+  if ((Width != 1) && (Width != 2) && (Width != 4)) {
+    return ReadBitDesc (BitDesc);
+  }
+
+  for (Index = 0; Index < mRegisterCacheCount; Index++) {
+    if ((mRegisterCache[Index].Address == Address) && (mRegisterCache[Index].Width == Width)) {
+      return (BOOLEAN) ((mRegisterCache[Index].Value & (1u << Bit)) != 0);
+    }
+  }
+
+  if (Width == 1) {
+    Value = IoRead8 (Address);
+  } else if (Width == 2) {
+    Value = IoRead16 (Address);
+  } else {
+    Value = IoRead32 (Address);
+  }
+
+  if (mRegisterCacheCount < PCH_SMM_REGISTER_CACHE_SIZE) {
+    mRegisterCache[mRegisterCacheCount].Address = Address;
+    mRegisterCache[mRegisterCacheCount].Width   = Width;
+    mRegisterCache[mRegisterCacheCount].Value   = Value;
+    mRegisterCacheCount++;
+  }
+
+  return (BOOLEAN) ((Value & (1u << Bit)) != 0);
+}
+
 /**
   Check if an SMM source is active.
 
@@ -185,10 +280,14 @@ SourceIsActive (
   for (DescIndex = 0; DescIndex < NUM_EN_BITS; DescIndex++) {
     if (!IS_BIT_DESC_NULL (Src->En[DescIndex])) {
       if ((Src->En[DescIndex].Reg.Type == ACPI_ADDR_TYPE) &&
-          (Src->En[DescIndex].Reg.Data.acpi == R_PCH_SMI_EN) &&
-          ((SmiEnValue & (1u << Src->En[DescIndex].Bit)) == 0)) {
-        return FALSE;
-      } else if (ReadBitDesc (&Src->En[DescIndex]) == 0) {
+          (Src->En[DescIndex].Reg.Data.acpi == R_PCH_SMI_EN)) {
+        //
+        // Use the value read by the caller for this pass
+        //
+        if ((SmiEnValue & (1u << Src->En[DescIndex].Bit)) == 0) {
+          return FALSE;
+        }
+      } else if (ReadBitDescCached (&Src->En[DescIndex]) == 0) {
         return FALSE;
       }
     }
@@ -200,10 +299,14 @@ SourceIsActive (
   for (DescIndex = 0; DescIndex < NUM_STS_BITS; DescIndex++) {
     if (!IS_BIT_DESC_NULL (Src->Sts[DescIndex])) {
       if ((Src->Sts[DescIndex].Reg.Type == ACPI_ADDR_TYPE) &&
-          (Src->Sts[DescIndex].Reg.Data.acpi == R_PCH_SMI_STS) &&
-          ((SmiStsValue & (1u << Src->Sts[DescIndex].Bit)) == 0)) {
-        return FALSE;
-      } else if (ReadBitDesc (&Src->Sts[DescIndex]) == 0) {
+          (Src->Sts[DescIndex].Reg.Data.acpi == R_PCH_SMI_STS)) {
+        //
+        // Use the value read by the caller for this pass
+        //
+        if ((SmiStsValue & (1u << Src->Sts[DescIndex].Bit)) == 0) {
+          return FALSE;
+        }
+      } else if (ReadBitDescCached (&Src->Sts[DescIndex]) == 0) {
         return FALSE;
       }
     }
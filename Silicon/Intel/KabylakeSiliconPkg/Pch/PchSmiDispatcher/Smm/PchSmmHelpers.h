@@ -85,6 +85,15 @@ CompareSources (
   CONST IN PCH_SMM_SOURCE_DESC *Src2
   );
 
+/**
+  Invalidate the status register values cached by SourceIsActive.
+  It must be called before every pass over the SMI sources.
+**/
+VOID
+PchSmmInvalidateRegisterCache (
+  VOID
+  );
+
 /**
   Check if an SMM source is active.
 
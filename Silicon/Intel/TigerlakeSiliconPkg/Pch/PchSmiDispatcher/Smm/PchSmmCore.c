@@ -25,11 +25,22 @@ GLOBAL_REMOVE_IF_UNREFERENCED UINT16                mTcoBaseAddr;
 GLOBAL_REMOVE_IF_UNREFERENCED BOOLEAN               mReadyToLock;
 GLOBAL_REMOVE_IF_UNREFERENCED BOOLEAN               mS3SusStart;
 
+//
+// Latency counter of PchSmmCoreDispatcher and the number of database records removed so far.
+// The dispatcher only updates the counter of a record if no record was removed by its callback.
+//
+GLOBAL_REMOVE_IF_UNREFERENCED PCH_SMI_STATISTICS_COUNTER  mDispatcherStatistics;
+GLOBAL_REMOVE_IF_UNREFERENCED UINTN                       mRecordRemoveCount;
+
 GLOBAL_REMOVE_IF_UNREFERENCED PRIVATE_DATA          mPrivateData = {
   {
     NULL,
     NULL
   },                                    // CallbackDataBase linked list head
+  {
+    NULL,
+    NULL
+  },                                    // SourceDataBase linked list head
   NULL,                                 // EFI handle returned when calling InstallMultipleProtocolInterfaces
   NULL,                                 //
   {                                     // protocol arrays
@@ -240,10 +251,12 @@ InitializePchSmmDispatcher (
   //
   Status = gSmst->SmiHandlerRegister (PchSmmCoreDispatcher, NULL, &mPrivateData.SmiHandle);
   ASSERT_EFI_ERROR (Status);
+  PchSmmStatisticsInit ();
   //
   // Initialize Callback DataBase
   //
   InitializeListHead (&mPrivateData.CallbackDataBase);
+  InitializeListHead (&mPrivateData.SourceDataBase);
 
   //
   // Enable SMIs on the PCH now that we have a callback
@@ -273,6 +286,55 @@ InitializePchSmmDispatcher (
   return EFI_SUCCESS;
 }
 
+/**
+  Link a database record to the source record of its SMI source description.
+  A new source record is created if no record with the same source exists yet.
+
+  @param[in]  Record                    Record to link to a source record.
+
+  @retval EFI_OUT_OF_RESOURCES          Fail to allocate pool for source record
+  @retval EFI_SUCCESS                   The database record is linked to its source record.
+**/
+STATIC
+EFI_STATUS
+SmmCoreAttachSource (
+  IN  DATABASE_RECORD                   *Record
+  )
+{
+  EFI_STATUS                            Status;
+  SOURCE_RECORD                         *Source;
+  LIST_ENTRY                            *Link;
+
+  for (Link = GetFirstNode (&mPrivateData.SourceDataBase);
+       !IsNull (&mPrivateData.SourceDataBase, Link);
+       Link = GetNextNode (&mPrivateData.SourceDataBase, Link)) {
+    Source = SOURCE_RECORD_FROM_LINK (Link);
+    if ((Source->SrcDesc.Flags == Record->SrcDesc.Flags) &&
+        (Source->SrcDesc.PmcSmiSts.Bit == Record->SrcDesc.PmcSmiSts.Bit) &&
+        (Source->SrcDesc.PmcSmiSts.Reg.Type == Record->SrcDesc.PmcSmiSts.Reg.Type) &&
+        (Source->SrcDesc.PmcSmiSts.Reg.Data.raw == Record->SrcDesc.PmcSmiSts.Reg.Data.raw) &&
+        CompareSources (&Source->SrcDesc, &Record->SrcDesc)) {
+      Record->Source = Source;
+      InsertTailList (&Source->RecordList, &Record->SourceLink);
+      return EFI_SUCCESS;
+    }
+  }
+
+  Status = gSmst->SmmAllocatePool (EfiRuntimeServicesData, sizeof (SOURCE_RECORD), (VOID **) &Source);
+  if (EFI_ERROR (Status)) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+  ZeroMem (Source, sizeof (SOURCE_RECORD));
+  Source->Signature = SOURCE_RECORD_SIGNATURE;
+  CopyMem (&Source->SrcDesc, &Record->SrcDesc, sizeof (PCH_SMM_SOURCE_DESC));
+  InitializeListHead (&Source->RecordList);
+  InsertTailList (&mPrivateData.SourceDataBase, &Source->Link);
+
+  Record->Source = Source;
+  InsertTailList (&Source->RecordList, &Record->SourceLink);
+  return EFI_SUCCESS;
+}
+
 /**
   The internal function used to create and insert a database record
 
@@ -306,6 +368,13 @@ SmmCoreInsertRecord (
   }
   CopyMem (Record, NewRecord, sizeof (DATABASE_RECORD));
 
+  Status = SmmCoreAttachSource (Record);
+  if (EFI_ERROR (Status)) {
+    ASSERT (FALSE);
+    gSmst->SmmFreePool (Record);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
   //
   // After ensuring the source of event is not null, we will insert the record into the database
   //
@@ -319,6 +388,32 @@ SmmCoreInsertRecord (
   return EFI_SUCCESS;
 }
 
+/**
+  The internal function used to take a database record out of the database.
+  The source record of the database record is freed with its last database record.
+
+  @param[in]  Record                    Record to remove from database.
+**/
+VOID
+SmmCoreRemoveRecord (
+  IN  DATABASE_RECORD                   *Record
+  )
+{
+  SOURCE_RECORD                         *Source;
+
+  mRecordRemoveCount++;
+  RemoveEntryList (&Record->Link);
+
+  Source = Record->Source;
+  RemoveEntryList (&Record->SourceLink);
+  if (IsListEmpty (&Source->RecordList)) {
+    RemoveEntryList (&Source->Link);
+    ZeroMem (Source, sizeof (SOURCE_RECORD));
+    gSmst->SmmFreePool (Source);
+  }
+  Record->Source = NULL;
+}
+
 /**
   Unregister a child SMI source dispatch function with a parent SMM driver
 
@@ -558,7 +653,7 @@ PchSmmCoreUnRegister (
   BOOLEAN                      NeedClearEnable;
   UINTN                        DescIndex;
   DATABASE_RECORD              *RecordToDelete;
-  DATABASE_RECORD              *RecordInDb;
+  SOURCE_RECORD                *SourceInDb;
   LIST_ENTRY                   *LinkInDb;
 
   if (DispatchHandle == NULL) {
@@ -582,10 +677,10 @@ PchSmmCoreUnRegister (
     return EFI_INVALID_PARAMETER;
   }
 
-  RemoveEntryList (&RecordToDelete->Link);
+  SmmCoreRemoveRecord (RecordToDelete);
 
   //
-  // Loop through all the souces in record linked list to see if any source enable is equal.
+  // Loop through all the souces in source linked list to see if any source enable is equal.
   // If any source enable is equal, we do not want to disable it.
   //
   for (DescIndex = 0; DescIndex < NUM_EN_BITS; ++DescIndex) {
@@ -593,14 +688,14 @@ PchSmmCoreUnRegister (
       continue;
     }
     NeedClearEnable = TRUE;
-    LinkInDb = GetFirstNode (&mPrivateData.CallbackDataBase);
-    while (!IsNull (&mPrivateData.CallbackDataBase, LinkInDb)) {
-      RecordInDb = DATABASE_RECORD_FROM_LINK (LinkInDb);
-      if (IsBitEqualToAnySourceEn (&RecordToDelete->SrcDesc.En[DescIndex], &RecordInDb->SrcDesc)) {
+    LinkInDb = GetFirstNode (&mPrivateData.SourceDataBase);
+    while (!IsNull (&mPrivateData.SourceDataBase, LinkInDb)) {
+      SourceInDb = SOURCE_RECORD_FROM_LINK (LinkInDb);
+      if (IsBitEqualToAnySourceEn (&RecordToDelete->SrcDesc.En[DescIndex], &SourceInDb->SrcDesc)) {
         NeedClearEnable = FALSE;
         break;
       }
-      LinkInDb = GetNextNode (&mPrivateData.CallbackDataBase, &RecordInDb->Link);
+      LinkInDb = GetNextNode (&mPrivateData.SourceDataBase, &SourceInDb->Link);
     }
     if (NeedClearEnable == FALSE) {
       continue;
@@ -687,10 +782,12 @@ PchSmmCoreDispatcher (
   BOOLEAN             EosSet;
   BOOLEAN             SxChildWasDispatched;
 
-  DATABASE_RECORD     *RecordInDb;
+  SOURCE_RECORD       *SourceInDb;
   LIST_ENTRY          *LinkInDb;
+  DATABASE_RECORD     *RecordInDb;
   DATABASE_RECORD     *RecordToExhaust;
   LIST_ENTRY          *LinkToExhaust;
+  PCH_SMM_CLEAR_SOURCE ClearSource;
 
   PCH_SMM_CONTEXT     Context;
   VOID                *CommBuffer;
@@ -705,6 +802,14 @@ PchSmmCoreDispatcher (
 
   PCH_SMM_SOURCE_DESC ActiveSource;
 
+  UINT64              DispatchStartTsc;
+  UINT64              SourceStartTsc;
+  UINT64              CallbackStartTsc;
+  UINTN               SourceRemoveCount;
+  UINTN               CallbackRemoveCount;
+
+  DispatchStartTsc = PCH_SMI_STATISTICS_START ();
+
   //
   // Initialize ActiveSource
   //
@@ -732,7 +837,7 @@ PchSmmCoreDispatcher (
     while ((!EosSet) && (EscapeCount > 0)) {
       EscapeCount--;
 
-      LinkInDb = GetFirstNode (&mPrivateData.CallbackDataBase);
+      LinkInDb = GetFirstNode (&mPrivateData.SourceDataBase);
 
       //
       // Cache SciEn, SmiEnValue and SmiStsValue to determine if source is active
@@ -740,23 +845,24 @@ PchSmmCoreDispatcher (
       SciEn       = PchSmmGetSciEn ();
       SmiEnValue  = IoRead32 ((UINTN) (mAcpiBaseAddr + R_ACPI_IO_SMI_EN));
       SmiStsValue = IoRead32 ((UINTN) (mAcpiBaseAddr + R_ACPI_IO_SMI_STS));
+      PchSmmInvalidateRegisterCache ();
 
-      while (!IsNull (&mPrivateData.CallbackDataBase, LinkInDb)) {
-        RecordInDb = DATABASE_RECORD_FROM_LINK (LinkInDb);
+      while (!IsNull (&mPrivateData.SourceDataBase, LinkInDb)) {
+        SourceInDb = SOURCE_RECORD_FROM_LINK (LinkInDb);
 
         //
         // look for the first active source
         //
-        if (!SourceIsActive (&RecordInDb->SrcDesc, SciEn, SmiEnValue, SmiStsValue)) {
+        if (!SourceIsActive (&SourceInDb->SrcDesc, SciEn, SmiEnValue, SmiStsValue)) {
           //
           // Didn't find the source yet, keep looking
           //
-          LinkInDb = GetNextNode (&mPrivateData.CallbackDataBase, &RecordInDb->Link);
+          LinkInDb = GetNextNode (&mPrivateData.SourceDataBase, &SourceInDb->Link);
 
           //
           // if it's the last one, try to clear EOS
           //
-          if (IsNull (&mPrivateData.CallbackDataBase, LinkInDb)) {
+          if (IsNull (&mPrivateData.SourceDataBase, LinkInDb)) {
             //
             // Clear pending SMI status before EOS
             //
@@ -768,100 +874,111 @@ PchSmmCoreDispatcher (
           // We found a source. If this is a sleep type, we have to go to
           // appropriate sleep state anyway.No matter there is sleep child or not
           //
+          SourceStartTsc    = PCH_SMI_STATISTICS_START ();
+          SourceRemoveCount = mRecordRemoveCount;
+          RecordInDb = DATABASE_RECORD_FROM_SOURCE_LINK (GetFirstNode (&SourceInDb->RecordList));
           if (RecordInDb->ProtocolType == SxType) {
             SxChildWasDispatched = TRUE;
           }
           //
-          // "cache" the source description and don't query I/O anymore
+          // "cache" the source description and the clear function, the source record
+          // is freed if its last child is unregistered by a callback function
           //
-          CopyMem ((VOID *) &ActiveSource, (VOID *) &(RecordInDb->SrcDesc), sizeof (PCH_SMM_SOURCE_DESC));
-          LinkToExhaust = LinkInDb;
+          CopyMem ((VOID *) &ActiveSource, (VOID *) &(SourceInDb->SrcDesc), sizeof (PCH_SMM_SOURCE_DESC));
+          ClearSource   = RecordInDb->ClearSource;
+          LinkToExhaust = GetFirstNode (&SourceInDb->RecordList);
 
           //
-          // exhaust the rest of the queue looking for the same source
+          // exhaust the children of the source
           //
-          while (!IsNull (&mPrivateData.CallbackDataBase, LinkToExhaust)) {
-            RecordToExhaust = DATABASE_RECORD_FROM_LINK (LinkToExhaust);
+          while (LinkToExhaust != &SourceInDb->RecordList) {
+            RecordToExhaust = DATABASE_RECORD_FROM_SOURCE_LINK (LinkToExhaust);
             //
-            // RecordToExhaust->Link might be removed (unregistered) by Callback function, and then the
-            // system will hang in ASSERT() while calling GetNextNode().
-            // To prevent the issue, we need to get next record in DB here (before Callback function).
+            // RecordToExhaust might be removed (unregistered) by Callback function, together with
+            // the source record when it is the last child. To prevent touching freed pool, get
+            // the next record here (before Callback function) and stop at the list head address.
             //
-            LinkToExhaust = GetNextNode (&mPrivateData.CallbackDataBase, &RecordToExhaust->Link);
+            LinkToExhaust = RecordToExhaust->SourceLink.ForwardLink;
 
-            if (CompareSources (&RecordToExhaust->SrcDesc, &ActiveSource)) {
+            //
+            // The child has the same source description as the active source,
+            // so this callback should be dispatched.
+            //
+            if (RecordToExhaust->ContextFunctions.GetContext != NULL) {
               //
-              // These source descriptions are equal, so this callback should be
-              // dispatched.
+              // This child requires that we get a calling context from
+              // hardware and compare that context to the one supplied
+              // by the child.
               //
-              if (RecordToExhaust->ContextFunctions.GetContext != NULL) {
-                //
-                // This child requires that we get a calling context from
-                // hardware and compare that context to the one supplied
-                // by the child.
-                //
-                ASSERT (RecordToExhaust->ContextFunctions.CmpContext != NULL);
+              ASSERT (RecordToExhaust->ContextFunctions.CmpContext != NULL);
+
+              //
+              // Make sure contexts match before dispatching event to child
+              //
+              RecordToExhaust->ContextFunctions.GetContext (RecordToExhaust, &Context);
+              ContextsMatch = RecordToExhaust->ContextFunctions.CmpContext (&Context, &RecordToExhaust->ChildContext);
+
+            } else {
+              //
+              // This child doesn't require any more calling context beyond what
+              // it supplied in registration.  Simply pass back what it gave us.
+              //
+              Context       = RecordToExhaust->ChildContext;
+              ContextsMatch = TRUE;
+            }
 
+            if (ContextsMatch) {
+              if (RecordToExhaust->ProtocolType == PchSmiDispatchType) {
                 //
-                // Make sure contexts match before dispatching event to child
+                // For PCH SMI dispatch protocols
                 //
-                RecordToExhaust->ContextFunctions.GetContext (RecordToExhaust, &Context);
-                ContextsMatch = RecordToExhaust->ContextFunctions.CmpContext (&Context, &RecordToExhaust->ChildContext);
-
+                PchSmiTypeCallbackDispatcher (RecordToExhaust);
               } else {
+                if ((RecordToExhaust->ProtocolType == SxType) && (Context.Sx.Type == SxS3) && (Context.Sx.Phase == SxEntry) && !mS3SusStart) {
+                  REPORT_STATUS_CODE (EFI_PROGRESS_CODE, PROGRESS_CODE_S3_SUSPEND_START);
+                  mS3SusStart = TRUE;
+                }
                 //
-                // This child doesn't require any more calling context beyond what
-                // it supplied in registration.  Simply pass back what it gave us.
+                // For EFI standard SMI dispatch protocols
                 //
-                Context       = RecordToExhaust->ChildContext;
-                ContextsMatch = TRUE;
-              }
+                if (RecordToExhaust->Callback != NULL) {
+                  if (RecordToExhaust->ContextFunctions.GetCommBuffer != NULL) {
+                    //
+                    // This callback function needs CommBuffer and CommBufferSize.
+                    // Get those from child and then pass to callback function.
+                    //
+                    RecordToExhaust->ContextFunctions.GetCommBuffer (RecordToExhaust, &CommBuffer, &CommBufferSize);
+                  } else {
+                    //
+                    // Child doesn't support the CommBuffer and CommBufferSize.
+                    // Just pass NULL value to callback function.
+                    //
+                    CommBuffer     = NULL;
+                    CommBufferSize = 0;
+                  }
 
-              if (ContextsMatch) {
-                if (RecordToExhaust->ProtocolType == PchSmiDispatchType) {
-                  //
-                  // For PCH SMI dispatch protocols
-                  //
-                  PchSmiTypeCallbackDispatcher (RecordToExhaust);
-                } else {
-                  if ((RecordToExhaust->ProtocolType == SxType) && (Context.Sx.Type == SxS3) && (Context.Sx.Phase == SxEntry) && !mS3SusStart) {
-                    REPORT_STATUS_CODE (EFI_PROGRESS_CODE, PROGRESS_CODE_S3_SUSPEND_START);
-                    mS3SusStart = TRUE;
+                  PERF_START_EX (NULL, "SmmFunction", NULL, AsmReadTsc (), RecordToExhaust->ProtocolType);
+                  CallbackStartTsc    = PCH_SMI_STATISTICS_START ();
+                  CallbackRemoveCount = mRecordRemoveCount;
+                  RecordToExhaust->Callback ((EFI_HANDLE) & RecordToExhaust->Link, &Context, CommBuffer, &CommBufferSize);
+                  PERF_END_EX (NULL, "SmmFunction", NULL, AsmReadTsc (), RecordToExhaust->ProtocolType);
+                  if (CallbackRemoveCount == mRecordRemoveCount) {
+                    //
+                    // Skip the sample if the callback unregistered a child, RecordToExhaust may be freed.
+                    //
+                    PchSmmStatisticsUpdate (&RecordToExhaust->Statistics, CallbackStartTsc);
                   }
-                  //
-                  // For EFI standard SMI dispatch protocols
-                  //
-                  if (RecordToExhaust->Callback != NULL) {
-                    if (RecordToExhaust->ContextFunctions.GetCommBuffer != NULL) {
-                      //
-                      // This callback function needs CommBuffer and CommBufferSize.
-                      // Get those from child and then pass to callback function.
-                      //
-                      RecordToExhaust->ContextFunctions.GetCommBuffer (RecordToExhaust, &CommBuffer, &CommBufferSize);
-                    } else {
-                      //
-                      // Child doesn't support the CommBuffer and CommBufferSize.
-                      // Just pass NULL value to callback function.
-                      //
-                      CommBuffer     = NULL;
-                      CommBufferSize = 0;
-                    }
-
-                    PERF_START_EX (NULL, "SmmFunction", NULL, AsmReadTsc (), RecordToExhaust->ProtocolType);
-                    RecordToExhaust->Callback ((EFI_HANDLE) & RecordToExhaust->Link, &Context, CommBuffer, &CommBufferSize);
-                    PERF_END_EX (NULL, "SmmFunction", NULL, AsmReadTsc (), RecordToExhaust->ProtocolType);
-                    if (RecordToExhaust->ProtocolType == SxType) {
-                      SxChildWasDispatched = TRUE;
-                    }
-                  } else {
-                    ASSERT (FALSE);
+                  if (RecordToExhaust->ProtocolType == SxType) {
+                    SxChildWasDispatched = TRUE;
                   }
+                } else {
+                  ASSERT (FALSE);
                 }
               }
             }
           }
 
-          if (RecordInDb->ClearSource == NULL) {
+          if (ClearSource == NULL) {
             //
             // Clear the SMI associated w/ the source using the default function
             //
@@ -870,7 +987,10 @@ PchSmmCoreDispatcher (
             //
             // This source requires special handling to clear
             //
-            RecordInDb->ClearSource (&ActiveSource);
+            ClearSource (&ActiveSource);
+          }
+          if (SourceRemoveCount == mRecordRemoveCount) {
+            PchSmmStatisticsUpdate (&SourceInDb->Statistics, SourceStartTsc);
           }
           //
           // Clear pending SMI status before EOS
@@ -907,6 +1027,8 @@ PchSmmCoreDispatcher (
   //
   //  ASSERT (EscapeCount > 0);
   //
+  PchSmmStatisticsUpdate (&mDispatcherStatistics, DispatchStartTsc);
+
   if (SxChildWasDispatched) {
     //
     // A child of the SmmSxDispatch protocol was dispatched during this call;
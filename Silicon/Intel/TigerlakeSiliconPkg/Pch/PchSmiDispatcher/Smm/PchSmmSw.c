@@ -11,11 +11,9 @@
 
 GLOBAL_REMOVE_IF_UNREFERENCED EFI_SMM_CPU_PROTOCOL          *mSmmCpuProtocol;
 
-STATIC LIST_ENTRY                       mSwSmiCallbackDataBase;
-
 //
 // "SWSMI" RECORD
-// Linked list data structures
+// Records are indexed by their SwSmiInputValue, the link of the record is the dispatch handle
 //
 #define SW_SMI_RECORD_SIGNATURE         SIGNATURE_32 ('S', 'W', 'S', 'M')
 
@@ -26,8 +24,11 @@ typedef struct {
   LIST_ENTRY                            Link;
   EFI_SMM_SW_REGISTER_CONTEXT           Context;
   EFI_SMM_HANDLER_ENTRY_POINT2          Callback;
+  PCH_SMI_STATISTICS_COUNTER            Statistics;
 } SW_SMI_RECORD;
 
+STATIC SW_SMI_RECORD                    *mSwSmiCallbackTable[MAXIMUM_SWI_VALUE];
+
 GLOBAL_REMOVE_IF_UNREFERENCED CONST PCH_SMM_SOURCE_DESC mSwSourceDesc = {
   PCH_SMM_NO_FLAGS,
   {
@@ -74,16 +75,9 @@ SmiInputValueDuplicateCheck (
   IN UINTN  SwSmiInputValue
   )
 {
-  SW_SMI_RECORD   *SwSmiRecord;
-  LIST_ENTRY      *LinkInDb;
-
-  LinkInDb = GetFirstNode (&mSwSmiCallbackDataBase);
-  while (!IsNull (&mSwSmiCallbackDataBase, LinkInDb)) {
-    SwSmiRecord = SW_SMI_RECORD_FROM_LINK (LinkInDb);
-    if (SwSmiRecord->Context.SwSmiInputValue == SwSmiInputValue) {
-      return EFI_INVALID_PARAMETER;
-    }
-    LinkInDb = GetNextNode (&mSwSmiCallbackDataBase, &SwSmiRecord->Link);
+  if ((SwSmiInputValue < MAXIMUM_SWI_VALUE) &&
+      (mSwSmiCallbackTable[SwSmiInputValue] != NULL)) {
+    return EFI_INVALID_PARAMETER;
   }
 
   return EFI_SUCCESS;
@@ -181,6 +175,7 @@ PchSwSmiRegister (
   //
   // Gather information about the registration request
   //
+  ZeroMem (SwSmiRecord, sizeof (SW_SMI_RECORD));
   SwSmiRecord->Signature               = SW_SMI_RECORD_SIGNATURE;
   SwSmiRecord->Context.SwSmiInputValue = DispatchContext->SwSmiInputValue;
   SwSmiRecord->Callback                = DispatchFunction;
@@ -189,7 +184,8 @@ PchSwSmiRegister (
   //
   DEBUG ((DEBUG_INFO, "SW SMI NUM %x  Sw Record at Address 0x%X\n", SwSmiRecord->Context.SwSmiInputValue, SwSmiRecord));
 
-  InsertTailList (&mSwSmiCallbackDataBase, &SwSmiRecord->Link);
+  InitializeListHead (&SwSmiRecord->Link);
+  mSwSmiCallbackTable[SwSmiRecord->Context.SwSmiInputValue] = SwSmiRecord;
 
   //
   // Child's handle will be the address linked list link in the record
@@ -235,13 +231,15 @@ PchSwSmiUnRegister (
 
   RecordToDelete = SW_SMI_RECORD_FROM_LINK (DispatchHandle);
   //
-  // Take the entry out of the linked list
+  // Take the entry out of the table
   //
-  if (RecordToDelete->Signature != SW_SMI_RECORD_SIGNATURE) {
+  if ((RecordToDelete->Signature != SW_SMI_RECORD_SIGNATURE) ||
+      (RecordToDelete->Context.SwSmiInputValue >= MAXIMUM_SWI_VALUE) ||
+      (mSwSmiCallbackTable[RecordToDelete->Context.SwSmiInputValue] != RecordToDelete)) {
     return EFI_INVALID_PARAMETER;
   }
 
-  RemoveEntryList (&RecordToDelete->Link);
+  mSwSmiCallbackTable[RecordToDelete->Context.SwSmiInputValue] = NULL;
   ZeroMem (RecordToDelete, sizeof (SW_SMI_RECORD));
   Status = gSmst->SmmFreePool (RecordToDelete);
   ASSERT_EFI_ERROR (Status);
@@ -280,9 +278,9 @@ PchSwSmiDispatcher (
   EFI_SMM_SAVE_STATE_IO_INFO            SmiIoInfo;
   UINTN                                 CpuIndex;
   SW_SMI_RECORD                         *SwSmiRecord;
-  LIST_ENTRY                            *LinkInDb;
   EFI_SMM_SW_CONTEXT                    SwSmiCommBuffer;
   UINTN                                 SwSmiCommBufferSize;
+  UINT64                                StartTsc;
 
   SwSmiCommBufferSize      = sizeof (EFI_SMM_SW_CONTEXT);
   //
@@ -318,26 +316,57 @@ PchSwSmiDispatcher (
     //
     // If the IO data is used for SmmControl protocol, skip it.
     //
-    if (SmiIoInfo.IoData == 0xFF) {
+    if (SmiIoInfo.IoData >= MAXIMUM_SWI_VALUE) {
       continue;
     }
 
     SwSmiCommBuffer.SwSmiCpuIndex = CpuIndex;
     SwSmiCommBuffer.CommandPort   = (UINT8) SmiIoInfo.IoData;
 
-    LinkInDb = GetFirstNode (&mSwSmiCallbackDataBase);
-    while (!IsNull (&mSwSmiCallbackDataBase, LinkInDb)) {
-      SwSmiRecord = SW_SMI_RECORD_FROM_LINK (LinkInDb);
-      if (SwSmiRecord->Context.SwSmiInputValue == SmiIoInfo.IoData) {
-        SwSmiRecord->Callback ((EFI_HANDLE) &SwSmiRecord->Link, &SwSmiRecord->Context, &SwSmiCommBuffer, &SwSmiCommBufferSize);
+    SwSmiRecord = mSwSmiCallbackTable[SmiIoInfo.IoData];
+    if (SwSmiRecord != NULL) {
+      StartTsc = PCH_SMI_STATISTICS_START ();
+      SwSmiRecord->Callback ((EFI_HANDLE) &SwSmiRecord->Link, &SwSmiRecord->Context, &SwSmiCommBuffer, &SwSmiCommBufferSize);
+      //
+      // Skip the sample if the callback unregistered itself
+      //
+      if (mSwSmiCallbackTable[SmiIoInfo.IoData] == SwSmiRecord) {
+        PchSmmStatisticsUpdate (&SwSmiRecord->Statistics, StartTsc);
       }
-      LinkInDb = GetNextNode (&mSwSmiCallbackDataBase, &SwSmiRecord->Link);
     }
   }
 
   return EFI_SUCCESS;
 }
 
+/**
+  Get the latency counter of the software SMI callback registered for a SwSmiInputValue.
+
+  @param[in]  SwSmiInputValue     Software SMI input value
+  @param[out] Callback            Callback function registered for the value
+
+  @retval NULL                    No callback is registered for the value
+  @retval Others                  Pointer to the latency counter of the callback
+**/
+PCH_SMI_STATISTICS_COUNTER *
+PchSwSmiGetStatistics (
+  IN  UINTN                         SwSmiInputValue,
+  OUT EFI_SMM_HANDLER_ENTRY_POINT2  *Callback
+  )
+{
+  SW_SMI_RECORD   *SwSmiRecord;
+
+  if (SwSmiInputValue >= MAXIMUM_SWI_VALUE) {
+    return NULL;
+  }
+  SwSmiRecord = mSwSmiCallbackTable[SwSmiInputValue];
+  if (SwSmiRecord == NULL) {
+    return NULL;
+  }
+  *Callback = SwSmiRecord->Callback;
+  return &SwSmiRecord->Statistics;
+}
+
 /**
   Init required protocol for Pch Sw Dispatch protocol.
 **/
@@ -359,7 +388,7 @@ PchSwDispatchInit (
   //
   // Initialize SW SMI Callback DataBase
   //
-  InitializeListHead (&mSwSmiCallbackDataBase);
+  ZeroMem (mSwSmiCallbackTable, sizeof (mSwSmiCallbackTable));
 
   //
   // Insert SwSmi handler to PchSmmCore database
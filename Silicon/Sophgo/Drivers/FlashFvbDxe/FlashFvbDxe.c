@@ -41,6 +41,7 @@ STATIC CONST FVB_DEVICE mFvbFlashInstanceTemplate = {
   SIZE_256KB, // Size?
   0, // FvbOffset ... NEED TO BE FILLED
   0, // FvbSize ... NEED TO BE FILLED
+  NULL, // Shadow ... NEED TO BE FILLED
   0, // StartLba
 
   {
@@ -350,6 +351,87 @@ ValidateFvHeader (
   return EFI_SUCCESS;
 }
 
+/**
+  Copy a range of the variable and FTW region from the flash into the shadow.
+  The shadow is no longer used if the flash cannot be read, the FVB reads go
+  to the flash again.
+
+  @param[in]  Instance      The FVB device instance.
+  @param[in]  ShadowOffset  Offset of the range from the start of the region.
+  @param[in]  Length        Length of the range.
+
+**/
+STATIC
+VOID
+FvbShadowLoad (
+  IN FVB_DEVICE  *Instance,
+  IN UINTN       ShadowOffset,
+  IN UINTN       Length
+  )
+{
+  EFI_STATUS  Status;
+
+  if ((Instance->Shadow == NULL) ||
+      (ShadowOffset >= Instance->FvbSize) ||
+      (Length == 0)) {
+    return;
+  }
+  Length = MIN (Length, Instance->FvbSize - ShadowOffset);
+
+  Status = Instance->NorFlashProtocol->ReadData (
+              Instance->Nor,
+              Instance->FvbOffset + ShadowOffset,
+              Length,
+              Instance->Shadow + ShadowOffset
+              );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((
+      DEBUG_ERROR,
+      "%a: Failed to read the flash, shadow disabled - %r\n",
+      __func__,
+      Status
+      ));
+    Instance->Shadow = NULL;
+  }
+}
+
+/**
+  Update the shadow after a range of the variable and FTW region is programmed
+  or erased. Programming a NOR flash only clears bits, so the shadow keeps
+  the bits that are clear in both the old content and the written data.
+
+  @param[in]  Instance      The FVB device instance.
+  @param[in]  ShadowOffset  Offset of the range from the start of the region.
+  @param[in]  Length        Length of the range.
+  @param[in]  Buffer        Data written to the range, NULL if the range is erased.
+
+**/
+STATIC
+VOID
+FvbShadowUpdate (
+  IN FVB_DEVICE   *Instance,
+  IN UINTN        ShadowOffset,
+  IN UINTN        Length,
+  IN CONST UINT8  *Buffer  OPTIONAL
+  )
+{
+  UINTN  Index;
+
+  if ((Instance->Shadow == NULL) ||
+      (ShadowOffset >= Instance->FvbSize)) {
+    return;
+  }
+  Length = MIN (Length, Instance->FvbSize - ShadowOffset);
+
+  if (Buffer == NULL) {
+    SetMem (Instance->Shadow + ShadowOffset, Length, 0xFF);
+  } else {
+    for (Index = 0; Index < Length; Index++) {
+      Instance->Shadow[ShadowOffset + Index] &= Buffer[Index];
+    }
+  }
+}
+
 /**
  The GetAttributes() function retrieves the attributes and
  current settings of the block.
@@ -649,6 +731,19 @@ FvbRead (
     return EFI_BAD_BUFFER_SIZE;
   }
 
+  //
+  // Serve the read from the shadow if the block is part of it
+  //
+  DataOffset = GET_DATA_OFFSET (Offset,
+                  Instance->StartLba + Lba,
+                  Instance->Media.BlockSize);
+  if ((Instance->Shadow != NULL) &&
+      (DataOffset < Instance->FvbSize) &&
+      (*NumBytes <= Instance->FvbSize - DataOffset)) {
+    CopyMem (Buffer, Instance->Shadow + DataOffset, *NumBytes);
+    return EFI_SUCCESS;
+  }
+
   DataOffset = GET_DATA_OFFSET (Instance->RegionBaseAddress + Offset,
                   Instance->StartLba + Lba,
                   Instance->Media.BlockSize);
@@ -738,15 +833,17 @@ FvbWrite (
   FVB_DEVICE  *Instance;
   EFI_STATUS  Status;
   UINTN       DataOffset;
+  UINTN       ShadowOffset;
 
   ASSERT (NumBytes != NULL);
   ASSERT (Buffer != NULL);
 
   Instance = INSTANCE_FROM_FVB_THIS (This);
 
-  DataOffset = GET_DATA_OFFSET (Instance->FvbOffset + Offset,
-                  Instance->StartLba + Lba,
-                  Instance->Media.BlockSize);
+  ShadowOffset = GET_DATA_OFFSET (Offset,
+                   Instance->StartLba + Lba,
+                   Instance->Media.BlockSize);
+  DataOffset = Instance->FvbOffset + ShadowOffset;
 
   Status = Instance->NorFlashProtocol->WriteData (
               Instance->Nor,
@@ -760,9 +857,15 @@ FvbWrite (
       "%a: Failed to do flash write\n",
       __func__
       ));
+    //
+    // The range may be partially written, take the content back from the flash
+    //
+    FvbShadowLoad (Instance, ShadowOffset, *NumBytes);
     return Status;
   }
 
+  FvbShadowUpdate (Instance, ShadowOffset, *NumBytes, Buffer);
+
   return Status;
 }
 
@@ -936,10 +1039,18 @@ FvbEraseBlocks (
                     Instance->Media.BlockSize
                     );
       if (EFI_ERROR (Status)) {
+        FvbShadowLoad (Instance,
+          BlockAddress - Instance->FvbOffset,
+          Instance->Media.BlockSize);
         VA_END (Args);
         return EFI_DEVICE_ERROR;
       }
 
+      FvbShadowUpdate (Instance,
+        BlockAddress - Instance->FvbOffset,
+        Instance->Media.BlockSize,
+        NULL);
+
       //
       // Move to the next Lba
       //
@@ -973,6 +1084,13 @@ FvbVirtualNotifyEvent (
   //
   EfiConvertPointer (0x0, (VOID**)&mFvbDevice->RegionBaseAddress);
 
+  //
+  // Convert the shadow of the variable and FTW region
+  //
+  if (mFvbDevice->Shadow != NULL) {
+    EfiConvertPointer (0x0, (VOID**)&mFvbDevice->Shadow);
+  }
+
   //
   // Convert SPI device description
   //
@@ -1080,9 +1198,12 @@ FlashFvbPrepareFvHeader (
                                                 FlashInstance->FvbOffset,
                                                 FlashInstance->FvbSize);
     if (EFI_ERROR (Status)) {
+      FvbShadowLoad (FlashInstance, 0, FlashInstance->FvbSize);
       return Status;
     }
 
+    FvbShadowUpdate (FlashInstance, 0, FlashInstance->FvbSize, NULL);
+
     //
     // Install all appropriate headers
     //
@@ -1176,6 +1297,23 @@ FlashFvbConfigureFlashInstance (
 
   FlashInstance->RegionBaseAddress = PcdGet64 (PcdFlashNvStorageVariableBase64);
 
+  //
+  // Shadow the variable and FTW region with one bulk read. The shadow is
+  // used at runtime too, so it is never freed.
+  //
+  if (FeaturePcdGet (PcdFlashFvbShadowEnable)) {
+    FlashInstance->Shadow = AllocateRuntimePool (FlashInstance->FvbSize);
+    if (FlashInstance->Shadow == NULL) {
+      DEBUG ((
+        DEBUG_WARN,
+        "%a: Cannot allocate the FVB shadow, reading from flash\n",
+        __func__
+        ));
+    } else {
+      FvbShadowLoad (FlashInstance, 0, FlashInstance->FvbSize);
+    }
+  }
+
   Status = gBS->InstallMultipleProtocolInterfaces (
                       &FlashInstance->Handle,
                       &gEfiDevicePathProtocolGuid,
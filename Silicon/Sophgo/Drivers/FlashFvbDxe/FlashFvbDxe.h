@@ -33,6 +33,7 @@ typedef struct {
   UINTN                               Size;
   UINTN                               FvbOffset;
   UINTN                               FvbSize;
+  UINT8                               *Shadow;      // Copy of the FvbSize bytes at FvbOffset, NULL if not used
   EFI_LBA                             StartLba;
   EFI_BLOCK_IO_MEDIA                  Media;
   EFI_FIRMWARE_VOLUME_BLOCK2_PROTOCOL FvbProtocol;
@@ -29,8 +29,10 @@
 
 #define DWEMMC_DESC_PAGE                1
 #define DWEMMC_BLOCK_SIZE               512
-#define DWEMMC_DMA_BUF_SIZE             (512 * 8)
+// Largest block multiple that fits in the 13-bit DES1 buffer size field
+#define DWEMMC_DMA_BUF_SIZE             (DWEMMC_IDMAC_DES1_BS1 (~0) & ~(DWEMMC_BLOCK_SIZE - 1))
 #define DWEMMC_MAX_DESC_PAGES           512
+#define DWEMMC_MAX_DESC                 (DWEMMC_MAX_DESC_PAGES * EFI_PAGE_SIZE / sizeof (DWEMMC_IDMAC_DESCRIPTOR))
 
 typedef struct {
   UINT32                        Des0;
@@ -455,6 +457,27 @@ DwEmmcAdjustFifoThreshold (
   MmioWrite32 (DWEMMC_FIFOTH, FifoThreshold);
 }
 
+/*
+ * The descriptor table is allocated once and chained up front;
+ * each transfer only fills in the control, size and buffer words
+ * of the descriptors it needs.
+ */
+VOID
+InitDmaDescriptors (
+  IN DWEMMC_IDMAC_DESCRIPTOR*    IdmacDesc
+  )
+{
+  UINTN  Idx;
+
+  for (Idx = 0; Idx < DWEMMC_MAX_DESC; Idx++) {
+    (IdmacDesc + Idx)->Des0 = 0;
+    (IdmacDesc + Idx)->Des3 = (UINT32)((UINTN)IdmacDesc +
+                                       (sizeof(DWEMMC_IDMAC_DESCRIPTOR) * (Idx + 1)));
+  }
+  (IdmacDesc + DWEMMC_MAX_DESC - 1)->Des3 = 0;
+  WriteBackDataCacheRange (IdmacDesc, DWEMMC_MAX_DESC_PAGES * EFI_PAGE_SIZE);
+}
+
 EFI_STATUS
 PrepareDmaData (
   IN DWEMMC_IDMAC_DESCRIPTOR*    IdmacDesc,
@@ -465,18 +488,19 @@ PrepareDmaData (
   UINTN  Cnt, Blks, Idx, LastIdx;
 
   Cnt = (Length + DWEMMC_DMA_BUF_SIZE - 1) / DWEMMC_DMA_BUF_SIZE;
+  if ((Cnt == 0) || (Cnt > DWEMMC_MAX_DESC)) {
+    return EFI_BAD_BUFFER_SIZE;
+  }
   Blks = (Length + DWEMMC_BLOCK_SIZE - 1) / DWEMMC_BLOCK_SIZE;
   Length = DWEMMC_BLOCK_SIZE * Blks;
 
+  /* Descriptors are chained once in InitDmaDescriptors () */
   for (Idx = 0; Idx < Cnt; Idx++) {
     (IdmacDesc + Idx)->Des0 = DWEMMC_IDMAC_DES0_OWN | DWEMMC_IDMAC_DES0_CH |
                               DWEMMC_IDMAC_DES0_DIC;
     (IdmacDesc + Idx)->Des1 = DWEMMC_IDMAC_DES1_BS1(DWEMMC_DMA_BUF_SIZE);
     /* Buffer Address */
     (IdmacDesc + Idx)->Des2 = (UINT32)((UINTN)Buffer + DWEMMC_DMA_BUF_SIZE * Idx);
-    /* Next Descriptor Address */
-    (IdmacDesc + Idx)->Des3 = (UINT32)((UINTN)IdmacDesc +
-                                       (sizeof(DWEMMC_IDMAC_DESCRIPTOR) * (Idx + 1)));
   }
   /* First Descriptor */
   IdmacDesc->Des0 |= DWEMMC_IDMAC_DES0_FS;
@@ -486,10 +510,9 @@ PrepareDmaData (
   (IdmacDesc + LastIdx)->Des0 &= ~(DWEMMC_IDMAC_DES0_DIC | DWEMMC_IDMAC_DES0_CH);
   (IdmacDesc + LastIdx)->Des1 = DWEMMC_IDMAC_DES1_BS1(Length -
                                                       (LastIdx * DWEMMC_DMA_BUF_SIZE));
-  /* Set the Next field of Last Descriptor */
-  (IdmacDesc + LastIdx)->Des3 = 0;
   MmioWrite32 (DWEMMC_DBADDR, (UINT32)((UINTN)IdmacDesc));
 
+  WriteBackDataCacheRange (IdmacDesc, Cnt * sizeof (DWEMMC_IDMAC_DESCRIPTOR));
   return EFI_SUCCESS;
 }
 
@@ -520,15 +543,10 @@ DwEmmcReadBlockData (
   )
 {
   EFI_STATUS  Status;
-  UINT32      DescPages, CountPerPage, Count;
   EFI_TPL     Tpl;
 
   Tpl = gBS->RaiseTPL (TPL_NOTIFY);
 
-  CountPerPage = EFI_PAGE_SIZE / 16;
-  Count = (Length + DWEMMC_DMA_BUF_SIZE - 1) / DWEMMC_DMA_BUF_SIZE;
-  DescPages = (Count + CountPerPage - 1) / CountPerPage;
-
   InvalidateDataCacheRange (Buffer, Length);
 
   Status = PrepareDmaData (gpIdmacDesc, Length, Buffer);
@@ -536,7 +554,6 @@ DwEmmcReadBlockData (
     goto out;
   }
 
-  WriteBackDataCacheRange (gpIdmacDesc, DescPages * EFI_PAGE_SIZE);
   StartDma (Length);
 
   Status = SendCommand (mDwEmmcCommand, mDwEmmcArgument);
@@ -559,15 +576,10 @@ DwEmmcWriteBlockData (
   )
 {
   EFI_STATUS  Status;
-  UINT32      DescPages, CountPerPage, Count;
   EFI_TPL     Tpl;
 
   Tpl = gBS->RaiseTPL (TPL_NOTIFY);
 
-  CountPerPage = EFI_PAGE_SIZE / 16;
-  Count = (Length + DWEMMC_DMA_BUF_SIZE - 1) / DWEMMC_DMA_BUF_SIZE;
-  DescPages = (Count + CountPerPage - 1) / CountPerPage;
-
   WriteBackDataCacheRange (Buffer, Length);
 
   Status = PrepareDmaData (gpIdmacDesc, Length, Buffer);
@@ -575,7 +587,6 @@ DwEmmcWriteBlockData (
     goto out;
   }
 
-  WriteBackDataCacheRange (gpIdmacDesc, DescPages * EFI_PAGE_SIZE);
   StartDma (Length);
 
   Status = SendCommand (mDwEmmcCommand, mDwEmmcArgument);
@@ -668,8 +679,9 @@ DwEmmcDxeInitialize (
   IN EFI_SYSTEM_TABLE   *SystemTable
   )
 {
-  EFI_STATUS    Status;
-  EFI_HANDLE    Handle;
+  EFI_STATUS            Status;
+  EFI_HANDLE            Handle;
+  EFI_PHYSICAL_ADDRESS  Address;
 
   if (!FixedPcdGetBool (PcdDwPermitObsoleteDrivers)) {
     ASSERT (FALSE);
@@ -679,10 +691,16 @@ DwEmmcDxeInitialize (
   Handle = NULL;
 
   DwEmmcAdjustFifoThreshold ();
-  gpIdmacDesc = (DWEMMC_IDMAC_DESCRIPTOR *)AllocatePages (DWEMMC_MAX_DESC_PAGES);
-  if (gpIdmacDesc == NULL) {
+
+  // The IDMAC only takes 32-bit descriptor addresses
+  Address = BASE_4GB - 1;
+  Status = gBS->AllocatePages (AllocateMaxAddress, EfiBootServicesData,
+                  DWEMMC_MAX_DESC_PAGES, &Address);
+  if (EFI_ERROR (Status)) {
     return EFI_BUFFER_TOO_SMALL;
   }
+  gpIdmacDesc = (DWEMMC_IDMAC_DESCRIPTOR *)(UINTN)Address;
+  InitDmaDescriptors (gpIdmacDesc);
 
   DEBUG ((DEBUG_BLKIO, "DwEmmcDxeInitialize()\n"));
 